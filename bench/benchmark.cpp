@@ -0,0 +1,87 @@
+/**
+ * @file	benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Variables -- */
+
+namespace
+{
+  std::string s_filter;
+  std::vector<bench::result> s_results;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Writes a string as a quoted JSON string. */
+  void write_string(std::ostream& stream, const std::string& value)
+  {
+    stream << '"';
+    for (char ch : value)
+    {
+      if (ch == '"' || ch == '\\')
+        stream << '\\';
+      stream << ch;
+    }
+    stream << '"';
+  }
+
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::set_filter(const std::string& filter)
+{
+  s_filter = filter;
+}
+
+bool lineage::bench::is_selected(const std::string& name)
+{
+  return (s_filter.empty() || name.find(s_filter) != std::string::npos);
+}
+
+void lineage::bench::record(const bench::result& result)
+{
+  s_results.push_back(result);
+}
+
+const std::vector<bench::result>& lineage::bench::results()
+{
+  return s_results;
+}
+
+void lineage::bench::write_json(std::ostream& stream, const std::vector<size_t>& sizes)
+{
+  stream << "{\n  \"sizes\": [";
+  for (size_t index = 0; index < sizes.size(); index++)
+    stream << (index != 0 ? ", " : "") << sizes[index];
+  stream << "],\n  \"benchmarks\": [";
+
+  for (size_t index = 0; index < s_results.size(); index++)
+  {
+    const auto& result = s_results[index];
+    stream << (index != 0 ? ",\n" : "\n") << "    { \"name\": ";
+    write_string(stream, result.name);
+    stream << ", \"iterations\": " << result.iterations
+           << ", \"mean_ns\": " << result.mean_ns
+           << ", \"min_ns\": " << result.min_ns << " }";
+  }
+
+  stream << "\n  ]\n}\n";
+}
@@ -0,0 +1,149 @@
+/**
+ * @file	benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* -- Types -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Struct containing the timing recorded for a single benchmark.
+     */
+    struct result
+    {
+      std::string name;		/**< The name of the benchmark. */
+      size_t iterations;	/**< The number of timed iterations. */
+      double mean_ns;		/**< The average time per iteration over every sample, in nanoseconds. */
+      double min_ns;		/**< The average time per iteration of the fastest sample, in nanoseconds. */
+    };
+
+  }
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Only benchmarks whose names contain `filter` are run. An empty filter runs every benchmark.
+     */
+    void set_filter(const std::string& filter);
+
+    /**
+     * Returns `true` if the benchmark with the specified name should be run.
+     */
+    bool is_selected(const std::string& name);
+
+    /**
+     * Records the result of a benchmark.
+     */
+    void record(const lineage::bench::result& result);
+
+    /**
+     * Returns every result recorded so far, in the order in which the benchmarks were run.
+     */
+    const std::vector<lineage::bench::result>& results();
+
+    /**
+     * Writes every recorded result, along with the parameters of the run, as a JSON document.
+     */
+    void write_json(std::ostream& stream, const std::vector<size_t>& sizes);
+
+  }
+}
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Prevents the compiler from optimizing away the computation of `value`.
+     */
+    template <typename T>
+    inline void do_not_optimize(const T& value)
+    {
+      asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    /**
+     * Returns an iteration count which keeps the total work of a benchmark roughly constant as the
+     * size of its input changes.
+     */
+    inline size_t scaled_iterations(size_t work, size_t size)
+    {
+      return std::max<size_t>(work / std::max<size_t>(size, 1), 1);
+    }
+
+    /**
+     * Runs `action` the specified number of times, prints the average time per iteration, and
+     * records the result. Benchmarks excluded by the filter are skipped.
+     *
+     * @note
+     * The iterations are split into several samples. The mean over every sample is reported along
+     * with the mean of the fastest sample, which is less sensitive to interference from the rest of
+     * the system.
+     *
+     * @return
+     * The average time per iteration, in nanoseconds, or zero if the benchmark was skipped.
+     */
+    template <typename TAction>
+    double run(const std::string& name, size_t iterations, TAction action)
+    {
+      static const size_t SAMPLE_COUNT = 5;
+
+      if (!is_selected(name))
+        return 0.0;
+
+      // warm up caches before timing
+      action();
+
+      const size_t samples = std::min(SAMPLE_COUNT, std::max<size_t>(iterations, 1));
+      const size_t sample_iterations = std::max<size_t>(iterations / samples, 1);
+
+      double total_ns = 0.0;
+      double min_ns = 0.0;
+      for (size_t sample = 0; sample < samples; sample++)
+      {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sample_iterations; i++)
+          action();
+        auto end = std::chrono::steady_clock::now();
+
+        const double sample_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        total_ns += sample_ns;
+        if (sample == 0 || sample_ns < min_ns)
+          min_ns = sample_ns;
+      }
+
+      const size_t total_iterations = samples * sample_iterations;
+      const double ns = total_ns / total_iterations;
+      record({ name, total_iterations, ns, min_ns / sample_iterations });
+
+      std::printf("%-48s %14.1f ns/iter\n", name.c_str(), ns);
+      return ns;
+    }
+
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file	input_benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+
+#include "benchmark.hpp"
+#include "input_benchmark.hpp"
+#include "input_manager.hpp"
+#include "window.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const size_t INPUT_ITERATIONS = 1000000;
+
+  // the state loop polls every input type on each update
+  const input_type FIRST_INPUT_TYPE = input_type::application_exit;
+  const input_type LAST_INPUT_TYPE = input_type::lighting_intensity_decrease;
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::run_input_benchmarks(const lineage::window& window)
+{
+  input_manager input { window };
+
+  bench::run("input/input_state", INPUT_ITERATIONS, [&] {
+      bench::do_not_optimize(input.input_state(input_type::generic_translate_forward));
+    });
+
+  bench::run("input/input_state_all_types", INPUT_ITERATIONS / 10, [&] {
+      size_t active = 0;
+      for (int type = static_cast<int>(FIRST_INPUT_TYPE); type <= static_cast<int>(LAST_INPUT_TYPE); type++)
+        active += (input.input_state(static_cast<input_type>(type)) == input_state::active);
+      bench::do_not_optimize(active);
+    });
+
+  bench::run("input/set_input_state_unchanged", INPUT_ITERATIONS, [&] {
+      input.set_input_state(input_type::generic_translate_forward, input_state::inactive);
+    });
+
+  bool active = false;
+  bench::run("input/set_input_state_toggled", INPUT_ITERATIONS, [&] {
+      active = !active;
+      input.set_input_state(input_type::generic_translate_forward, active ? input_state::active : input_state::inactive);
+    });
+}
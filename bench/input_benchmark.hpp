@@ -0,0 +1,26 @@
+/**
+ * @file	input_benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+
+  class window;
+
+  namespace bench
+  {
+
+    /**
+     * Measures looking up and updating input states through a `lineage::input_manager` attached
+     * to the specified window.
+     */
+    void run_input_benchmarks(const lineage::window& window);
+
+  }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file	main.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "input_benchmark.hpp"
+#include "opengl.hpp"
+#include "opengl_benchmark.hpp"
+#include "scene_builder_benchmark.hpp"
+#include "transform_benchmark.hpp"
+#include "traversal_benchmark.hpp"
+#include "window.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std::string_literals;
+using namespace lineage;
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** Options parsed from the command line. */
+  struct options
+  {
+    std::vector<size_t> sizes;	/**< The scene and upload sizes to benchmark. */
+    std::string filter;		/**< Only benchmarks whose names contain this are run. */
+    std::string json;		/**< Path to write the results to as JSON, or empty. */
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace
+{
+  options parse_options(int argc, char** argv);
+  std::vector<size_t> parse_sizes(const std::string& value);
+  void run_benchmarks(const options& opts);
+}
+
+/* -- Procedures -- */
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    run_benchmarks(parse_options(argc, argv));
+    return 0;
+  }
+  catch (const std::exception& ex)
+  {
+    std::fprintf(stderr, "%s\n", ex.what());
+    return 1;
+  }
+}
+
+namespace
+{
+
+  /**
+   * Parses the command line options.
+   *
+   * @exception std::invalid_argument
+   * Thrown if an option is not recognized, or is missing its value.
+   */
+  options parse_options(int argc, char** argv)
+  {
+    options opts;
+    opts.sizes = { 1000, 10000, 100000 };
+    opts.filter = "";
+    opts.json = "";
+
+    for (int index = 1; index < argc; index++)
+    {
+      const std::string option { argv[index] };
+      auto value = [&] {
+        if (index + 1 >= argc)
+          throw std::invalid_argument("Missing value for option "s + option);
+        return std::string(argv[++index]);
+      };
+
+      if (option == "--sizes")
+        opts.sizes = parse_sizes(value());
+      else if (option == "--filter")
+        opts.filter = value();
+      else if (option == "--json")
+        opts.json = value();
+      else
+        throw std::invalid_argument("Unrecognized option "s + option);
+    }
+
+    return opts;
+  }
+
+  /**
+   * Parses a comma-separated list of sizes.
+   *
+   * @exception std::invalid_argument
+   * Thrown if any size is not a positive integer.
+   */
+  std::vector<size_t> parse_sizes(const std::string& value)
+  {
+    std::vector<size_t> sizes;
+    size_t begin = 0;
+    while (begin <= value.size())
+    {
+      size_t end = value.find(',', begin);
+      if (end == std::string::npos)
+        end = value.size();
+
+      const size_t size = std::stoull(value.substr(begin, end - begin));
+      if (size == 0)
+        throw std::invalid_argument("Sizes must be positive!");
+      sizes.push_back(size);
+      begin = end + 1;
+    }
+    return sizes;
+  }
+
+  /**
+   * Runs every selected benchmark, and writes the results.
+   */
+  void run_benchmarks(const options& opts)
+  {
+    bench::set_filter(opts.filter);
+
+    // several benchmarks need a context, so create a hidden window to own one
+    window_args args;
+    args.context_version_major = 3;
+    args.context_version_minor = 2;
+    args.context_profile = GLFW_OPENGL_CORE_PROFILE;
+    args.context_forward_compatibility = true;
+    args.msaa_samples = 0;
+    args.width = 64;
+    args.height = 64;
+    args.title = "Lineage Benchmarks";
+    args.swap_interval = 0;
+    args.visible = false;
+
+    lineage::window window { args };
+    lineage::opengl opengl { };
+
+    bench::run_transform_benchmarks(opts.sizes);
+    bench::run_traversal_benchmarks(opts.sizes);
+    bench::run_scene_builder_benchmarks(opts.sizes);
+    bench::run_input_benchmarks(window);
+    bench::run_opengl_benchmarks(opengl, opts.sizes);
+
+    if (!opts.json.empty())
+    {
+      std::ofstream file { opts.json };
+      bench::write_json(file, opts.sizes);
+      if (!file)
+        throw std::runtime_error("Failed to write results to "s + opts.json);
+    }
+  }
+
+}
@@ -0,0 +1,149 @@
+/**
+ * @file	opengl_benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api.hpp"
+#include "benchmark.hpp"
+#include "buffer.hpp"
+#include "geometry_pool.hpp"
+#include "mesh.hpp"
+#include "mesh_pack.hpp"
+#include "opengl.hpp"
+#include "opengl_benchmark.hpp"
+#include "vertex.hpp"
+#include "vertex_array.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const size_t BINDING_ITERATIONS = 1000000;
+
+  // total number of vertices to upload in each benchmark, divided across its iterations
+  const size_t VERTICES_PER_BENCHMARK = 10000000;
+
+  // size of each mesh when comparing mesh uploads, and where to write the pack holding them
+  const size_t VERTICES_PER_MESH = 1024;
+  const char* const MESH_PACK_PATH = "bench_mesh_pack.bin";
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Benchmarks pushing and popping bindings on each of the binding stacks. */
+  void run_binding_benchmarks(opengl& opengl)
+  {
+    const immutable_buffer first_buffer(sizeof(vertex), nullptr, 0);
+    const immutable_buffer second_buffer(sizeof(vertex), nullptr, 0);
+
+    // with the buffer already bound, both the push and the pop are elided
+    opengl.push_buffer(GL_ARRAY_BUFFER, first_buffer);
+    bench::run("opengl/push_pop_buffer/same", BINDING_ITERATIONS, [&] {
+        opengl.push_buffer(GL_ARRAY_BUFFER, first_buffer);
+        opengl.pop_buffer(GL_ARRAY_BUFFER);
+      });
+
+    // with a different buffer bound, both are issued
+    bench::run("opengl/push_pop_buffer/different", BINDING_ITERATIONS, [&] {
+        opengl.push_buffer(GL_ARRAY_BUFFER, second_buffer);
+        opengl.pop_buffer(GL_ARRAY_BUFFER);
+      });
+    opengl.pop_buffer(GL_ARRAY_BUFFER);
+
+    const vertex_array first_vao;
+    const vertex_array second_vao;
+
+    opengl.push_vertex_array(first_vao);
+    bench::run("opengl/push_pop_vertex_array/same", BINDING_ITERATIONS, [&] {
+        opengl.push_vertex_array(first_vao);
+        opengl.pop_vertex_array();
+      });
+
+    bench::run("opengl/push_pop_vertex_array/different", BINDING_ITERATIONS, [&] {
+        opengl.push_vertex_array(second_vao);
+        opengl.pop_vertex_array();
+      });
+    opengl.pop_vertex_array();
+  }
+
+  /**
+   * Benchmarks uploading the specified number of vertices. Each iteration waits for the upload to
+   * complete, so that the transfer itself is measured rather than just the call.
+   */
+  void run_upload_benchmarks(size_t vertex_count)
+  {
+    const std::string name = "upload/" + std::to_string(vertex_count) + "_vertices";
+    const size_t iterations = bench::scaled_iterations(VERTICES_PER_BENCHMARK, vertex_count);
+    const std::vector<vertex> vertices(vertex_count);
+
+    bench::run(name + "/create", iterations, [&] {
+        const immutable_buffer buffer(vertices, 0);
+        glFinish();
+      });
+
+    immutable_buffer buffer(vertices, GL_DYNAMIC_STORAGE_BIT);
+    bench::run(name + "/set_data", iterations, [&] {
+        buffer.set_data(0, vertices.size() * sizeof(vertex), vertices.data());
+        glFinish();
+      });
+
+    // the same geometry split into meshes, built from vectors and loaded from a mesh pack
+    std::vector<mesh_pack_source> sources;
+    for (size_t first = 0; first < vertex_count; first += VERTICES_PER_MESH)
+    {
+      const size_t count = std::min(VERTICES_PER_MESH, vertex_count - first);
+      mesh_pack_source source;
+      source.draw_mode = GL_TRIANGLES;
+      source.vertices.assign(count, vertex());
+      for (size_t index = 0; index < count; index++)
+        source.indices.push_back(static_cast<GLuint>(index));
+      sources.push_back(std::move(source));
+    }
+
+    bench::run(name + "/meshes", iterations, [&] {
+        geometry_pool pool;
+        std::vector<std::unique_ptr<mesh>> meshes;
+        for (const auto& source : sources)
+          meshes.push_back(std::make_unique<mesh>(pool, source.draw_mode, source.vertices, source.indices));
+        glFinish();
+      });
+
+    mesh_pack::write(MESH_PACK_PATH, sources);
+    bench::run(name + "/mesh_pack", iterations, [&] {
+        geometry_pool pool;
+        std::vector<std::unique_ptr<mesh>> meshes;
+        const mesh_pack pack(MESH_PACK_PATH);
+        pack.load(pool, &meshes);
+        glFinish();
+      });
+    std::remove(MESH_PACK_PATH);
+  }
+
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::run_opengl_benchmarks(lineage::opengl& opengl, const std::vector<size_t>& sizes)
+{
+  run_binding_benchmarks(opengl);
+  for (size_t size : sizes)
+    run_upload_benchmarks(size);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file	opengl_benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+
+  class opengl;
+
+  namespace bench
+  {
+
+    /**
+     * Measures the overhead of the `lineage::opengl` binding stacks, and of uploading each of the
+     * specified numbers of vertices through `lineage::immutable_buffer`.
+     */
+    void run_opengl_benchmarks(lineage::opengl& opengl, const std::vector<size_t>& sizes);
+
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file	scene_builder_benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "constants.hpp"
+#include "scene_builder.hpp"
+#include "scene_builder_benchmark.hpp"
+#include "scene_graph.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const size_t SCENE_BUILDER_ITERATIONS = 200;
+
+  // total number of cubes to build in each stress scene benchmark, divided across its iterations
+  const size_t CUBES_PER_BENCHMARK = 200000;
+
+  const uint32_t SCATTER_SEED = 1;
+
+  // total number of spheres to build in each LOD sphere grid benchmark
+  const size_t SPHERES_PER_BENCHMARK = 20000;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Benchmarks each of the stress scene generators with roughly `size` cubes. */
+  void run_stress_scene_benchmarks(size_t size, const stress_scene_args& args)
+  {
+    const std::string suffix = std::to_string(size) + "_cubes_" + std::to_string(args.mesh_count) + "_meshes";
+    const size_t iterations = bench::scaled_iterations(CUBES_PER_BENCHMARK, size);
+
+    const size_t side = static_cast<size_t>(std::round(std::cbrt(static_cast<double>(size))));
+    bench::run("scene_builder/grid_" + suffix, iterations, [&] {
+        scene_graph graph = create_cube_grid_scene_graph(side, side, side, args);
+        bench::do_not_optimize(graph.nodes().size());
+      });
+
+    if (size <= MAX_CHAIN_DEPTH)
+    {
+      bench::run("scene_builder/chain_" + suffix, iterations, [&] {
+          scene_graph graph = create_deep_chain_scene_graph(size, args);
+          bench::do_not_optimize(graph.nodes().size());
+        });
+    }
+
+    bench::run("scene_builder/fan_" + suffix, iterations, [&] {
+        scene_graph graph = create_wide_fan_scene_graph(size, args);
+        bench::do_not_optimize(graph.nodes().size());
+      });
+
+    bench::run("scene_builder/scatter_" + suffix, iterations, [&] {
+        scene_graph graph = create_random_scatter_scene_graph(size, 100.0f, SCATTER_SEED, args);
+        bench::do_not_optimize(graph.nodes().size());
+      });
+  }
+
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::run_scene_builder_benchmarks(const std::vector<size_t>& sizes)
+{
+  bench::run("scene_builder/single_cube", SCENE_BUILDER_ITERATIONS, [&] {
+      scene_graph graph = create_single_cube_scene_graph(COLOR_WHITE);
+      bench::do_not_optimize(graph.nodes().size());
+    });
+
+  bench::run("scene_builder/multiple_cubes", SCENE_BUILDER_ITERATIONS, [&] {
+      scene_graph graph = create_multiple_cubes_scene_graph();
+      bench::do_not_optimize(graph.nodes().size());
+    });
+
+  for (size_t size : sizes)
+  {
+    run_stress_scene_benchmarks(size, { 1, 8 });
+    run_stress_scene_benchmarks(size, { 64, 8 });
+
+    // generating the LOD chains dominates, so the sphere grid is only built with one resolution
+    const size_t side = static_cast<size_t>(std::round(std::cbrt(static_cast<double>(size))));
+    bench::run("scene_builder/lod_spheres_" + std::to_string(size) + "_spheres",
+               bench::scaled_iterations(SPHERES_PER_BENCHMARK, size),
+               [&] {
+                 scene_graph graph = create_lod_sphere_grid_scene_graph(side, side, side, { 1, 8 });
+                 bench::do_not_optimize(graph.meshes().size());
+               });
+  }
+}
@@ -0,0 +1,33 @@
+/**
+ * @file	scene_builder_benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Measures the construction of each of the scene graphs built by `scene_builder.hpp`,
+     * including uploading their geometry. The stress scenes are built with each of the specified
+     * numbers of cubes, with both a single mesh and many distinct meshes, and the LOD sphere grid
+     * is built with each number of spheres.
+     *
+     * @note
+     * Requires a current OpenGL context.
+     */
+    void run_scene_builder_benchmarks(const std::vector<size_t>& sizes);
+
+  }
+}
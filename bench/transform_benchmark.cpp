@@ -0,0 +1,169 @@
+/**
+ * @file	transform_benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "benchmark.hpp"
+#include "constants.hpp"
+#include "flat_scene_graph.hpp"
+#include "scene_graph.hpp"
+#include "scene_node.hpp"
+#include "transform_benchmark.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // total number of nodes to visit in each benchmark, divided across its iterations
+  const size_t NODES_PER_BENCHMARK = 2000000;
+
+  // the recursive reference implementation (and the nodes' destructors) recurse once per level, so
+  // chains are capped to keep the stack usage reasonable
+  const size_t MAX_DEEP_GRAPH_DEPTH = 10000;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Creates a node with a non-trivial transform. */
+  scene_node transformed_node()
+  {
+    scene_node node;
+    node.set_position(glm::vec3(0.1f, 0.2f, 0.3f));
+    node.set_rotation(glm::rotate(ROTATION_NONE, 0.01f, VEC3_UNIT_Y));
+    node.set_scale(glm::vec3(1.001f, 1.001f, 1.001f));
+    return node;
+  }
+
+  /** Creates a graph consisting of a single chain of `depth` nodes. */
+  scene_graph deep_graph(size_t depth)
+  {
+    scene_node node = transformed_node();
+    for (size_t i = 1; i < depth; i++)
+    {
+      scene_node parent = transformed_node();
+      parent.children().push_back(std::move(node));
+      node = std::move(parent);
+    }
+
+    scene_graph graph;
+    graph.nodes().push_back(std::move(node));
+    return graph;
+  }
+
+  /** Creates a graph consisting of a single root with `width` children. */
+  scene_graph wide_graph(size_t width)
+  {
+    scene_node root = transformed_node();
+    root.children().assign(width - 1, transformed_node());
+
+    scene_graph graph;
+    graph.nodes().push_back(std::move(root));
+    return graph;
+  }
+
+  /** Reference implementation of the original recursive transform pass. */
+  void recursive_world_matrices(const scene_node& node,
+                                const glm::mat4& parent_matrix,
+                                std::vector<glm::mat4>& matrices)
+  {
+    glm::mat4 matrix = parent_matrix *
+      glm::translate(node.position()) *
+      glm::scale(node.scale()) *
+      glm::mat4_cast(node.rotation());
+    matrices.push_back(matrix);
+
+    for (const auto& child : node.children())
+      recursive_world_matrices(child, matrix, matrices);
+  }
+
+  /** Returns the last leaf node in the specified graph. */
+  scene_node& last_leaf(scene_graph& graph)
+  {
+    scene_node* node = &graph.node(graph.nodes().size() - 1);
+    while (!node->children().empty())
+      node = &node->children().back();
+    return *node;
+  }
+
+  /** Benchmarks both transform paths on the specified graph. */
+  void run_graph_benchmarks(const std::string& name, scene_graph graph, size_t iterations)
+  {
+    const scene_graph& source = graph;
+
+    std::vector<glm::mat4> matrices;
+    bench::run("transform/" + name + "/recursive", iterations, [&] {
+        matrices.clear();
+        for (const auto& node : source.nodes())
+          recursive_world_matrices(node, glm::mat4(), matrices);
+        bench::do_not_optimize(matrices.back());
+      });
+
+    flat_scene_graph flat_graph;
+    bench::run("transform/" + name + "/flatten", iterations, [&] {
+        flat_graph.rebuild(source);
+        bench::do_not_optimize(flat_graph.size());
+      });
+
+    bench::run("transform/" + name + "/flattened", iterations, [&] {
+        flat_graph.invalidate();
+        flat_graph.update_world_matrices();
+        bench::do_not_optimize(flat_graph.world_matrix(flat_graph.size() - 1));
+      });
+
+    bench::run("transform/" + name + "/flattened_unchanged", iterations, [&] {
+        flat_graph.update_world_matrices();
+        bench::do_not_optimize(flat_graph.world_matrix(flat_graph.size() - 1));
+      });
+
+    scene_node& leaf = last_leaf(graph);
+    float offset = 0.0f;
+    bench::run("transform/" + name + "/flattened_leaf_changed", iterations, [&] {
+        offset += 1.0f;
+        leaf.set_position(glm::vec3(offset, 0.0f, 0.0f));
+        flat_graph.update_world_matrices();
+        bench::do_not_optimize(flat_graph.world_matrix(flat_graph.size() - 1));
+      });
+
+    // the leaf is the last node, so telling the graph which node changed skips the scan entirely
+    const std::vector<size_t> changed { flat_graph.size() - 1 };
+    bench::run("transform/" + name + "/flattened_leaf_changed_tracked", iterations, [&] {
+        offset += 1.0f;
+        leaf.set_position(glm::vec3(offset, 0.0f, 0.0f));
+        flat_graph.update_world_matrices(changed);
+        bench::do_not_optimize(flat_graph.world_matrix(flat_graph.size() - 1));
+      });
+  }
+
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::run_transform_benchmarks(const std::vector<size_t>& sizes)
+{
+  for (size_t size : sizes)
+  {
+    const size_t iterations = bench::scaled_iterations(NODES_PER_BENCHMARK, size);
+    if (size <= MAX_DEEP_GRAPH_DEPTH)
+      run_graph_benchmarks("deep_" + std::to_string(size), deep_graph(size), iterations);
+    run_graph_benchmarks("wide_" + std::to_string(size), wide_graph(size), iterations);
+  }
+}
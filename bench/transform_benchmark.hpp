@@ -0,0 +1,28 @@
+/**
+ * @file	transform_benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Compares the recursive and flattened world matrix computations on deep and wide graphs with
+     * each of the specified numbers of nodes.
+     */
+    void run_transform_benchmarks(const std::vector<size_t>& sizes);
+
+  }
+}
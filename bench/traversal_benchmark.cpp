@@ -0,0 +1,138 @@
+/**
+ * @file	traversal_benchmark.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "benchmark.hpp"
+#include "bvh.hpp"
+#include "constants.hpp"
+#include "flat_scene_graph.hpp"
+#include "frustum.hpp"
+#include "scene_builder.hpp"
+#include "scene_graph.hpp"
+#include "scene_node.hpp"
+#include "traversal_benchmark.hpp"
+#include "util.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // total number of nodes to visit in each benchmark, divided across its iterations
+  const size_t NODES_PER_BENCHMARK = 2000000;
+
+  const float GRID_SPACING = 3.0f;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the number of nodes along each side of a cubic grid holding `count` nodes. */
+  size_t grid_side(size_t count)
+  {
+    return static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+  }
+
+  /** Creates a graph of `count` single-mesh nodes laid out on a grid centered on the origin. */
+  scene_graph grid_graph(size_t count)
+  {
+    // borrow the square mesh from the single cube scene, but not its nodes
+    scene_graph graph = create_single_cube_scene_graph(COLOR_WHITE);
+    auto& nodes = graph.nodes();
+    nodes.clear();
+    nodes.reserve(count);
+
+    const size_t side = grid_side(count);
+    const float offset = (side - 1) * GRID_SPACING * 0.5f;
+    for (size_t index = 0; index < count; index++)
+    {
+      scene_node node;
+      node.meshes().assign({ 0 });
+      node.set_position(glm::vec3((index % side) * GRID_SPACING - offset,
+                                  ((index / side) % side) * GRID_SPACING - offset,
+                                  (index / (side * side)) * GRID_SPACING - offset));
+      nodes.push_back(node);
+    }
+
+    return graph;
+  }
+
+  /** Benchmarks each stage of the traversal on the specified graph. */
+  void run_grid_benchmarks(const std::string& name, scene_graph graph, size_t iterations)
+  {
+    const scene_graph& source = graph;
+
+    // a camera outside the grid, looking at its center, sees about half of the nodes
+    const float distance = grid_side(source.nodes().size()) * GRID_SPACING;
+    const glm::mat4 view_matrix = glm::lookAt(glm::vec3(0.0f, 0.0f, distance), glm::vec3(0.0f), VEC3_UNIT_Y);
+    const glm::mat4 proj_matrix = glm::perspective(deg_to_rad(45.0f), 4.0f / 3.0f, 0.1f, distance * 2.0f);
+    const frustum view_frustum(proj_matrix * view_matrix);
+
+    flat_scene_graph flat_graph;
+    bench::run("traversal/" + name + "/flatten", iterations, [&] {
+        flat_graph.rebuild(source);
+        bench::do_not_optimize(flat_graph.size());
+      });
+
+    bench::run("traversal/" + name + "/world_matrices", iterations, [&] {
+        flat_graph.invalidate();
+        flat_graph.update_world_matrices();
+        bench::do_not_optimize(flat_graph.world_matrix(flat_graph.size() - 1));
+      });
+
+    bvh hierarchy;
+    bench::run("traversal/" + name + "/bvh_build", iterations, [&] {
+        hierarchy.build(flat_graph);
+        bench::do_not_optimize(hierarchy.node_count());
+      });
+
+    bench::run("traversal/" + name + "/bvh_refit", iterations, [&] {
+        hierarchy.refit(flat_graph);
+        bench::do_not_optimize(hierarchy.node_count());
+      });
+
+    std::vector<size_t> visible_nodes;
+    bench::run("traversal/" + name + "/frustum_query", iterations, [&] {
+        visible_nodes.clear();
+        hierarchy.query(view_frustum, &visible_nodes);
+        bench::do_not_optimize(visible_nodes.size());
+      });
+
+    // the same view-space transform which the render manager uses to sort each visible node
+    float depth = 0.0f;
+    bench::run("traversal/" + name + "/compose_matrices", iterations, [&] {
+        for (size_t index : visible_nodes)
+          depth += (view_matrix * flat_graph.world_matrix(index)[3]).z;
+        bench::do_not_optimize(depth);
+      });
+  }
+
+}
+
+/* -- Procedures -- */
+
+void lineage::bench::run_traversal_benchmarks(const std::vector<size_t>& sizes)
+{
+  for (size_t size : sizes)
+  {
+    const size_t iterations = bench::scaled_iterations(NODES_PER_BENCHMARK, size);
+    run_grid_benchmarks("grid_" + std::to_string(size), grid_graph(size), iterations);
+  }
+}
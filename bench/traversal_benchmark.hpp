@@ -0,0 +1,29 @@
+/**
+ * @file	traversal_benchmark.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+/* -- Procedure Prototypes -- */
+
+namespace lineage
+{
+  namespace bench
+  {
+
+    /**
+     * Measures the per-frame traversal performed by `lineage::default_render_manager` - updating
+     * the flattened graph and bounding volume hierarchy, querying the view frustum, and composing
+     * the matrices of each visible node - on grids with each of the specified numbers of nodes.
+     */
+    void run_traversal_benchmarks(const std::vector<size_t>& sizes);
+
+  }
+}
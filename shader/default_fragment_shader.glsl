@@ -4,12 +4,18 @@
  */
 
 #version 330 core
-#extension GL_ARB_explicit_uniform_location : require
 
 /* -- Uniforms -- */
 
-layout (location = 3) uniform vec4 ambient_light_color;
-layout (location = 4) uniform float ambient_light_intensity;
+layout (std140) uniform FrameBlock
+{
+  mat4 view_matrix;
+  mat4 proj_matrix;
+  mat4 view_proj_matrix;
+  vec4 camera_position;
+  vec4 ambient_light_color;
+  float ambient_light_intensity;
+} frame;
 
 /* -- Inputs -- */
 
@@ -27,6 +33,6 @@ out vec4 fragment_color;
 
 void main(void)
 {
-  vec4 ambient_light = ambient_light_color * ambient_light_intensity;
+  vec4 ambient_light = frame.ambient_light_color * frame.ambient_light_intensity;
   fragment_color = inblock.vertex_color * ambient_light;
 }
@@ -0,0 +1,46 @@
+/**
+ * default_instanced_vertex_shader.glsl
+ * Chris Vig (chris@invictus.so)
+ */
+
+#version 330 core
+
+/* -- Uniforms -- */
+
+layout (std140) uniform FrameBlock
+{
+  mat4 view_matrix;
+  mat4 proj_matrix;
+  mat4 view_proj_matrix;
+  vec4 camera_position;
+  vec4 ambient_light_color;
+  float ambient_light_intensity;
+} frame;
+
+/* -- Inputs -- */
+
+layout (location = 0) in vec3 vertex_position;
+layout (location = 1) in vec3 vertex_normal;
+layout (location = 2) in vec4 vertex_color;
+layout (location = 3) in mat4 instance_model_matrix;	// occupies locations 3-6
+layout (location = 7) in vec4 instance_color;
+
+/* -- Outputs -- */
+
+out VertexToFragmentInterface
+{
+  vec3 vertex_normal;
+  vec4 vertex_color;
+} outblock;
+
+/* -- Procedures -- */
+
+void main(void)
+{
+  // set vertex position
+  gl_Position = frame.view_proj_matrix * instance_model_matrix * vec4(vertex_position, 1.0);
+
+  // set outputs
+  outblock.vertex_normal = vertex_normal;
+  outblock.vertex_color = vertex_color * instance_color;
+}
@@ -4,13 +4,20 @@
  */
 
 #version 330 core
-#extension GL_ARB_explicit_uniform_location : require
 
 /* -- Uniforms -- */
 
-layout (location = 0) uniform mat4 model_matrix;
-layout (location = 1) uniform mat4 view_matrix;
-layout (location = 2) uniform mat4 proj_matrix;
+layout (std140) uniform FrameBlock
+{
+  mat4 view_matrix;
+  mat4 proj_matrix;
+  mat4 view_proj_matrix;
+  vec4 camera_position;
+  vec4 ambient_light_color;
+  float ambient_light_intensity;
+} frame;
+
+uniform mat4 model_matrix;
 
 /* -- Inputs -- */
 
@@ -31,7 +38,7 @@ out VertexToFragmentInterface
 void main(void)
 {
   // set vertex position
-  gl_Position = proj_matrix * view_matrix * model_matrix * vec4(vertex_position, 1.0);
+  gl_Position = frame.view_proj_matrix * model_matrix * vec4(vertex_position, 1.0);
 
   // set outputs
   outblock.vertex_normal = vertex_normal;
@@ -0,0 +1,162 @@
+/**
+ * @file	allocation_counter.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Types -- */
+
+struct lineage::allocation_account
+{
+  std::atomic<uint64_t> count;	/**< The number of allocations charged to the account. */
+};
+
+/* -- Variables -- */
+
+#if defined(LINEAGE_DEBUG)
+
+namespace
+{
+  // counted per thread, so that each thread can measure its own allocations - the count is atomic
+  // because worker threads may be charging it at the same time
+  thread_local allocation_account s_own_account = { { 0 } };
+
+  // the account being charged, or `nullptr` to charge the thread's own account
+  thread_local allocation_account* s_charged_account = nullptr;
+}
+
+#endif /* defined(LINEAGE_DEBUG) */
+
+/* -- Private Procedures -- */
+
+#if defined(LINEAGE_DEBUG)
+
+namespace
+{
+
+  /** Allocates memory and counts the allocation, returning `nullptr` on failure. */
+  void* counted_allocate(std::size_t size) noexcept
+  {
+    allocation_account* const account = (s_charged_account != nullptr) ? s_charged_account : &s_own_account;
+    account->count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size != 0 ? size : 1);
+  }
+
+  /** Allocates memory and counts the allocation, throwing `std::bad_alloc` on failure. */
+  void* counted_allocate_or_throw(std::size_t size)
+  {
+    void* result = counted_allocate(size);
+    if (result == nullptr)
+      throw std::bad_alloc();
+    return result;
+  }
+
+}
+
+/* -- Global Allocation Functions -- */
+
+void* operator new(std::size_t size)
+{
+  return counted_allocate_or_throw(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return counted_allocate_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+  std::free(pointer);
+}
+
+#endif /* defined(LINEAGE_DEBUG) */
+
+/* -- Procedures -- */
+
+uint64_t lineage::allocation_count()
+{
+#if defined(LINEAGE_DEBUG)
+  return s_own_account.count.load(std::memory_order_relaxed);
+#else
+  return 0;
+#endif
+}
+
+allocation_account* lineage::current_allocation_account()
+{
+#if defined(LINEAGE_DEBUG)
+  return (s_charged_account != nullptr) ? s_charged_account : &s_own_account;
+#else
+  return nullptr;
+#endif
+}
+
+allocation_charge_scope::allocation_charge_scope(allocation_account* account)
+#if defined(LINEAGE_DEBUG)
+  : m_previous(s_charged_account)
+{
+  s_charged_account = account;
+}
+#else
+  : m_previous(nullptr)
+{
+  static_cast<void>(account);
+}
+#endif
+
+allocation_charge_scope::~allocation_charge_scope()
+{
+#if defined(LINEAGE_DEBUG)
+  s_charged_account = m_previous;
+#endif
+}
@@ -0,0 +1,82 @@
+/**
+ * @file	allocation_counter.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /**
+   * The count which a thread's heap allocations are charged to.
+   */
+  struct allocation_account;
+
+  /**
+   * Returns the number of heap allocations made through `operator new` by the calling thread since
+   * it started, including allocations made by other threads on its behalf.
+   *
+   * @note
+   * Allocations are only counted in debug builds, where the global allocation functions are
+   * replaced. This always returns zero in other builds. Allocations made by C libraries with
+   * `malloc` (such as the OpenGL driver) are not counted.
+   */
+  uint64_t allocation_count();
+
+  /**
+   * Returns the account which the calling thread's heap allocations are currently charged to. This
+   * is `nullptr` in builds where allocations aren't counted.
+   */
+  lineage::allocation_account* current_allocation_account();
+
+  /**
+   * Class which charges the calling thread's heap allocations to another thread's account while it
+   * exists. This lets work handed to a worker thread be counted by the thread which requested it.
+   *
+   * @note
+   * The account must outlive the instance.
+   */
+  class allocation_charge_scope
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::allocation_charge_scope` instance.
+     *
+     * @param account
+     * The account to charge, as returned by `current_allocation_account()` on the other thread.
+     */
+    explicit allocation_charge_scope(lineage::allocation_account* account);
+
+    /**
+     * Destructor. Resumes charging the previous account.
+     */
+    ~allocation_charge_scope();
+
+  private:
+
+    allocation_charge_scope(const lineage::allocation_charge_scope&) = delete;
+    allocation_charge_scope(lineage::allocation_charge_scope&&) = delete;
+    lineage::allocation_charge_scope& operator =(const lineage::allocation_charge_scope&) = delete;
+    lineage::allocation_charge_scope& operator =(lineage::allocation_charge_scope&&) = delete;
+
+    /* -- Implementation -- */
+
+  private:
+
+    lineage::allocation_account* const m_previous;
+
+  };
+
+}
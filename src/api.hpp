@@ -11,3 +11,11 @@
 // These must be included in the following order
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+
+/* -- Constants -- */
+
+// The KHR and ARB parallel compile extensions share this token, but GLEW builds which predate them
+// don't define it
+#if !defined(GL_COMPLETION_STATUS_ARB)
+#define GL_COMPLETION_STATUS_ARB 0x91B1
+#endif
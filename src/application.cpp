@@ -6,12 +6,21 @@
 
 /* -- Includes -- */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <utility>
 
+#include "allocation_counter.hpp"
 #include "application.hpp"
 #include "debug.hpp"
 #include "input_manager.hpp"
+#include "input_replayer.hpp"
 #include "opengl.hpp"
 #include "opengl_error.hpp"
 #include "render_manager.hpp"
@@ -23,6 +32,23 @@
 
 using namespace lineage;
 
+/* -- Constants -- */
+
+namespace
+{
+  // Number of frames rendered before the loop is considered to be in a steady state, and heap
+  // allocations start being reported
+  const uint64_t STEADY_STATE_FRAME_COUNT = 120;
+
+  // Time before each deadline which is spun through rather than slept through, in seconds. Sleeps
+  // may overrun by up to a scheduler tick, so waking early and spinning keeps ticks on time.
+  const double PACING_SPIN_TIME = 0.001;
+
+  // Interval between reports of the average CPU and GPU frame times, in seconds
+  const double FRAME_TIME_REPORT_INTERVAL = 5.0;
+  const double MILLISECONDS_PER_SECOND = 1000.0;
+}
+
 /* -- Types -- */
 
 /**
@@ -42,7 +68,17 @@ struct application::implementation
       opengl(opengl),
       input_manager(input_manager),
       state_manager(state_manager),
-      render_manager(render_manager)
+      render_manager(render_manager),
+      frame_count(0),
+      frame_limit(0),
+      replayer(nullptr),
+      steady_state_allocations(0),
+      stopping(false),
+      state_error(),
+      report_start_t(window.time()),
+      report_frame_count(0),
+      report_cpu_time(0.0),
+      report_gpu_time(0.0)
   { }
 
   /* -- Fields -- */
@@ -52,6 +88,16 @@ struct application::implementation
   lineage::input_manager& input_manager;
   lineage::state_manager& state_manager;
   lineage::render_manager& render_manager;
+  std::atomic<uint64_t> frame_count;
+  uint64_t frame_limit;
+  lineage::input_replayer* replayer;
+  std::atomic<uint64_t> steady_state_allocations;
+  std::atomic<bool> stopping;
+  std::exception_ptr state_error;
+  double report_start_t;
+  uint64_t report_frame_count;
+  double report_cpu_time;
+  double report_gpu_time;
 
   /* -- Methods -- */
 
@@ -61,6 +107,36 @@ struct application::implementation
     window.poll_events();
   }
 
+  /**
+   * Handles application input until the specified time, without using any CPU while waiting.
+   *
+   * @note
+   * This returns early if input arrives, so that the loop can react to it and then wait again.
+   */
+  void wait_for_input(double deadline)
+  {
+    const double timeout = deadline - window.time() - PACING_SPIN_TIME;
+    if (timeout > 0.0)
+      window.wait_events(timeout);
+    else
+      do_input();
+
+    if (deadline - window.time() > PACING_SPIN_TIME)
+      return;
+    while (window.time() < deadline)
+      std::this_thread::yield();
+  }
+
+  /** Blocks the calling thread until the specified time. */
+  void sleep_until(double deadline)
+  {
+    const double timeout = deadline - window.time() - PACING_SPIN_TIME;
+    if (timeout > 0.0)
+      std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+    while (window.time() < deadline)
+      std::this_thread::yield();
+  }
+
   /** Updates the state object. */
   void do_state(double abs_t, double delta_t)
   {
@@ -71,6 +147,170 @@ struct application::implementation
     state_manager.run(args);
   }
 
+  /**
+   * Records heap allocations made by a phase of the main loop, warning about the first one made
+   * once the loop has reached a steady state.
+   */
+  void check_allocations(const char* phase, uint64_t allocations)
+  {
+    if (allocations == 0 || frame_count < STEADY_STATE_FRAME_COUNT)
+      return;
+
+    if (steady_state_allocations.fetch_add(allocations) == 0)
+    {
+      std::ostringstream message;
+      message << "Heap allocation in steady-state " << phase << "! (" << allocations << " allocations)";
+      lineage_log_warning(message.str());
+    }
+  }
+
+  /** Runs the state and render loops one after the other on the calling thread. */
+  void run_serial()
+  {
+    double state_last_t = window.time();
+    double render_last_t = window.time();
+
+    while (!window.should_close())
+    {
+      // get current tick count
+      double abs_t = window.time();
+
+      // process state if needed
+      double state_delta_t = abs_t - state_last_t;
+      if (state_delta_t > state_manager.target_delta_t())
+      {
+        const uint64_t allocations = allocation_count();
+        do_state(abs_t, state_delta_t);
+        check_allocations("do_state", allocation_count() - allocations);
+        state_last_t = abs_t;
+      }
+
+      // render if needed
+      do_render_if_needed(abs_t, &render_last_t);
+
+      // handle input until whichever loop is due next
+      wait_for_input(std::min(state_last_t + state_manager.target_delta_t(),
+                              render_last_t + render_manager.target_delta_t()));
+    }
+  }
+
+  /**
+   * Runs the state loop on its own thread, while the calling thread handles input and rendering.
+   * Each frame renders the latest snapshot published by the state loop, so the state for the next
+   * frame is updated while the current frame is submitted.
+   */
+  void run_pipelined()
+  {
+    stopping = false;
+    std::thread state_thread([this] { state_main(); });
+    defer join_state_thread([&] {
+        stopping = true;
+        state_thread.join();
+      });
+
+    double render_last_t = window.time();
+    while (!window.should_close())
+    {
+      do_render_if_needed(window.time(), &render_last_t);
+      wait_for_input(render_last_t + render_manager.target_delta_t());
+    }
+  }
+
+  /**
+   * Runs the state and render loops in lockstep on a simulated clock, feeding in input from the
+   * replayer before each state update.
+   */
+  void run_replay()
+  {
+    // the simulated time is computed from the step count rather than accumulated, so that no
+    // rounding error builds up over a long recording
+    const double delta_t = state_manager.target_delta_t();
+    for (uint64_t step = 1; !window.should_close() && !replayer->is_finished(); step++)
+    {
+      const double abs_t = static_cast<double>(step) * delta_t;
+
+      // events still need to be polled to keep the window responsive, but live input is ignored
+      do_input();
+      replayer->advance(abs_t);
+
+      uint64_t allocations = allocation_count();
+      do_state(abs_t, delta_t);
+      check_allocations("do_state", allocation_count() - allocations);
+
+      allocations = allocation_count();
+      do_render(abs_t, delta_t);
+      check_allocations("do_render", allocation_count() - allocations);
+      report_frame_times(window.time());
+    }
+  }
+
+  /** Main loop for the state thread. */
+  void state_main()
+  {
+    try
+    {
+      double state_last_t = window.time();
+      while (!stopping)
+      {
+        const double abs_t = window.time();
+        const double state_delta_t = abs_t - state_last_t;
+        const double target_delta_t = state_manager.target_delta_t();
+        if (state_delta_t <= target_delta_t)
+        {
+          sleep_until(state_last_t + target_delta_t);
+          continue;
+        }
+
+        const uint64_t allocations = allocation_count();
+        do_state(abs_t, state_delta_t);
+        check_allocations("do_state", allocation_count() - allocations);
+        state_last_t = abs_t;
+      }
+    }
+    catch (...)
+    {
+      // hand the error to the main thread, which rethrows it once this thread has been joined
+      state_error = std::current_exception();
+      window.set_should_close(true);
+    }
+  }
+
+  /** Renders a frame if enough time has passed since the last one. */
+  void do_render_if_needed(double abs_t, double* render_last_t)
+  {
+    double render_delta_t = abs_t - *render_last_t;
+    if (render_delta_t > render_manager.target_delta_t())
+    {
+      const uint64_t allocations = allocation_count();
+      do_render(abs_t, render_delta_t);
+      check_allocations("do_render", allocation_count() - allocations);
+      *render_last_t = abs_t;
+      report_frame_times(abs_t);
+    }
+  }
+
+  /**
+   * Periodically logs the average CPU and GPU time per frame, showing whether rendering is bound
+   * by the CPU or the GPU.
+   */
+  void report_frame_times(double abs_t)
+  {
+    if (abs_t - report_start_t < FRAME_TIME_REPORT_INTERVAL || report_frame_count == 0)
+      return;
+
+    const double frames = static_cast<double>(report_frame_count);
+    std::ostringstream message;
+    message << "Frame time: CPU " << (report_cpu_time / frames) * MILLISECONDS_PER_SECOND << " ms, "
+            << "GPU " << (report_gpu_time / frames) * MILLISECONDS_PER_SECOND << " ms "
+            << "(" << report_frame_count << " frames)";
+    lineage_log_status(message.str());
+
+    report_start_t = abs_t;
+    report_frame_count = 0;
+    report_cpu_time = 0.0;
+    report_gpu_time = 0.0;
+  }
+
   /** Renders a frame. */
   void do_render(double abs_t, double delta_t)
   {
@@ -79,8 +319,17 @@ struct application::implementation
     args.delta_t = delta_t;
     window.framebuffer_size(&args.framebuffer_width, &args.framebuffer_height);
 
+    // the CPU time excludes the buffer swap, which may block waiting for the display
+    const double render_start_t = window.time();
     render_manager.render(args);
+    report_cpu_time += window.time() - render_start_t;
+    report_gpu_time += render_manager.gpu_frame_time();
+    report_frame_count++;
+
     window.swap_buffers();
+    frame_count++;
+    if (frame_limit != 0 && frame_count >= frame_limit)
+      window.set_should_close(true);
 
 #if defined(LINEAGE_DEBUG)
     GLenum error = opengl_error::last_error();
@@ -118,35 +367,34 @@ void application::main()
 {
   lineage_log_status("Entering main application loop...");
 
-  double state_last_t = impl->window.time();
-  double render_last_t = impl->window.time();
+  // input and rendering must stay on the main thread, so only the state loop can be moved
+  if (impl->replayer)
+    impl->run_replay();
+  else if (impl->state_manager.supports_concurrent_run())
+    impl->run_pipelined();
+  else
+    impl->run_serial();
 
-  while (!impl->window.should_close())
-  {
-    // process input every loop
-    impl->do_input();
+  lineage_log_status("Exited main application loop.");
 
-    // get current tick count
-    double abs_t = impl->window.time();
+  if (impl->state_error)
+    std::rethrow_exception(impl->state_error);
+}
 
-    // process state if needed
-    double state_delta_t = abs_t - state_last_t;
-    if (state_delta_t > impl->state_manager.target_delta_t())
-    {
-      impl->do_state(abs_t, state_delta_t);
-      state_last_t = abs_t;
-    }
+uint64_t application::steady_state_allocation_count() const
+{
+  return impl->steady_state_allocations;
+}
 
-    // render if needed
-    double render_delta_t = abs_t - render_last_t;
-    if (render_delta_t > impl->render_manager.target_delta_t())
-    {
-      impl->do_render(abs_t, render_delta_t);
-      render_last_t = abs_t;
-    }
-  }
+void application::set_frame_limit(uint64_t frame_limit)
+{
+  impl->frame_limit = frame_limit;
+}
 
-  lineage_log_status("Exited main application loop.");
+void application::set_input_replayer(input_replayer* replayer)
+{
+  impl->replayer = replayer;
+  impl->input_manager.set_window_input_enabled(replayer == nullptr);
 }
 
 void application::input_event(input_type type, input_state state)
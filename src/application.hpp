@@ -8,6 +8,7 @@
 
 /* -- Includes -- */
 
+#include <cstdint>
 #include <memory>
 
 #include "input_manager.hpp"
@@ -17,6 +18,7 @@
 namespace lineage
 {
 
+  class input_replayer;
   class opengl;
   class render_manager;
   class state_manager;
@@ -71,9 +73,41 @@ namespace lineage
 
     /**
      * Runs the main application loop.
+     *
+     * @note
+     * If the state manager supports it, the state loop runs on its own thread while this thread
+     * handles input and rendering. Any exception thrown by the state loop is rethrown here once the
+     * loop has exited.
      */
     void main();
 
+    /**
+     * The number of heap allocations made by the state and render passes of the main loop once it
+     * reached a steady state. This should always be zero - tests can fail if it is not.
+     *
+     * @note
+     * Allocations are only counted in debug builds.
+     */
+    uint64_t steady_state_allocation_count() const;
+
+    /**
+     * Sets the number of frames to render before the main loop exits, or zero to run until the
+     * window is closed.
+     */
+    void set_frame_limit(uint64_t frame_limit);
+
+    /**
+     * Plays back the specified recording instead of responding to live input, or stops playing
+     * back a recording if `replayer` is `nullptr`.
+     *
+     * @note
+     * While replaying, the main loop runs on a simulated clock which advances by exactly the state
+     * manager's target time step on every iteration, and renders one frame after each state
+     * update, as quickly as possible. Every replay of a recording therefore updates and renders
+     * exactly the same sequence of states. The loop exits once the end of the recording is reached.
+     */
+    void set_input_replayer(lineage::input_replayer* replayer);
+
     /* -- `lineage::input_observer` Implementation -- */
 
     virtual void input_event(lineage::input_type type, lineage::input_state state) override;
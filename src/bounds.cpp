@@ -0,0 +1,174 @@
+/**
+ * @file	bounds.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Procedures -- */
+
+void bounding_box_array::resize(size_t size)
+{
+  center_x.resize(size);
+  center_y.resize(size);
+  center_z.resize(size);
+  extent_x.resize(size);
+  extent_y.resize(size);
+  extent_z.resize(size);
+}
+
+void bounding_box_array::set(size_t index, const bounding_box& box)
+{
+  if (is_empty(box))
+  {
+    // use the largest finite value, so the culling math never produces a NaN
+    static const float empty_extent = -std::numeric_limits<float>::max();
+    center_x[index] = center_y[index] = center_z[index] = 0.0f;
+    extent_x[index] = extent_y[index] = extent_z[index] = empty_extent;
+    return;
+  }
+
+  const glm::vec3 box_center = center(box);
+  const glm::vec3 box_extent = extent(box);
+  center_x[index] = box_center.x;
+  center_y[index] = box_center.y;
+  center_z[index] = box_center.z;
+  extent_x[index] = box_extent.x;
+  extent_y[index] = box_extent.y;
+  extent_z[index] = box_extent.z;
+}
+
+size_t bounding_box_array::size() const
+{
+  return center_x.size();
+}
+
+bounding_box lineage::empty_bounding_box()
+{
+  static const float limit = std::numeric_limits<float>::max();
+  return { glm::vec3(limit), glm::vec3(-limit) };
+}
+
+bool lineage::is_empty(const bounding_box& box)
+{
+  return (box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z);
+}
+
+void lineage::expand(bounding_box& box, const glm::vec3& point)
+{
+  box.min = glm::min(box.min, point);
+  box.max = glm::max(box.max, point);
+}
+
+void lineage::expand(bounding_box& box, const bounding_box& other)
+{
+  if (is_empty(other))
+    return;
+  box.min = glm::min(box.min, other.min);
+  box.max = glm::max(box.max, other.max);
+}
+
+glm::vec3 lineage::center(const bounding_box& box)
+{
+  return (box.min + box.max) * 0.5f;
+}
+
+glm::vec3 lineage::extent(const bounding_box& box)
+{
+  return (box.max - box.min) * 0.5f;
+}
+
+float lineage::surface_area(const bounding_box& box)
+{
+  if (is_empty(box))
+    return 0.0f;
+  const glm::vec3 size = box.max - box.min;
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool lineage::intersects(const bounding_box& a, const bounding_box& b)
+{
+  return (a.min.x <= b.max.x && b.min.x <= a.max.x &&
+          a.min.y <= b.max.y && b.min.y <= a.max.y &&
+          a.min.z <= b.max.z && b.min.z <= a.max.z);
+}
+
+bool lineage::intersects(const bounding_sphere& sphere, const bounding_box& box)
+{
+  if (is_empty(box))
+    return false;
+  const glm::vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+  const glm::vec3 offset = closest - sphere.center;
+  return (glm::dot(offset, offset) <= sphere.radius * sphere.radius);
+}
+
+bool lineage::intersects(const ray& ray, const bounding_box& box, float* distance)
+{
+  if (is_empty(box))
+    return false;
+
+  // slab test - a zero direction component gives an infinite reciprocal, which works out correctly
+  // unless the origin lies exactly on a slab boundary
+  float near = 0.0f;
+  float far = ray.max_distance;
+  for (int axis = 0; axis < 3; axis++)
+  {
+    const float inverse = 1.0f / ray.direction[axis];
+    float t0 = (box.min[axis] - ray.origin[axis]) * inverse;
+    float t1 = (box.max[axis] - ray.origin[axis]) * inverse;
+    if (t0 > t1)
+      std::swap(t0, t1);
+    near = glm::max(near, t0);
+    far = glm::min(far, t1);
+    if (near > far)
+      return false;
+  }
+
+  if (distance)
+    *distance = near;
+  return true;
+}
+
+bounding_box lineage::transform(const bounding_box& box, const glm::mat4& matrix)
+{
+  if (is_empty(box))
+    return box;
+
+  // transform the center, and project the extents onto each axis using the absolute value of the
+  // rotation/scale part of the matrix (Arvo's method)
+  const glm::vec3 box_center = center(box);
+  const glm::vec3 box_extent = extent(box);
+
+  glm::vec3 new_center(matrix[3]);
+  glm::vec3 new_extent(0.0f);
+  for (int column = 0; column < 3; column++)
+  {
+    const glm::vec3 axis(matrix[column]);
+    new_center += axis * box_center[column];
+    new_extent += glm::abs(axis) * box_extent[column];
+  }
+
+  return { new_center - new_extent, new_center + new_extent };
+}
+
+bounding_sphere lineage::transform(const bounding_sphere& sphere, const glm::mat4& matrix)
+{
+  // scale the radius by the largest scale factor, so non-uniform scales remain conservative
+  const float scale = glm::max(glm::length(glm::vec3(matrix[0])),
+                               glm::max(glm::length(glm::vec3(matrix[1])),
+                                        glm::length(glm::vec3(matrix[2]))));
+  return { glm::vec3(matrix * glm::vec4(sphere.center, 1.0f)), sphere.radius * scale };
+}
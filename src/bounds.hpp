@@ -0,0 +1,148 @@
+/**
+ * @file	bounds.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Struct representing an axis-aligned bounding box.
+   *
+   * @note
+   * A box with any `min` component greater than the corresponding `max` component is empty.
+   */
+  struct bounding_box
+  {
+    glm::vec3 min;		/**< The minimum corner of the box. */
+    glm::vec3 max;		/**< The maximum corner of the box. */
+  };
+
+  /**
+   * Struct representing a bounding sphere.
+   */
+  struct bounding_sphere
+  {
+    glm::vec3 center;		/**< The center of the sphere. */
+    float radius;		/**< The radius of the sphere. */
+  };
+
+  /**
+   * Struct representing a ray, or a line segment if `max_distance` is finite.
+   */
+  struct ray
+  {
+    glm::vec3 origin;		/**< The origin of the ray. */
+    glm::vec3 direction;	/**< The direction of the ray. Does not need to be normalized. */
+    float max_distance;		/**< The maximum distance along the ray, in units of `direction`. */
+  };
+
+  /**
+   * Struct storing bounding boxes as separate arrays of centers and extents, for use by vectorized
+   * culling routines.
+   *
+   * @note
+   * Empty boxes are stored with negative extents, which never intersect anything.
+   */
+  struct bounding_box_array
+  {
+    std::vector<float> center_x;	/**< X coordinates of the box centers. */
+    std::vector<float> center_y;	/**< Y coordinates of the box centers. */
+    std::vector<float> center_z;	/**< Z coordinates of the box centers. */
+    std::vector<float> extent_x;	/**< Half-widths of the boxes along the X axis. */
+    std::vector<float> extent_y;	/**< Half-widths of the boxes along the Y axis. */
+    std::vector<float> extent_z;	/**< Half-widths of the boxes along the Z axis. */
+
+    /** Resizes every array to the specified number of boxes. */
+    void resize(size_t size);
+
+    /** Stores the specified box at the specified index. */
+    void set(size_t index, const lineage::bounding_box& box);
+
+    /** The number of boxes in the array. */
+    size_t size() const;
+  };
+
+}
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /**
+   * Returns an empty bounding box, which can be expanded to contain points or other boxes.
+   */
+  lineage::bounding_box empty_bounding_box();
+
+  /**
+   * Returns `true` if the specified bounding box contains no points.
+   */
+  bool is_empty(const lineage::bounding_box& box);
+
+  /**
+   * Expands `box` to contain the specified point.
+   */
+  void expand(lineage::bounding_box& box, const glm::vec3& point);
+
+  /**
+   * Expands `box` to contain the specified box.
+   */
+  void expand(lineage::bounding_box& box, const lineage::bounding_box& other);
+
+  /**
+   * Returns the center of the specified bounding box.
+   */
+  glm::vec3 center(const lineage::bounding_box& box);
+
+  /**
+   * Returns the half-widths of the specified bounding box along each axis.
+   */
+  glm::vec3 extent(const lineage::bounding_box& box);
+
+  /**
+   * Returns the surface area of the specified bounding box, or zero if it is empty.
+   */
+  float surface_area(const lineage::bounding_box& box);
+
+  /**
+   * Returns `true` if the specified boxes overlap.
+   */
+  bool intersects(const lineage::bounding_box& a, const lineage::bounding_box& b);
+
+  /**
+   * Returns `true` if the specified sphere overlaps the specified box.
+   */
+  bool intersects(const lineage::bounding_sphere& sphere, const lineage::bounding_box& box);
+
+  /**
+   * Returns `true` if the specified ray hits the specified box.
+   *
+   * @param distance
+   * If not `nullptr`, receives the distance along the ray to the first point inside the box.
+   */
+  bool intersects(const lineage::ray& ray, const lineage::bounding_box& box, float* distance = nullptr);
+
+  /**
+   * Returns the smallest axis-aligned box containing `box` after it is transformed by `matrix`.
+   */
+  lineage::bounding_box transform(const lineage::bounding_box& box, const glm::mat4& matrix);
+
+  /**
+   * Returns a sphere containing `sphere` after it is transformed by `matrix`.
+   */
+  lineage::bounding_sphere transform(const lineage::bounding_sphere& sphere, const glm::mat4& matrix);
+
+}
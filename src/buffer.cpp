@@ -9,6 +9,7 @@
 #include <limits>
 
 #include "buffer.hpp"
+#include "opengl.hpp"
 #include "opengl_error.hpp"
 
 /* -- Namespaces -- */
@@ -66,6 +67,7 @@ buffer::~buffer()
 {
   if (m_handle == INVALID_HANDLE)
     return;
+  opengl::forget_buffer(m_handle);
   glDeleteBuffers(1, &m_handle);
 }
 
@@ -84,6 +86,11 @@ void* buffer:: map(GLenum access)
   return glMapNamedBuffer(m_handle, access);
 }
 
+void* buffer::map_range(size_t offset, size_t size, GLbitfield access)
+{
+  return glMapNamedBufferRange(m_handle, offset, size, access);
+}
+
 void buffer::unmap()
 {
   glUnmapNamedBuffer(m_handle);
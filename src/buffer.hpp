@@ -66,6 +66,14 @@ namespace lineage
      */
     void* map(GLenum access);
 
+    /**
+     * Maps a range of this buffer to memory for direct access.
+     *
+     * @param access
+     * The access flags for the mapping (`GL_MAP_WRITE_BIT`, `GL_MAP_PERSISTENT_BIT`, etc.)
+     */
+    void* map_range(size_t offset, size_t size, GLbitfield access);
+
     /**
      * Unmaps this buffer.
      */
@@ -0,0 +1,584 @@
+/**
+ * @file	bvh.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "debug.hpp"
+#include "flat_scene_graph.hpp"
+#include "frustum.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // Number of bins used to evaluate candidate splits along each axis
+  const size_t BIN_COUNT = 16;
+
+  // Cost of traversing a node, relative to the cost of testing a scene node's bounds
+  const float TRAVERSAL_COST = 1.0f;
+
+  // The hierarchy is rebuilt once refitting has made it this much more expensive to traverse
+  const float REBUILD_COST_RATIO = 2.0f;
+
+  // Depth below which nodes are split at the median instead of by the surface area heuristic. This
+  // bounds the depth of the tree by this plus log2 of the primitive count.
+  const size_t MAX_SAH_DEPTH = 48;
+
+  // Capacity of the fixed traversal stack, which must exceed the maximum depth of the tree
+  const size_t MAX_TRAVERSAL_DEPTH = MAX_SAH_DEPTH + 48;
+
+  // Parent index used for the root of the hierarchy, and primitive index used for scene nodes which
+  // aren't stored in it
+  const uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+  const size_t NO_PRIMITIVE = std::numeric_limits<size_t>::max();
+}
+
+/* -- Variables -- */
+
+const size_t bvh::max_leaf_size;
+
+/* -- Procedures -- */
+
+bvh::bvh()
+  : m_layout_revision(0),
+    m_built(false),
+    m_build_cost(0.0f),
+    m_weighted_area(0.0),
+    m_nodes(),
+    m_primitive_nodes(),
+    m_node_primitives(),
+    m_primitive_leaves(),
+    m_parents(),
+    m_refit_marks(),
+    m_refit_nodes(),
+    m_refit_pass(0),
+    m_primitive_boxes(),
+    m_primitive_box_array(),
+    m_build_primitives()
+{
+}
+
+void bvh::update(const flat_scene_graph& graph)
+{
+  if (!m_built || m_layout_revision != graph.layout_revision())
+  {
+    build(graph);
+    return;
+  }
+
+  // the quality of the tree can only change if it was refit
+  if (refit(graph) && cost() > m_build_cost * REBUILD_COST_RATIO)
+    build(graph);
+}
+
+void bvh::build(const flat_scene_graph& graph)
+{
+  m_layout_revision = graph.layout_revision();
+  m_built = true;
+
+  // only nodes with meshes can be drawn, so only these are stored in the hierarchy - the scratch
+  // vector is kept between builds, so a rebuild in the steady state doesn't allocate
+  std::vector<primitive>& primitives = m_build_primitives;
+  primitives.clear();
+  for (size_t index = 0; index < graph.size(); index++)
+  {
+    const auto& box = graph.bounds(index);
+    if (!is_empty(box))
+      primitives.push_back({ box, center(box), index });
+  }
+
+  m_nodes.clear();
+  if (!primitives.empty())
+    build_node(primitives, 0, primitives.size(), 0);
+
+  // store the primitives in leaf order, so each node refers to a contiguous range of them
+  m_primitive_nodes.resize(primitives.size());
+  m_primitive_boxes.resize(primitives.size());
+  m_primitive_box_array.resize(primitives.size());
+  m_node_primitives.assign(graph.size(), NO_PRIMITIVE);
+  for (size_t index = 0; index < primitives.size(); index++)
+  {
+    m_primitive_nodes[index] = primitives[index].node_index;
+    m_primitive_boxes[index] = primitives[index].box;
+    m_primitive_box_array.set(index, primitives[index].box);
+    m_node_primitives[primitives[index].node_index] = index;
+  }
+
+  // record the parent of each node and the leaf holding each primitive, so that refitting can
+  // walk upwards from the primitives which have moved
+  m_parents.assign(m_nodes.size(), NO_PARENT);
+  m_primitive_leaves.resize(primitives.size());
+  for (size_t index = 0; index < m_nodes.size(); index++)
+  {
+    const auto& current = m_nodes[index];
+    if (current.right_child != 0)
+    {
+      m_parents[index + 1] = static_cast<uint32_t>(index);
+      m_parents[current.right_child] = static_cast<uint32_t>(index);
+      continue;
+    }
+    for (size_t offset = 0; offset < current.primitive_count; offset++)
+      m_primitive_leaves[current.first_primitive + offset] = static_cast<uint32_t>(index);
+  }
+  m_refit_marks.assign(m_nodes.size(), 0);
+  m_refit_pass = 0;
+
+  // the weighted area is kept up to date by refitting, so the cost never needs a full pass again
+  m_weighted_area = 0.0;
+  for (const auto& current : m_nodes)
+    m_weighted_area += weighted_area(current);
+  m_build_cost = cost();
+}
+
+bool bvh::refit(const flat_scene_graph& graph)
+{
+  lineage_assert(m_layout_revision == graph.layout_revision());
+
+  // each pass marks the nodes it visits with its own number, so the marks never need clearing
+  if (++m_refit_pass == 0)
+  {
+    std::fill(m_refit_marks.begin(), m_refit_marks.end(), 0);
+    m_refit_pass = 1;
+  }
+
+  // update the moved primitives, and collect their leaves and every ancestor of those leaves -
+  // each walk stops at the first node which an earlier walk has already collected
+  m_refit_nodes.clear();
+  for (const auto& node_index : graph.changed_nodes())
+  {
+    const size_t primitive_index = m_node_primitives[node_index];
+    if (primitive_index == NO_PRIMITIVE)
+      continue;
+
+    m_primitive_boxes[primitive_index] = graph.bounds(node_index);
+    m_primitive_box_array.set(primitive_index, m_primitive_boxes[primitive_index]);
+
+    for (uint32_t index = m_primitive_leaves[primitive_index];
+         index != NO_PARENT && m_refit_marks[index] != m_refit_pass;
+         index = m_parents[index])
+    {
+      m_refit_marks[index] = m_refit_pass;
+      m_refit_nodes.push_back(index);
+    }
+  }
+
+  if (m_refit_nodes.empty())
+    return false;
+
+  // children are always stored after their parents, so refitting in descending order of index
+  // refits bottom-up
+  std::sort(m_refit_nodes.begin(), m_refit_nodes.end(), std::greater<uint32_t>());
+  for (const auto& index : m_refit_nodes)
+  {
+    auto& current = m_nodes[index];
+    m_weighted_area -= weighted_area(current);
+    current.box = empty_bounding_box();
+    if (current.right_child == 0)
+    {
+      for (size_t offset = 0; offset < current.primitive_count; offset++)
+        expand(current.box, m_primitive_boxes[current.first_primitive + offset]);
+    }
+    else
+    {
+      expand(current.box, m_nodes[index + 1].box);
+      expand(current.box, m_nodes[current.right_child].box);
+    }
+    m_weighted_area += weighted_area(current);
+  }
+
+  return true;
+}
+
+void bvh::query(const frustum& frustum, std::vector<size_t>* results) const
+{
+  if (m_nodes.empty())
+    return;
+  query(frustum, 0, results);
+}
+
+void bvh::query(const frustum& frustum, size_t root, std::vector<size_t>* results) const
+{
+  lineage_assert(root < m_nodes.size());
+
+  containment leaf_results[max_leaf_size];
+  uint32_t stack[MAX_TRAVERSAL_DEPTH];
+  size_t stack_size = 0;
+  stack[stack_size++] = static_cast<uint32_t>(root);
+  while (stack_size != 0)
+  {
+    const size_t index = stack[--stack_size];
+    const auto& current = m_nodes[index];
+
+    const auto result = frustum.classify(current.box);
+    if (result == containment::outside)
+      continue;
+
+    // everything below a node which is entirely inside the frustum is visible
+    if (result == containment::inside)
+    {
+      append_primitives(current, results);
+      continue;
+    }
+
+    if (current.right_child == 0)
+    {
+      // test the contents of the leaf with the vectorized kernel
+      frustum.classify(m_primitive_box_array,
+                       current.first_primitive,
+                       current.primitive_count,
+                       leaf_results);
+      for (size_t offset = 0; offset < current.primitive_count; offset++)
+      {
+        if (leaf_results[offset] != containment::outside)
+          results->push_back(m_primitive_nodes[current.first_primitive + offset]);
+      }
+      continue;
+    }
+
+    lineage_assert(stack_size + 2 <= MAX_TRAVERSAL_DEPTH);
+    stack[stack_size++] = current.right_child;
+    stack[stack_size++] = static_cast<uint32_t>(index + 1);
+  }
+}
+
+void bvh::query(const bounding_box& box, std::vector<size_t>* results) const
+{
+  traverse([&] (const bounding_box& other) { return intersects(box, other); }, results);
+}
+
+void bvh::query(const bounding_sphere& sphere, std::vector<size_t>* results) const
+{
+  traverse([&] (const bounding_box& other) { return intersects(sphere, other); }, results);
+}
+
+void bvh::query(const ray& ray, std::vector<size_t>* results) const
+{
+  traverse([&] (const bounding_box& other) { return intersects(ray, other); }, results);
+}
+
+bool bvh::raycast(const ray& ray, size_t* node_index, float* distance) const
+{
+  if (m_nodes.empty())
+    return false;
+
+  bool hit = false;
+  float best_distance = ray.max_distance;
+  uint32_t stack[MAX_TRAVERSAL_DEPTH];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size != 0)
+  {
+    const size_t index = stack[--stack_size];
+    const auto& current = m_nodes[index];
+
+    // skip anything further away than the best hit so far
+    lineage::ray clipped = { ray.origin, ray.direction, best_distance };
+    if (!intersects(clipped, current.box))
+      continue;
+
+    if (current.right_child == 0)
+    {
+      for (size_t offset = 0; offset < current.primitive_count; offset++)
+      {
+        float primitive_distance = 0.0f;
+        if (intersects(clipped, m_primitive_boxes[current.first_primitive + offset], &primitive_distance) &&
+            primitive_distance <= best_distance)
+        {
+          hit = true;
+          best_distance = primitive_distance;
+          clipped.max_distance = best_distance;
+          *node_index = m_primitive_nodes[current.first_primitive + offset];
+        }
+      }
+      continue;
+    }
+
+    // visit the nearer child first, so that more of the tree can be skipped
+    float left_distance = std::numeric_limits<float>::max();
+    float right_distance = std::numeric_limits<float>::max();
+    const bool left_hit = intersects(clipped, m_nodes[index + 1].box, &left_distance);
+    const bool right_hit = intersects(clipped, m_nodes[current.right_child].box, &right_distance);
+    lineage_assert(stack_size + 2 <= MAX_TRAVERSAL_DEPTH);
+    if (left_hit && right_hit)
+    {
+      if (left_distance <= right_distance)
+      {
+        stack[stack_size++] = current.right_child;
+        stack[stack_size++] = static_cast<uint32_t>(index + 1);
+      }
+      else
+      {
+        stack[stack_size++] = static_cast<uint32_t>(index + 1);
+        stack[stack_size++] = current.right_child;
+      }
+    }
+    else if (left_hit)
+    {
+      stack[stack_size++] = static_cast<uint32_t>(index + 1);
+    }
+    else if (right_hit)
+    {
+      stack[stack_size++] = current.right_child;
+    }
+  }
+
+  if (hit)
+    *distance = best_distance;
+  return hit;
+}
+
+void bvh::partition(size_t count, std::vector<size_t>* roots) const
+{
+  roots->clear();
+  if (m_nodes.empty())
+    return;
+  roots->push_back(0);
+
+  // replace every interior node in the frontier with its children, one level at a time, working
+  // backwards so that the frontier can be expanded in place and stays in depth-first order
+  while (roots->size() < count)
+  {
+    const size_t interior_count = std::count_if(roots->begin(), roots->end(), [&] (size_t index) {
+        return m_nodes[index].right_child != 0;
+      });
+    if (interior_count == 0)
+      break;
+
+    size_t target = roots->size() + interior_count;
+    roots->resize(target);
+    for (size_t source = roots->size() - interior_count; source-- > 0; )
+    {
+      const size_t index = (*roots)[source];
+      const auto& current = m_nodes[index];
+      if (current.right_child == 0)
+      {
+        (*roots)[--target] = index;
+        continue;
+      }
+      (*roots)[--target] = current.right_child;
+      (*roots)[--target] = index + 1;
+    }
+  }
+}
+
+size_t bvh::node_count() const
+{
+  return m_nodes.size();
+}
+
+size_t bvh::primitive_count() const
+{
+  return m_primitive_nodes.size();
+}
+
+size_t bvh::build_node(std::vector<primitive>& primitives, size_t first, size_t count, size_t depth)
+{
+  const size_t index = m_nodes.size();
+  m_nodes.push_back(node());
+
+  bounding_box box = empty_bounding_box();
+  bounding_box centroid_box = empty_bounding_box();
+  for (size_t offset = first; offset < first + count; offset++)
+  {
+    expand(box, primitives[offset].box);
+    expand(centroid_box, primitives[offset].centroid);
+  }
+
+  m_nodes[index].box = box;
+  m_nodes[index].first_primitive = static_cast<uint32_t>(first);
+  m_nodes[index].primitive_count = static_cast<uint32_t>(count);
+  m_nodes[index].right_child = 0;
+
+  if (count == 1)
+    return index;
+
+  // evaluate the surface area heuristic at each bin boundary along each axis
+  struct bin
+  {
+    bounding_box box;
+    size_t count;
+  };
+
+  int best_axis = -1;
+  size_t best_split = 0;
+  float best_cost = std::numeric_limits<float>::max();
+  for (int axis = 0; axis < 3 && depth < MAX_SAH_DEPTH; axis++)
+  {
+    const float axis_min = centroid_box.min[axis];
+    const float axis_extent = centroid_box.max[axis] - axis_min;
+    if (axis_extent <= 0.0f)
+      continue;
+
+    bin bins[BIN_COUNT];
+    for (auto& current : bins)
+      current = { empty_bounding_box(), 0 };
+
+    const float scale = static_cast<float>(BIN_COUNT) / axis_extent;
+    for (size_t offset = first; offset < first + count; offset++)
+    {
+      const auto bin_index = std::min(BIN_COUNT - 1,
+                                      static_cast<size_t>((primitives[offset].centroid[axis] - axis_min) * scale));
+      bins[bin_index].count++;
+      expand(bins[bin_index].box, primitives[offset].box);
+    }
+
+    // sweep from the right to find the cost of everything right of each split...
+    float right_costs[BIN_COUNT];
+    bounding_box right_box = empty_bounding_box();
+    size_t right_count = 0;
+    for (size_t split = BIN_COUNT - 1; split > 0; split--)
+    {
+      expand(right_box, bins[split].box);
+      right_count += bins[split].count;
+      right_costs[split] = surface_area(right_box) * static_cast<float>(right_count);
+    }
+
+    // ...and from the left to combine it with the cost of everything left of each split
+    bounding_box left_box = empty_bounding_box();
+    size_t left_count = 0;
+    for (size_t split = 1; split < BIN_COUNT; split++)
+    {
+      expand(left_box, bins[split - 1].box);
+      left_count += bins[split - 1].count;
+      if (left_count == 0 || left_count == count)
+        continue;
+
+      const float split_cost = surface_area(left_box) * static_cast<float>(left_count) + right_costs[split];
+      if (split_cost < best_cost)
+      {
+        best_axis = axis;
+        best_split = split;
+        best_cost = split_cost;
+      }
+    }
+  }
+
+  // make this a leaf if splitting is no cheaper than testing everything in it
+  const float area = surface_area(box);
+  const float leaf_cost = static_cast<float>(count);
+  if (count <= max_leaf_size &&
+      (best_axis < 0 || area <= 0.0f || TRAVERSAL_COST + best_cost / area >= leaf_cost))
+    return index;
+
+  size_t middle = first + count / 2;
+  if (depth >= MAX_SAH_DEPTH)
+  {
+    // the tree is already deep - split at the median along the longest axis to keep it balanced
+    const glm::vec3 centroid_extent = centroid_box.max - centroid_box.min;
+    int axis = 0;
+    if (centroid_extent[1] > centroid_extent[axis])
+      axis = 1;
+    if (centroid_extent[2] > centroid_extent[axis])
+      axis = 2;
+    std::nth_element(primitives.begin() + first,
+                     primitives.begin() + middle,
+                     primitives.begin() + first + count,
+                     [&] (const primitive& a, const primitive& b) {
+                       return (a.centroid[axis] < b.centroid[axis]);
+                     });
+  }
+  else if (best_axis >= 0)
+  {
+    const float axis_min = centroid_box.min[best_axis];
+    const float scale = static_cast<float>(BIN_COUNT) / (centroid_box.max[best_axis] - axis_min);
+    auto it = std::partition(primitives.begin() + first,
+                             primitives.begin() + first + count,
+                             [&] (const primitive& current) {
+                               const auto bin_index = std::min(BIN_COUNT - 1,
+                                                               static_cast<size_t>((current.centroid[best_axis] - axis_min) * scale));
+                               return (bin_index < best_split);
+                             });
+    middle = static_cast<size_t>(it - primitives.begin());
+  }
+
+  // every centroid is identical - split down the middle so that leaves stay small
+  if (middle == first || middle == first + count)
+    middle = first + count / 2;
+
+  build_node(primitives, first, middle - first, depth + 1);
+  const size_t right_child = build_node(primitives, middle, first + count - middle, depth + 1);
+  m_nodes[index].right_child = static_cast<uint32_t>(right_child);
+
+  return index;
+}
+
+float bvh::cost() const
+{
+  if (m_nodes.empty())
+    return 0.0f;
+
+  // the expected cost of a query is proportional to the total area of the nodes, relative to the
+  // area of the root
+  const float root_area = surface_area(m_nodes.front().box);
+  if (root_area <= 0.0f)
+    return 0.0f;
+
+  return static_cast<float>(m_weighted_area / root_area);
+}
+
+double bvh::weighted_area(const node& current)
+{
+  const double area = surface_area(current.box);
+  if (current.right_child == 0)
+    return area * static_cast<double>(current.primitive_count);
+  else
+    return area * TRAVERSAL_COST;
+}
+
+template <typename TTest>
+void bvh::traverse(TTest test, std::vector<size_t>* results) const
+{
+  if (m_nodes.empty())
+    return;
+
+  uint32_t stack[MAX_TRAVERSAL_DEPTH];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size != 0)
+  {
+    const size_t index = stack[--stack_size];
+    const auto& current = m_nodes[index];
+
+    if (!test(current.box))
+      continue;
+
+    if (current.right_child == 0)
+    {
+      for (size_t offset = 0; offset < current.primitive_count; offset++)
+      {
+        if (test(m_primitive_boxes[current.first_primitive + offset]))
+          results->push_back(m_primitive_nodes[current.first_primitive + offset]);
+      }
+      continue;
+    }
+
+    lineage_assert(stack_size + 2 <= MAX_TRAVERSAL_DEPTH);
+    stack[stack_size++] = current.right_child;
+    stack[stack_size++] = static_cast<uint32_t>(index + 1);
+  }
+}
+
+void bvh::append_primitives(const node& node, std::vector<size_t>* results) const
+{
+  results->insert(results->end(),
+                  m_primitive_nodes.begin() + node.first_primitive,
+                  m_primitive_nodes.begin() + node.first_primitive + node.primitive_count);
+}
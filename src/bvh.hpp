@@ -0,0 +1,203 @@
+/**
+ * @file	bvh.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class flat_scene_graph;
+  class frustum;
+
+  /**
+   * Class representing a bounding volume hierarchy over the world-space bounds of every renderable
+   * node in a `lineage::flat_scene_graph`.
+   *
+   * @note
+   * The hierarchy is built using the surface area heuristic. When nodes move, only the leaves
+   * holding them and their ancestors are refit in place, and the hierarchy is only rebuilt if the
+   * structure of the graph changes or refitting has degraded its quality too far. All queries
+   * return indices into the flattened scene graph.
+   */
+  class bvh
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The maximum number of scene nodes stored in each leaf. */
+    static const size_t max_leaf_size = 8;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new, empty `lineage::bvh` instance.
+     */
+    bvh();
+
+  private:
+
+    bvh(const lineage::bvh&) = delete;
+    bvh(lineage::bvh&&) = delete;
+    lineage::bvh& operator =(const lineage::bvh&) = delete;
+    lineage::bvh& operator =(lineage::bvh&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Rebuilds the hierarchy if the layout of `graph` has changed, and otherwise refits it to the
+     * bounds of any nodes which have moved.
+     *
+     * @note
+     * This should be called after every update of `graph`, since it relies on
+     * `lineage::flat_scene_graph::changed_nodes()` to find the nodes which have moved.
+     */
+    void update(const lineage::flat_scene_graph& graph);
+
+    /**
+     * Unconditionally rebuilds the hierarchy from the specified graph.
+     */
+    void build(const lineage::flat_scene_graph& graph);
+
+    /**
+     * Updates the bounds of the hierarchy for any nodes in `graph` which have moved, without
+     * changing its structure. Only the leaves holding those nodes and their ancestors are refit.
+     *
+     * @return
+     * `true` if any bounds were updated.
+     */
+    bool refit(const lineage::flat_scene_graph& graph);
+
+    /**
+     * Appends the index of every node whose bounds intersect the specified frustum to `results`.
+     */
+    void query(const lineage::frustum& frustum, std::vector<size_t>* results) const;
+
+    /**
+     * Appends the index of every node below the specified hierarchy node whose bounds intersect the
+     * specified frustum to `results`.
+     *
+     * @note
+     * Queries of different subtrees only read from the hierarchy, so they can run concurrently.
+     */
+    void query(const lineage::frustum& frustum, size_t root, std::vector<size_t>* results) const;
+
+    /**
+     * Appends the index of every node whose bounds intersect the specified box to `results`.
+     */
+    void query(const lineage::bounding_box& box, std::vector<size_t>* results) const;
+
+    /**
+     * Appends the index of every node whose bounds intersect the specified sphere to `results`.
+     */
+    void query(const lineage::bounding_sphere& sphere, std::vector<size_t>* results) const;
+
+    /**
+     * Appends the index of every node whose bounds are hit by the specified ray to `results`.
+     */
+    void query(const lineage::ray& ray, std::vector<size_t>* results) const;
+
+    /**
+     * Finds the node whose bounds are hit first by the specified ray.
+     *
+     * @param node_index
+     * Receives the index of the node which was hit.
+     *
+     * @param distance
+     * Receives the distance along the ray to the node's bounds.
+     *
+     * @return
+     * `true` if any node was hit.
+     */
+    bool raycast(const lineage::ray& ray, size_t* node_index, float* distance) const;
+
+    /**
+     * Splits the hierarchy into disjoint subtrees which together cover every scene node, so that a
+     * query can be divided between threads.
+     *
+     * @param count
+     * The minimum number of subtrees to split the hierarchy into. Fewer subtrees are returned if
+     * the hierarchy has too few leaves.
+     *
+     * @param roots
+     * Receives the index of the root of each subtree, in depth-first order.
+     */
+    void partition(size_t count, std::vector<size_t>* roots) const;
+
+    /**
+     * The number of nodes in the hierarchy.
+     */
+    size_t node_count() const;
+
+    /**
+     * The number of scene nodes stored in the hierarchy.
+     */
+    size_t primitive_count() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct node
+    {
+      lineage::bounding_box box;
+      uint32_t first_primitive;
+      uint32_t primitive_count;
+      uint32_t right_child;		// zero for leaves - the left child always follows its parent
+    };
+
+    struct primitive
+    {
+      lineage::bounding_box box;
+      glm::vec3 centroid;
+      size_t node_index;
+    };
+
+    size_t build_node(std::vector<primitive>& primitives, size_t first, size_t count, size_t depth);
+    float cost() const;
+    static double weighted_area(const node& current);
+
+    template <typename TTest>
+    void traverse(TTest test, std::vector<size_t>* results) const;
+
+    void append_primitives(const node& node, std::vector<size_t>* results) const;
+
+    uint64_t m_layout_revision;
+    bool m_built;
+    float m_build_cost;
+    double m_weighted_area;
+    std::vector<node> m_nodes;
+    std::vector<size_t> m_primitive_nodes;
+    std::vector<size_t> m_node_primitives;
+    std::vector<uint32_t> m_primitive_leaves;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_refit_marks;
+    std::vector<uint32_t> m_refit_nodes;
+    uint32_t m_refit_pass;
+    std::vector<lineage::bounding_box> m_primitive_boxes;
+    lineage::bounding_box_array m_primitive_box_array;
+    std::vector<primitive> m_build_primitives;
+
+  };
+
+}
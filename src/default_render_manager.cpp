@@ -6,7 +6,11 @@
 
 /* -- Includes -- */
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -16,16 +20,33 @@
 
 #include "api.hpp"
 #include "buffer.hpp"
+#include "bvh.hpp"
+#include "constants.hpp"
+#include "debug.hpp"
 #include "default_render_manager.hpp"
 #include "default_state_manager.hpp"
+#include "flat_scene_graph.hpp"
+#include "frame_arena.hpp"
+#include "frustum.hpp"
+#include "geometry_pool.hpp"
+#include "gpu_profiler.hpp"
+#include "lod_chain.hpp"
 #include "mesh.hpp"
+#include "occlusion_culler.hpp"
 #include "opengl.hpp"
+#include "program_cache.hpp"
+#include "query.hpp"
 #include "render_manager.hpp"
+#include "render_queue.hpp"
 #include "scene_graph.hpp"
-#include "shader.hpp"
+#include "scene_node.hpp"
+#include "scene_snapshot.hpp"
 #include "shader_program.hpp"
 #include "shader_source.hpp"
 #include "state_manager.hpp"
+#include "streaming_buffer.hpp"
+#include "thread_pool.hpp"
+#include "uniform_blocks.hpp"
 #include "util.hpp"
 #include "vertex.hpp"
 #include "vertex_array.hpp"
@@ -38,24 +59,92 @@ using namespace lineage;
 
 namespace
 {
-  // Uniform locations
-  const GLuint MODEL_MATRIX_UNIFORM_LOCATION = 0;
-  const GLuint VIEW_MATRIX_UNIFORM_LOCATION = 1;
-  const GLuint PROJ_MATRIX_UNIFORM_LOCATION = 2;
-  const GLuint AMBIENT_LIGHT_COLOR_UNIFORM_LOCATION = 3;
-  const GLuint AMBIENT_LIGHT_INTENSITY_UNIFORM_LOCATION = 4;
-
   // Attribute locations
   const GLuint VERTEX_POSITION_ATTRIBUTE_LOCATION = 0;
   const GLuint VERTEX_NORMAL_ATTRIBUTE_LOCATION = 1;
   const GLuint VERTEX_COLOR_ATTRIBUTE_LOCATION = 2;
+  const GLuint INSTANCE_MODEL_MATRIX_ATTRIBUTE_LOCATION = 3;	// occupies 3-6
+  const GLuint INSTANCE_COLOR_ATTRIBUTE_LOCATION = 7;
 
-  // Misc
+  // Binding indices
   const GLuint BINDING_INDEX = 0;
+  const GLuint INSTANCE_BINDING_INDEX = 1;
+
+  // Render keys
+  const uint64_t OPAQUE_RENDER_PASS = 0;
+  const uint64_t DEFAULT_PROGRAM_KEY = 0;
+  const float MAX_DEPTH_KEY = static_cast<float>((1u << RENDER_KEY_DEPTH_BITS) - 1);
+
+  // Occlusion proxies
+  const size_t PROXY_VERTEX_COUNT = 8;
+  const size_t PROXY_INDEX_COUNT = 36;
+  const size_t NO_GROUP = occlusion_culler::no_group;
+
+  // Level of detail
+  const float LOD_HYSTERESIS = 0.1f;
+
+  // Streaming
+  const size_t INITIAL_STREAM_REGION_SIZE = 1 << 20;
+  const size_t INSTANCE_ALIGNMENT = 16;
+  const size_t INDIRECT_COMMAND_ALIGNMENT = 4;
+
+  // Parallel draw list construction
+  const size_t PARALLEL_NODE_THRESHOLD = 4096;
+  const size_t TASKS_PER_THREAD = 4;
 }
 
 /* -- Types -- */
 
+namespace
+{
+
+  /** Per-instance data streamed to the instanced vertex shader. */
+  struct instance
+  {
+    glm::mat4 model_matrix;	/**< The world matrix of the node being drawn. */
+    glm::vec4 color;		/**< The color to tint the mesh with. */
+  };
+
+  /** Command record consumed by `glMultiDrawElementsIndirect`. */
+  struct draw_elements_indirect_command
+  {
+    GLuint count;		/**< Number of indices to draw. */
+    GLuint instance_count;	/**< Number of instances to draw. */
+    GLuint first_index;		/**< Offset of the first index, in indices. */
+    GLint base_vertex;		/**< Value added to each index. */
+    GLuint base_instance;	/**< Offset of the first instance in the instance buffer. */
+  };
+
+  /** Visible nodes and draw items collected by a single thread. */
+  struct draw_list
+  {
+    std::vector<size_t> visible_nodes;			/**< Nodes found inside the view frustum. */
+    std::vector<lineage::draw_item> items;		/**< Items to draw unconditionally. */
+    std::vector<lineage::draw_item> conditional_items;	/**< Items in groups occluded last frame. */
+  };
+
+  /** A run of sorted draw items for the same mesh, drawn with a single instanced draw. */
+  struct draw_batch
+  {
+    uint64_t key;		/**< The render key of the first item in the batch. */
+    const lineage::mesh* mesh;	/**< The mesh to draw. */
+    size_t first_instance;	/**< Index of the first instance in this batch. */
+    size_t instance_count;	/**< Number of instances in this batch. */
+    size_t group;		/**< The occlusion group drawn conditionally, or `no_group`. */
+  };
+
+  /** A range of indirect commands which can be submitted without changing any state. */
+  struct draw_bucket
+  {
+    uint64_t key;		/**< The render key of the first batch in the bucket. */
+    const lineage::mesh* mesh;	/**< The first mesh in the bucket, providing the shared state. */
+    size_t first_command;	/**< Index of the first command in this bucket. */
+    size_t command_count;	/**< Number of commands in this bucket. */
+    size_t group;		/**< The occlusion group drawn conditionally, or `no_group`. */
+  };
+
+}
+
 /**
  * Implementation for the `lineage::default_render_manager` class.
  */
@@ -64,11 +153,41 @@ struct default_render_manager::implementation
 
   /* -- Constructor -- */
 
-  implementation(lineage::opengl& opengl, const lineage::default_state_manager& state_manager)
+  implementation(lineage::opengl& opengl,
+                 const lineage::default_state_manager& state_manager,
+                 lineage::program_cache& program_cache)
     : opengl(opengl),
       state_manager(state_manager),
-      program(implementation::create_shader_program()),
-      vao(implementation::create_vertex_array<vertex>())
+      snapshot(nullptr),
+      program(implementation::create_shader_program(program_cache)),
+      vao(implementation::create_vertex_array<vertex>()),
+      stream(INITIAL_STREAM_REGION_SIZE,
+             std::max({ opengl.uniform_buffer_offset_alignment(), INSTANCE_ALIGNMENT, INDIRECT_COMMAND_ALIGNMENT })),
+      uniform_alignment(opengl.uniform_buffer_offset_alignment()),
+      frame_uniforms_offset(0),
+      flat_graph(),
+      hierarchy(),
+      workers(),
+      cull_roots(),
+      draw_lists(workers.thread_count()),
+      lod_levels(),
+      lod_layout_revision(0),
+      occlusion(),
+      proxy_geometry(PROXY_VERTEX_COUNT, PROXY_INDEX_COUNT),
+      proxy_mesh(implementation::create_proxy_mesh(proxy_geometry)),
+      proxy_first_instance(0),
+      queue(),
+      conditional_queue(),
+      arena(),
+      batches(),
+      instances(),
+      instances_offset(0),
+      use_indirect(opengl.is_supported("GL_ARB_multi_draw_indirect")),
+      indirect_commands(),
+      indirect_buckets(),
+      indirect_commands_offset(0),
+      profiler(opengl),
+      stats()
   {
     // one-time setup
     enable_depth_testing();
@@ -79,41 +198,59 @@ struct default_render_manager::implementation
 
   lineage::opengl& opengl;
   const lineage::default_state_manager& state_manager;
+  const lineage::scene_snapshot* snapshot;
   const std::unique_ptr<const lineage::shader_program> program;
   const std::unique_ptr<lineage::vertex_array> vao;
+  lineage::streaming_buffer stream;
+  const size_t uniform_alignment;
+  size_t frame_uniforms_offset;
+  lineage::flat_scene_graph flat_graph;
+  lineage::bvh hierarchy;
+  lineage::thread_pool workers;
+  std::vector<size_t> cull_roots;
+  std::vector<draw_list> draw_lists;
+  std::vector<uint8_t> lod_levels;
+  uint64_t lod_layout_revision;
+  lineage::occlusion_culler occlusion;
+  lineage::geometry_pool proxy_geometry;
+  const std::unique_ptr<const lineage::mesh> proxy_mesh;
+  size_t proxy_first_instance;
+  lineage::render_queue queue;
+  lineage::render_queue conditional_queue;
+  lineage::frame_arena arena;
+  std::vector<draw_batch> batches;
+  std::vector<instance> instances;
+  size_t instances_offset;
+  const bool use_indirect;
+  std::vector<draw_elements_indirect_command> indirect_commands;
+  std::vector<draw_bucket> indirect_buckets;
+  size_t indirect_commands_offset;
+  lineage::gpu_profiler profiler;
+  lineage::render_stats stats;
 
   /* -- Procedures -- */
 
   /** Enables depth testing. */
   void enable_depth_testing()
   {
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    opengl.set_capability(GL_DEPTH_TEST, true);
+    opengl.set_depth_func(GL_LESS);
   }
 
   /** Enables face culling. */
   void enable_face_culling()
   {
-    glEnable(GL_CULL_FACE);
-    glFrontFace(GL_CCW);
-    glCullFace(GL_BACK);
-  }
-
-  /** Create the model matrix to use for rendering a specific scene node. */
-  glm::mat4 model_matrix(const lineage::scene_node& node, const glm::mat4& model_matrix) const
-  {
-    return model_matrix *
-      glm::translate(node.position()) *
-      glm::scale(node.scale()) *
-      glm::mat4_cast(node.rotation());
+    opengl.set_capability(GL_CULL_FACE, true);
+    opengl.set_front_face(GL_CCW);
+    opengl.set_cull_face(GL_BACK);
   }
 
   /** Create the view matrix to use for rendering. */
   glm::mat4 view_matrix() const
   {
     auto matrix =
-      glm::translate(state_manager.camera_position()) *
-      glm::mat4_cast(state_manager.camera_rotation());
+      glm::translate(snapshot->camera_position) *
+      glm::mat4_cast(snapshot->camera_rotation);
     return glm::inverse(matrix);
   }
 
@@ -123,81 +260,483 @@ struct default_render_manager::implementation
     auto aspect_ratio =
       static_cast<float>(args.framebuffer_width) /
       static_cast<float>(args.framebuffer_height);
-    return glm::perspective(state_manager.camera_fov(),
+    return glm::perspective(snapshot->camera_fov,
                             aspect_ratio,
-                            state_manager.camera_clip_near(),
-                            state_manager.camera_clip_far());
+                            snapshot->camera_clip_near,
+                            snapshot->camera_clip_far);
+  }
+
+  /**
+   * Writes the frame uniforms, instances, and indirect commands for this frame to the streaming
+   * buffer, and binds the frame uniform block for every program using it.
+   */
+  void upload_frame_data(const glm::mat4& view_matrix, const glm::mat4& proj_matrix)
+  {
+    // everything must fit in this frame's region before anything is written to it
+    const size_t instances_size = instances.size() * sizeof(instance);
+    const size_t indirect_commands_size = indirect_commands.size() * sizeof(draw_elements_indirect_command);
+    stream.reserve(sizeof(frame_uniforms) + uniform_alignment +
+                   instances_size + INSTANCE_ALIGNMENT +
+                   indirect_commands_size + INDIRECT_COMMAND_ALIGNMENT);
+
+    auto* frame = stream.allocate<frame_uniforms>(1, uniform_alignment, &frame_uniforms_offset);
+    frame->view_matrix = view_matrix;
+    frame->proj_matrix = proj_matrix;
+    frame->view_proj_matrix = proj_matrix * view_matrix;
+    frame->camera_position = glm::vec4(snapshot->camera_position, 1.0f);
+    frame->ambient_light_color = snapshot->ambient_light_color;
+    frame->ambient_light_intensity = snapshot->ambient_light_intensity;
+    opengl.bind_uniform_buffer(FRAME_UNIFORM_BINDING, stream.storage(), frame_uniforms_offset, sizeof(frame_uniforms));
+
+    auto* instance_data = stream.allocate<instance>(instances.size(), INSTANCE_ALIGNMENT, &instances_offset);
+    std::copy(instances.begin(), instances.end(), instance_data);
+
+    auto* command_data = stream.allocate<draw_elements_indirect_command>(indirect_commands.size(),
+                                                                          INDIRECT_COMMAND_ALIGNMENT,
+                                                                          &indirect_commands_offset);
+    std::copy(indirect_commands.begin(), indirect_commands.end(), command_data);
+
+    stats.streamed_bytes = stream.region_used();
   }
 
   /** Initialize the framebuffer for rendering. */
   void render_init(const render_args& args)
   {
     // set viewport
-    glViewport(0, 0, args.framebuffer_width, args.framebuffer_height);
+    opengl.set_viewport(0, 0, args.framebuffer_width, args.framebuffer_height);
 
     // clear buffer
-    glm::vec4 background_color = state_manager.background_color();
-    glClearColor(background_color.r,
-                 background_color.g,
-                 background_color.b,
-                 background_color.a);
-    glClearDepth(1.0f);
+    opengl.set_clear_color(snapshot->background_color);
+    opengl.set_clear_depth(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   }
 
-  /** Renders the specified scene node. */
-  void render_scene_node(const lineage::scene_graph& graph,
-                         const lineage::scene_node& node,
-                         const glm::mat4& parent_model_matrix)
+  /** Updates the hierarchy to the current node bounds, and finds which groups were occluded. */
+  void cull(const lineage::frustum& view_frustum)
+  {
+    hierarchy.update(flat_graph);
+    occlusion.update(flat_graph,
+                     view_frustum,
+                     snapshot->camera_position,
+                     snapshot->camera_clip_near);
+    stats.occlusion_queries = occlusion.tested_groups().size();
+    stats.conditional_groups = occlusion.conditional_group_count();
+  }
+
+  /**
+   * Finds every node whose bounds intersect the view frustum, adds a draw item for every mesh (and
+   * the selected LOD level) of each one to the render queues, and sorts them.
+   *
+   * @note
+   * Large scenes are split into subtrees of the hierarchy, which are traversed on every thread of
+   * the pool. Each thread collects its items into its own draw list, and the lists are merged into
+   * the render queues on the calling thread.
+   */
+  void build_render_queue(const lineage::scene_graph& graph,
+                          const lineage::frustum& view_frustum,
+                          const glm::mat4& view_matrix)
+  {
+    lineage_assert(graph.meshes().size() <= (1u << RENDER_KEY_MESH_BITS));
+    lineage_assert(graph.geometry().page_count() <= (1u << RENDER_KEY_PAGE_BITS));
+
+    const float clip_near = snapshot->camera_clip_near;
+    const float depth_scale = 1.0f / (snapshot->camera_clip_far - clip_near);
+    const float projection_scale = 1.0f / glm::tan(snapshot->camera_fov * 0.5f);
+
+    // the selected levels are indexed by flat node, so they're only valid for a single layout
+    if (lod_layout_revision != flat_graph.layout_revision())
+    {
+      lod_levels.assign(flat_graph.size(), 0);
+      lod_layout_revision = flat_graph.layout_revision();
+    }
+
+    for (auto& list : draw_lists)
+    {
+      list.visible_nodes.clear();
+      list.items.clear();
+      list.conditional_items.clear();
+    }
+
+    // several subtrees per thread give idle threads something to steal when the cost is uneven
+    const size_t task_count = (hierarchy.primitive_count() < PARALLEL_NODE_THRESHOLD) ?
+      1 : (workers.thread_count() * TASKS_PER_THREAD);
+    hierarchy.partition(task_count, &cull_roots);
+
+    // every scene node is stored in exactly one subtree, so each selected LOD level is only
+    // written by a single thread
+    workers.parallel_for(cull_roots.size(), 1, [&] (size_t begin, size_t end, size_t thread_index) {
+        auto& list = draw_lists[thread_index];
+        for (size_t root = begin; root < end; root++)
+        {
+          const size_t first_visible = list.visible_nodes.size();
+          hierarchy.query(view_frustum, cull_roots[root], &list.visible_nodes);
+
+          for (size_t visible = first_visible; visible < list.visible_nodes.size(); visible++)
+          {
+            const size_t index = list.visible_nodes[visible];
+            const auto& node = flat_graph.node(index);
+
+            // nodes in groups which were occluded last frame are held back to be drawn conditionally
+            const size_t group = occlusion.group(index);
+            auto& target = (group != NO_GROUP && occlusion.is_conditional(group)) ? list.conditional_items : list.items;
+
+            // quantize the view-space distance to the node's origin, so that nearer instances of
+            // each mesh are drawn first
+            const glm::vec4 origin = view_matrix * flat_graph.world_matrix(index)[3];
+            const float distance = glm::clamp((-origin.z - clip_near) * depth_scale, 0.0f, 1.0f);
+            const uint64_t depth = static_cast<uint64_t>(distance * MAX_DEPTH_KEY);
+
+            for (const auto& mesh_index : node.meshes())
+              push_draw_item(target, graph, mesh_index, index, depth);
+            if (node.lod_chain() != scene_node::no_lod_chain)
+              push_draw_item(target, graph, select_lod_mesh(graph, index, projection_scale), index, depth);
+          }
+        }
+      });
+
+    queue.clear();
+    conditional_queue.clear();
+    stats.visible_nodes = 0;
+    for (const auto& list : draw_lists)
+    {
+      queue.append(list.items.data(), list.items.size());
+      conditional_queue.append(list.conditional_items.data(), list.conditional_items.size());
+      stats.visible_nodes += list.visible_nodes.size();
+    }
+
+    queue.sort();
+    conditional_queue.sort();
+    stats.draw_items = queue.items().size() + conditional_queue.items().size();
+  }
+
+  /** Adds a draw item for a single mesh of a node to the specified list. */
+  void push_draw_item(std::vector<lineage::draw_item>& target,
+                      const lineage::scene_graph& graph,
+                      size_t mesh_index,
+                      size_t node_index,
+                      uint64_t depth)
+  {
+    const auto& mesh = *graph.meshes()[mesh_index];
+
+    // there is only one vertex format, so the format field distinguishes draw modes instead,
+    // since these can't be mixed within a single draw call either - every draw mode enum is
+    // below 16, so they fit in the field
+    draw_item item;
+    item.key = make_render_key(OPAQUE_RENDER_PASS,
+                               DEFAULT_PROGRAM_KEY,
+                               mesh.draw_mode(),
+                               mesh.page_index(),
+                               mesh_index,
+                               depth);
+    item.mesh_index = static_cast<uint32_t>(mesh_index);
+    item.node_index = static_cast<uint32_t>(node_index);
+    target.push_back(item);
+  }
+
+  /**
+   * Selects the level of a node's LOD chain to draw this frame, and returns its mesh.
+   *
+   * @note
+   * The projected size is the diameter of the full-resolution mesh's bounding sphere as a fraction
+   * of the viewport height. The level drawn last frame is kept until the size moves clearly past a
+   * threshold, so that nodes sitting near a threshold don't flicker between levels.
+   */
+  size_t select_lod_mesh(const lineage::scene_graph& graph, size_t node_index, float projection_scale)
   {
-    // update the model matrix for this specific node
-    auto model_matrix = this->model_matrix(node, parent_model_matrix);
-    opengl.set_uniform(MODEL_MATRIX_UNIFORM_LOCATION, model_matrix);
+    const auto& chain = graph.lod_chains()[flat_graph.node(node_index).lod_chain()];
+    lineage_assert(chain.levels.size() <= std::numeric_limits<uint8_t>::max() + 1u);
+
+    const auto& full_mesh = *graph.meshes()[chain.levels.front().mesh_index];
+    const auto sphere = transform(full_mesh.bounding_sphere(), flat_graph.world_matrix(node_index));
+    const float distance = glm::distance(sphere.center, snapshot->camera_position);
+    const float screen_size = (distance > sphere.radius) ?
+      (sphere.radius * projection_scale / distance) :
+      std::numeric_limits<float>::max();
+
+    auto& level = lod_levels[node_index];
+    level = static_cast<uint8_t>(select_lod_level(chain, screen_size, level, LOD_HYSTERESIS));
+    return chain.levels[level].mesh_index;
+  }
 
-    // render all meshes for this node
-    for (const auto& mesh_index : node.meshes())
+  /**
+   * Builds the instance data for the sorted queues, merging adjacent items into batches, and
+   * appends an instance for each occlusion proxy.
+   *
+   * @note
+   * Batches for the main queue come first. Conditional items follow, grouped by occlusion group
+   * (and in key order within each group), since each group is drawn against its own query.
+   */
+  void collect_instances(const lineage::scene_graph& graph)
+  {
+    instances.clear();
+    batches.clear();
+    append_batches(graph, queue.items().data(), queue.items().size(), false);
+
+    // stable counting sort of the conditional items by group, in scratch space from the arena
+    const auto& items = conditional_queue.items();
+    size_t group_count = 0;
+    for (const auto& item : items)
+      group_count = std::max(group_count, occlusion.group(item.node_index) + 1);
+    auto* group_offsets = arena.allocate<size_t>(group_count + 1);
+    std::fill(group_offsets, group_offsets + group_count + 1, 0);
+    for (const auto& item : items)
+      group_offsets[occlusion.group(item.node_index) + 1]++;
+    for (size_t group = 0; group < group_count; group++)
+      group_offsets[group + 1] += group_offsets[group];
+    auto* conditional_items = arena.allocate<draw_item>(items.size());
+    for (const auto& item : items)
+      conditional_items[group_offsets[occlusion.group(item.node_index)]++] = item;
+    append_batches(graph, conditional_items, items.size(), true);
+
+    // the proxy cube spans -0.5 to 0.5, so scale it to the size of each group's bounds
+    proxy_first_instance = instances.size();
+    for (const auto& group : occlusion.tested_groups())
     {
-      const auto& mesh = *graph.meshes()[mesh_index];
-      render_mesh(mesh);
+      const auto& bounds = occlusion.proxy_bounds(group);
+      instance data;
+      data.model_matrix = glm::translate(center(bounds)) * glm::scale(bounds.max - bounds.min);
+      data.color = COLOR_WHITE;
+      instances.push_back(data);
     }
+  }
 
-    // recursively render child nodes
-    for (const auto& child_node : node.children())
-      render_scene_node(graph, child_node, model_matrix);
+  /** Appends instance data and batches for the specified sorted items. */
+  void append_batches(const lineage::scene_graph& graph, const draw_item* items, size_t count, bool conditional)
+  {
+    for (size_t index = 0; index < count; index++)
+    {
+      const auto& item = items[index];
+      const size_t group = conditional ? occlusion.group(item.node_index) : NO_GROUP;
+      if (batches.empty() ||
+          render_key_batch(batches.back().key) != render_key_batch(item.key) ||
+          batches.back().group != group)
+      {
+        batches.push_back({ item.key, graph.meshes()[item.mesh_index].get(), instances.size(), 0, group });
+      }
+      batches.back().instance_count++;
+
+      instance data;
+      data.model_matrix = flat_graph.world_matrix(item.node_index);
+      data.color = flat_graph.color(item.node_index);
+      instances.push_back(data);
+    }
   }
 
-  /** Renders the specified mesh. */
-  void render_mesh(const lineage::mesh& mesh)
+  /**
+   * Renders either the unconditional or the conditional batches, with one instanced draw call per
+   * batch.
+   */
+  void render_instances(bool conditional)
   {
-    // bind vertex buffer
-    vao->bind_buffer(BINDING_INDEX, mesh.vertex_buffer(), 0, mesh.vertex_size());
+    if (batches.empty())
+      return;
+
+    vao->bind_buffer(INSTANCE_BINDING_INDEX, stream.storage(), instances_offset, sizeof(instance));
+    defer unbind_instance_buffer([&] { vao->unbind_buffer(INSTANCE_BINDING_INDEX); });
+
+    // batches are sorted by state, so buffers only need to be rebound when the state bits change
+    bool state_bound = false;
+    uint64_t bound_state = 0;
+    defer unbind_buffers([&] {
+        if (!state_bound)
+          return;
+        opengl.pop_buffer(GL_ELEMENT_ARRAY_BUFFER);
+        vao->unbind_buffer(BINDING_INDEX);
+      });
+
+    for (const auto& batch : batches)
+    {
+      if ((batch.group != NO_GROUP) != conditional)
+        continue;
+
+      const auto& mesh = *batch.mesh;
+      if (!state_bound || render_key_state(batch.key) != bound_state)
+      {
+        if (state_bound)
+          opengl.pop_buffer(GL_ELEMENT_ARRAY_BUFFER);
+        vao->bind_buffer(BINDING_INDEX, mesh.vertex_buffer(), 0, mesh.vertex_size());
+        opengl.push_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer());
+        state_bound = true;
+        bound_state = render_key_state(batch.key);
+        stats.state_changes++;
+      }
+
+      if (conditional)
+        opengl.begin_conditional_render(occlusion.query(batch.group), GL_QUERY_WAIT);
+      render_mesh(mesh, batch.first_instance, batch.instance_count);
+      if (conditional)
+        opengl.end_conditional_render();
+    }
+  }
+
+  /**
+   * Draws the bounds of each tested occlusion group inside its query, without writing to the
+   * color or depth buffers.
+   */
+  void render_occlusion_queries()
+  {
+    const auto& groups = occlusion.tested_groups();
+    if (groups.empty())
+      return;
+
+    opengl.set_color_mask(false, false, false, false);
+    opengl.set_depth_mask(false);
+    defer restore_masks([&] {
+        opengl.set_depth_mask(true);
+        opengl.set_color_mask(true, true, true, true);
+      });
+
+    vao->bind_buffer(INSTANCE_BINDING_INDEX, stream.storage(), instances_offset, sizeof(instance));
+    defer unbind_instance_buffer([&] { vao->unbind_buffer(INSTANCE_BINDING_INDEX); });
+
+    vao->bind_buffer(BINDING_INDEX, proxy_mesh->vertex_buffer(), 0, proxy_mesh->vertex_size());
     defer unbind_vertex_buffer([&] { vao->unbind_buffer(BINDING_INDEX); });
 
-    opengl.push_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer());
+    opengl.push_buffer(GL_ELEMENT_ARRAY_BUFFER, proxy_mesh->index_buffer());
     defer unbind_element_buffer([&] { opengl.pop_buffer(GL_ELEMENT_ARRAY_BUFFER); });
 
-    // draw vertices
-    static const void* NO_OFFSET = reinterpret_cast<void*>(0);
-    glDrawElements(mesh.draw_mode(), mesh.index_count(), mesh.index_datatype(), NO_OFFSET);
+    for (size_t index = 0; index < groups.size(); index++)
+    {
+      auto& group_query = occlusion.query(groups[index]);
+      group_query.begin();
+      render_mesh(*proxy_mesh, proxy_first_instance + index, 1);
+      group_query.end();
+      occlusion.set_query_issued(groups[index]);
+    }
+  }
+
+  /** Builds an indirect command for every batch, grouped into buckets of identical state. */
+  void collect_indirect_commands()
+  {
+    indirect_commands.clear();
+    indirect_buckets.clear();
+
+    for (const auto& batch : batches)
+    {
+      const auto& mesh = *batch.mesh;
+      if (indirect_buckets.empty() ||
+          render_key_state(indirect_buckets.back().key) != render_key_state(batch.key) ||
+          indirect_buckets.back().group != batch.group)
+      {
+        indirect_buckets.push_back({ batch.key, &mesh, indirect_commands.size(), 0, batch.group });
+      }
+      indirect_buckets.back().command_count++;
+
+      draw_elements_indirect_command command;
+      command.count = static_cast<GLuint>(mesh.index_count());
+      command.instance_count = static_cast<GLuint>(batch.instance_count);
+      command.first_index = static_cast<GLuint>(mesh.first_index());
+      command.base_vertex = static_cast<GLint>(mesh.base_vertex());
+      command.base_instance = static_cast<GLuint>(batch.first_instance);
+      indirect_commands.push_back(command);
+    }
   }
 
-  /** Creates the shader program for the renderer to be use. */
-  static std::unique_ptr<shader_program> create_shader_program()
+  /**
+   * Renders either the unconditional or the conditional batches, with one multi-draw call per
+   * state bucket.
+   */
+  void render_indirect(bool conditional)
+  {
+    if (indirect_commands.empty())
+      return;
+
+    vao->bind_buffer(INSTANCE_BINDING_INDEX, stream.storage(), instances_offset, sizeof(instance));
+    defer unbind_instance_buffer([&] { vao->unbind_buffer(INSTANCE_BINDING_INDEX); });
+
+    opengl.push_buffer(GL_DRAW_INDIRECT_BUFFER, stream.storage());
+    defer unbind_indirect_buffer([&] { opengl.pop_buffer(GL_DRAW_INDIRECT_BUFFER); });
+
+    for (const auto& bucket : indirect_buckets)
+    {
+      if ((bucket.group != NO_GROUP) != conditional)
+        continue;
+
+      const auto& mesh = *bucket.mesh;
+
+      vao->bind_buffer(BINDING_INDEX, mesh.vertex_buffer(), 0, mesh.vertex_size());
+      defer unbind_vertex_buffer([&] { vao->unbind_buffer(BINDING_INDEX); });
+
+      opengl.push_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer());
+      defer unbind_element_buffer([&] { opengl.pop_buffer(GL_ELEMENT_ARRAY_BUFFER); });
+
+      stats.state_changes++;
+
+      const size_t bucket_scope = profiler.begin_scope("bucket");
+      defer end_bucket_scope([&] { profiler.end_scope(bucket_scope); });
+
+      if (conditional)
+        opengl.begin_conditional_render(occlusion.query(bucket.group), GL_QUERY_WAIT);
+
+      const auto* offset = reinterpret_cast<const void*>(indirect_commands_offset +
+                                                        bucket.first_command * sizeof(draw_elements_indirect_command));
+      glMultiDrawElementsIndirect(mesh.draw_mode(),
+                                  mesh.index_datatype(),
+                                  offset,
+                                  static_cast<GLsizei>(bucket.command_count),
+                                  sizeof(draw_elements_indirect_command));
+      stats.draw_calls++;
+
+      if (conditional)
+        opengl.end_conditional_render();
+    }
+  }
+
+  /**
+   * Renders the specified range of instances of the specified mesh.
+   *
+   * @note
+   * The mesh's vertex and index buffers must already be bound.
+   */
+  void render_mesh(const lineage::mesh& mesh, size_t first_instance, size_t instance_count)
+  {
+    // the base vertex and index offset select the mesh within its pooled buffers, and the base
+    // instance selects its range of the instance buffer
+    glDrawElementsInstancedBaseVertexBaseInstance(mesh.draw_mode(),
+                                                  mesh.index_count(),
+                                                  mesh.index_datatype(),
+                                                  reinterpret_cast<const void*>(mesh.index_offset()),
+                                                  static_cast<GLsizei>(instance_count),
+                                                  static_cast<GLint>(mesh.base_vertex()),
+                                                  static_cast<GLuint>(first_instance));
+    stats.draw_calls++;
+  }
+
+  /** Creates the unit cube drawn to test occlusion groups. */
+  static std::unique_ptr<const lineage::mesh> create_proxy_mesh(lineage::geometry_pool& geometry)
   {
-    shader vertex_shader(GL_VERTEX_SHADER);
-    vertex_shader.set_source(shader_source_string(shader_source::default_vertex_shader));
-    vertex_shader.compile();
+    static const std::vector<GLuint> INDICES
+    {
+      0, 2, 1, 1, 2, 3,		// -x
+      4, 5, 6, 5, 7, 6,		// +x
+      0, 1, 4, 1, 5, 4,		// -y
+      2, 6, 3, 3, 6, 7,		// +y
+      0, 4, 2, 2, 4, 6,		// -z
+      1, 3, 5, 3, 7, 5,		// +z
+    };
+
+    std::vector<vertex> vertices;
+    for (size_t corner = 0; corner < PROXY_VERTEX_COUNT; corner++)
+    {
+      const glm::vec3 position((corner & 4) ? 0.5f : -0.5f,
+                               (corner & 2) ? 0.5f : -0.5f,
+                               (corner & 1) ? 0.5f : -0.5f);
+      vertices.push_back({ position, { }, COLOR_WHITE, { } });
+    }
 
-    shader fragment_shader(GL_FRAGMENT_SHADER);
-    fragment_shader.set_source(shader_source_string(shader_source::default_fragment_shader));
-    fragment_shader.compile();
+    return std::make_unique<const lineage::mesh>(geometry, GL_TRIANGLES, vertices, INDICES);
+  }
+
+  /** Creates the shader program for the renderer to be use. */
+  static std::unique_ptr<shader_program> create_shader_program(lineage::program_cache& program_cache)
+  {
+    auto program = program_cache.create_program({
+        { GL_VERTEX_SHADER, shader_source_string(shader_source::default_instanced_vertex_shader) },
+        { GL_FRAGMENT_SHADER, shader_source_string(shader_source::default_fragment_shader) },
+      });
 
-    auto program = std::make_unique<shader_program>();
-    program->attach_shader(vertex_shader);
-    program->attach_shader(fragment_shader);
-    program->link();
-    program->detach_shader(vertex_shader);
-    program->detach_shader(fragment_shader);
+    // block bindings aren't part of the linked program, so they're set even if it was restored
+    program->set_uniform_block_binding(FRAME_UNIFORM_BLOCK_NAME, FRAME_UNIFORM_BINDING);
 
     return program;
   }
@@ -221,6 +760,20 @@ struct default_render_manager::implementation
                         VERTEX_COLOR_ATTRIBUTE_LOCATION,
                         color_attribute_spec<TVertex>());
 
+    // the model matrix is passed as four column vectors
+    for (GLuint column = 0; column < 4; column++)
+    {
+      configure_attribute(*vao,
+                          INSTANCE_BINDING_INDEX,
+                          INSTANCE_MODEL_MATRIX_ATTRIBUTE_LOCATION + column,
+                          { 4, GL_FLOAT, false, offsetof(instance, model_matrix) + column * sizeof(glm::vec4) });
+    }
+    configure_attribute(*vao,
+                        INSTANCE_BINDING_INDEX,
+                        INSTANCE_COLOR_ATTRIBUTE_LOCATION,
+                        { 4, GL_FLOAT, false, offsetof(instance, color) });
+    vao->set_binding_divisor(INSTANCE_BINDING_INDEX, 1);
+
     return vao;
   }
 
@@ -228,8 +781,10 @@ struct default_render_manager::implementation
 
 /* -- Procedures -- */
 
-default_render_manager::default_render_manager(opengl& opengl, const default_state_manager& state_manager)
-  : impl(std::make_unique<implementation>(opengl, state_manager))
+default_render_manager::default_render_manager(opengl& opengl,
+                                               const default_state_manager& state_manager,
+                                               program_cache& program_cache)
+  : impl(std::make_unique<implementation>(opengl, state_manager, program_cache))
 {
 }
 
@@ -237,6 +792,20 @@ default_render_manager::~default_render_manager() = default;
 
 void default_render_manager::render(const render_args& args)
 {
+  impl->stats = render_stats();
+  impl->opengl.reset_call_stats();
+
+  // declared first so that it runs last, after every deferred unbind
+  defer record_call_stats([&] {
+      impl->stats.gl_calls_issued = impl->opengl.call_stats().issued;
+      impl->stats.gl_calls_elided = impl->opengl.call_stats().elided;
+      impl->stats.gpu_frame_time = impl->profiler.frame_time();
+    });
+
+  // timing for this frame is read back a few frames from now, so this never waits for the GPU
+  impl->profiler.begin_frame();
+  defer end_gpu_frame([&] { impl->profiler.end_frame(); });
+
   // activate program
   impl->opengl.push_program(*impl->program);
   defer pop_program([&] { impl->opengl.pop_program(); });
@@ -245,23 +814,82 @@ void default_render_manager::render(const render_args& args)
   impl->opengl.push_vertex_array(*impl->vao);
   defer pop_vertex_array([&] { impl->opengl.pop_vertex_array(); });
 
-  // set common uniforms
-  impl->opengl.set_uniform(VIEW_MATRIX_UNIFORM_LOCATION, impl->view_matrix());
-  impl->opengl.set_uniform(PROJ_MATRIX_UNIFORM_LOCATION, impl->proj_matrix(args));
-  impl->opengl.set_uniform(AMBIENT_LIGHT_COLOR_UNIFORM_LOCATION, impl->state_manager.ambient_light_color());
-  impl->opengl.set_uniform(AMBIENT_LIGHT_INTENSITY_UNIFORM_LOCATION, impl->state_manager.ambient_light_intensity());
+  // transient data for this frame is streamed through the next region of the streaming buffer,
+  // which is fenced once every command reading from it has been submitted
+  impl->stream.begin_frame();
+  defer end_stream_frame([&] { impl->stream.end_frame(); });
+  impl->arena.reset();
+
+  // everything read from the application state comes from a single snapshot, so the frame is
+  // consistent even while the state is being updated on another thread
+  impl->snapshot = &impl->state_manager.latest_snapshot();
+
+  const auto view_matrix = impl->view_matrix();
+  const auto proj_matrix = impl->proj_matrix(args);
 
   // initialize framebuffer
-  impl->render_init(args);
+  {
+    const size_t scope = impl->profiler.begin_scope("clear");
+    defer end_scope([&] { impl->profiler.end_scope(scope); });
+    impl->render_init(args);
+  }
 
-  // recursively render nodes
-  glm::mat4 model_matrix = glm::mat4();
+  // recompute world matrices for the subtrees the state changed before submitting anything - the
+  // transforms come from the snapshot, since the state may already be changing for the next frame
   const auto& graph = impl->state_manager.scene_graph();
-  for (const auto& node : graph.nodes())
-    impl->render_scene_node(graph, node, model_matrix);
+  impl->flat_graph.update(graph, impl->snapshot->nodes, impl->snapshot->changed_nodes);
+
+  // find which groups were occluded last frame, and then collect and sort everything inside the view
+  // frustum by state, so that each run of the same mesh can be drawn as one instanced draw
+  const lineage::frustum view_frustum(proj_matrix * view_matrix);
+  impl->cull(view_frustum);
+  impl->build_render_queue(graph, view_frustum, view_matrix);
+  impl->collect_instances(graph);
+  if (impl->use_indirect)
+    impl->collect_indirect_commands();
+  impl->upload_frame_data(view_matrix, proj_matrix);
+
+  // draw everything known to be visible first, so that it occludes the proxies tested against it,
+  // and then draw the groups which were occluded last frame only if their proxies were visible
+  {
+    const size_t scope = impl->profiler.begin_scope("opaque");
+    defer end_scope([&] { impl->profiler.end_scope(scope); });
+    if (impl->use_indirect)
+      impl->render_indirect(false);
+    else
+      impl->render_instances(false);
+  }
+  {
+    const size_t scope = impl->profiler.begin_scope("occlusion queries");
+    defer end_scope([&] { impl->profiler.end_scope(scope); });
+    impl->render_occlusion_queries();
+  }
+  {
+    const size_t scope = impl->profiler.begin_scope("conditional");
+    defer end_scope([&] { impl->profiler.end_scope(scope); });
+    if (impl->use_indirect)
+      impl->render_indirect(true);
+    else
+      impl->render_instances(true);
+  }
 }
 
 double default_render_manager::target_delta_t() const
 {
   return (1.0 / 60.0); // 60 HZ
 }
+
+double default_render_manager::gpu_frame_time() const
+{
+  return impl->profiler.frame_time();
+}
+
+const render_stats& default_render_manager::frame_stats() const
+{
+  return impl->stats;
+}
+
+const std::vector<gpu_scope_timing>& default_render_manager::gpu_scope_timings() const
+{
+  return impl->profiler.scope_timings();
+}
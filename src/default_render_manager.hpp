@@ -8,7 +8,12 @@
 
 /* -- Includes -- */
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
+
+#include "gpu_profiler.hpp"
 #include "render_manager.hpp"
 
 /* -- Types -- */
@@ -18,6 +23,24 @@ namespace lineage
 
   class default_state_manager;
   class opengl;
+  class program_cache;
+
+  /**
+   * Struct containing statistics for a single frame rendered by `lineage::default_render_manager`.
+   */
+  struct render_stats
+  {
+    size_t visible_nodes;	/**< The number of nodes with meshes which passed culling. */
+    size_t draw_items;		/**< The number of items submitted to the render queue. */
+    size_t draw_calls;		/**< The number of draw calls issued. */
+    size_t state_changes;	/**< The number of times GL state was changed between draws. */
+    size_t occlusion_queries;	/**< The number of occlusion queries issued. */
+    size_t conditional_groups;	/**< The number of occlusion groups drawn conditionally. */
+    size_t streamed_bytes;	/**< The number of bytes written to the streaming buffer. */
+    uint64_t gl_calls_issued;	/**< The number of GL state changes issued through `lineage::opengl`. */
+    uint64_t gl_calls_elided;	/**< The number of redundant GL state changes skipped by `lineage::opengl`. */
+    double gpu_frame_time;	/**< The GPU time of the latest frame whose timing is known, in seconds. */
+  };
 
   /**
    * Render manager implementation.
@@ -37,8 +60,13 @@ namespace lineage
      *
      * @param state_manager
      * The state manager in use by the application.
+     *
+     * @param program_cache
+     * The cache to restore the renderer's shader programs from.
      */
-    default_render_manager(lineage::opengl& opengl, const lineage::default_state_manager& state_manager);
+    default_render_manager(lineage::opengl& opengl,
+                           const lineage::default_state_manager& state_manager,
+                           lineage::program_cache& program_cache);
 
     /**
      * Destructor.
@@ -58,6 +86,22 @@ namespace lineage
 
     virtual void render(const lineage::render_args& args);
     virtual double target_delta_t() const;
+    virtual double gpu_frame_time() const;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns statistics for the most recently rendered frame.
+     */
+    const lineage::render_stats& frame_stats() const;
+
+    /**
+     * Returns the GPU time of each named scope (clear, opaque pass, occlusion queries, etc.) of the
+     * latest frame whose timing is known.
+     */
+    const std::vector<lineage::gpu_scope_timing>& gpu_scope_timings() const;
 
     /* -- Implementation -- */
 
@@ -6,7 +6,10 @@
 
 /* -- Includes -- */
 
+#include <atomic>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -18,7 +21,9 @@
 #include "mesh.hpp"
 #include "scene_builder.hpp"
 #include "scene_graph.hpp"
+#include "scene_snapshot.hpp"
 #include "state_manager.hpp"
+#include "triple_buffer.hpp"
 #include "vertex.hpp"
 
 /* -- Namespaces -- */
@@ -86,9 +91,9 @@ struct default_state_manager::implementation : public input_observer
 
   /* -- Constructor -- */
 
-  implementation(const lineage::input_manager& input_manager)
+  implementation(const lineage::input_manager& input_manager, lineage::scene_graph&& scene_graph)
     : input_manager(input_manager),
-      scene_graph(create_multiple_cubes_scene_graph()),
+      scene_graph(std::move(scene_graph)),
       mode(input_mode::camera),
       camera_position(DEFAULT_CAMERA_POSITION),
       camera_rotation(DEFAULT_CAMERA_ROTATION),
@@ -98,8 +103,13 @@ struct default_state_manager::implementation : public input_observer
       background_color(DEFAULT_BACKGROUND_COLOR),
       ambient_light_color(DEFAULT_AMBIENT_LIGHT_COLOR),
       ambient_light_intensity(DEFAULT_AMBIENT_LIGHT_INTENSITY),
-      selected_node_index(0)
+      selected_node_index(0),
+      snapshots(),
+      snapshot_stack(),
+      snapshot_skipped(false)
   {
+    // the renderer may run before the first iteration of the state loop
+    publish_snapshot();
     input_manager.add_observer(*this);
   }
 
@@ -113,7 +123,8 @@ struct default_state_manager::implementation : public input_observer
   const lineage::input_manager& input_manager;
   lineage::scene_graph scene_graph;
 
-  input_mode mode;
+  // input events arrive on the input thread, which may not be the thread running the state loop
+  std::atomic<input_mode> mode;
   glm::vec3 camera_position;
   glm::quat camera_rotation;
   float camera_fov;
@@ -122,7 +133,10 @@ struct default_state_manager::implementation : public input_observer
   glm::vec4 background_color;
   glm::vec4 ambient_light_color;
   float ambient_light_intensity;
-  size_t selected_node_index;
+  std::atomic<size_t> selected_node_index;
+  mutable lineage::triple_buffer<lineage::scene_snapshot> snapshots;
+  std::vector<const lineage::scene_node*> snapshot_stack;
+  bool snapshot_skipped;
 
   /* -- `lineage::input_observer` Implementation -- */
 
@@ -159,7 +173,9 @@ struct default_state_manager::implementation : public input_observer
       switch (mode)
       {
       case input_mode::object:
-        selected_node_index = ((selected_node_index + 1) % scene_graph.nodes().size());
+        // an empty scene has nothing to select
+        if (node_count() != 0)
+          selected_node_index = ((selected_node_index + 1) % node_count());
         break;
       default:
         break;
@@ -173,6 +189,36 @@ struct default_state_manager::implementation : public input_observer
 
   /* -- Methods -- */
 
+  /** Returns the number of top-level nodes, without changing the graph's revision. */
+  size_t node_count() const
+  {
+    return static_cast<const lineage::scene_graph&>(scene_graph).nodes().size();
+  }
+
+  /** Copies the current state to the snapshot buffer, and publishes it to the renderer. */
+  void publish_snapshot()
+  {
+    auto& snapshot = snapshots.write_buffer();
+
+    // if the renderer skipped the last snapshot, this slot still holds it, and the nodes it changed
+    // must be carried over into this one
+    if (!snapshot_skipped)
+      snapshot.changed_nodes.clear();
+
+    snapshot.graph_revision = scene_graph.revision();
+    snapshot.camera_position = camera_position;
+    snapshot.camera_rotation = camera_rotation;
+    snapshot.camera_fov = camera_fov;
+    snapshot.camera_clip_near = camera_clip_near;
+    snapshot.camera_clip_far = camera_clip_far;
+    snapshot.background_color = background_color;
+    snapshot.ambient_light_color = ambient_light_color;
+    snapshot.ambient_light_intensity = ambient_light_intensity;
+    capture_node_snapshots(scene_graph, &snapshot.nodes, &snapshot.changed_nodes, &snapshot_stack);
+    scene_graph.clear_changed_nodes();
+    snapshot_skipped = snapshots.publish();
+  }
+
   /** Updates the camera position. */
   void update_camera_position(const state_args& args)
   {
@@ -228,7 +274,7 @@ struct default_state_manager::implementation : public input_observer
   /** Updates the position of the selected object. */
   void update_object_position(const state_args& args)
   {
-    auto& node = scene_graph.nodes()[selected_node_index];
+    auto& node = scene_graph.node(selected_node_index.load());
     glm::vec3 position = update_position(node.position(), RATE_OBJECT_POSITION * args.delta_t, node.rotation());
     node.set_position(position);
   }
@@ -236,7 +282,7 @@ struct default_state_manager::implementation : public input_observer
   /** Updates the rotation of the selected object. */
   void update_object_rotation(const state_args& args)
   {
-    auto& node = scene_graph.nodes()[selected_node_index];
+    auto& node = scene_graph.node(selected_node_index.load());
     glm::quat rotation = update_rotation(node.rotation(), RATE_OBJECT_ROTATION * args.delta_t);
     node.set_rotation(rotation);
   }
@@ -360,7 +406,12 @@ struct default_state_manager::implementation : public input_observer
 /* -- Procedures -- */
 
 default_state_manager::default_state_manager(const input_manager& input_manager)
-  : impl(std::make_unique<implementation>(input_manager))
+  : default_state_manager(input_manager, create_multiple_cubes_scene_graph())
+{
+}
+
+default_state_manager::default_state_manager(const input_manager& input_manager, lineage::scene_graph&& scene_graph)
+  : impl(std::make_unique<implementation>(input_manager, std::move(scene_graph)))
 {
 }
 
@@ -371,6 +422,12 @@ const lineage::scene_graph& default_state_manager::scene_graph() const
   return impl->scene_graph;
 }
 
+const scene_snapshot& default_state_manager::latest_snapshot() const
+{
+  impl->snapshots.acquire();
+  return impl->snapshots.read_buffer();
+}
+
 glm::vec3 default_state_manager::camera_position() const
 {
   return impl->camera_position;
@@ -413,31 +470,40 @@ float default_state_manager::ambient_light_intensity() const
 
 void default_state_manager::run(const state_args& args)
 {
-  if (impl->mode == input_mode::camera)
+  const input_mode mode = impl->mode;
+  if (mode == input_mode::camera)
   {
     impl->update_camera_position(args);
     impl->update_camera_rotation(args);
     impl->update_camera_fov(args);
   }
-  else if (impl->mode == input_mode::background)
+  else if (mode == input_mode::background)
   {
     impl->update_background_color(args);
   }
-  else if (impl->mode == input_mode::object)
+  else if (mode == input_mode::object)
   {
-    if (impl->selected_node_index >= impl->scene_graph.nodes().size())
-      return;
-    impl->update_object_position(args);
-    impl->update_object_rotation(args);
+    if (impl->selected_node_index < impl->node_count())
+    {
+      impl->update_object_position(args);
+      impl->update_object_rotation(args);
+    }
   }
-  else if (impl->mode == input_mode::ambient_light)
+  else if (mode == input_mode::ambient_light)
   {
     impl->update_ambient_light_color(args);
     impl->update_ambient_light_intensity(args);
   }
+
+  impl->publish_snapshot();
 }
 
 double default_state_manager::target_delta_t() const
 {
   return (1.0 / 60.0); // 60 HZ
 }
+
+bool default_state_manager::supports_concurrent_run() const
+{
+  return true;
+}
@@ -12,6 +12,7 @@
 #include <glm/glm.hpp>
 
 #include "input_manager.hpp"
+#include "scene_snapshot.hpp"
 #include "state_manager.hpp"
 
 /* -- Types -- */
@@ -23,6 +24,11 @@ namespace lineage
 
   /**
    * Default application state manager object.
+   *
+   * @note
+   * `run()` may be called on its own thread. At the end of each run, the state is published as a
+   * `lineage::scene_snapshot`, which the renderer reads with `latest_snapshot()`. The other
+   * accessors read the live state, so they must only be used from the thread calling `run()`.
    */
   class default_state_manager final : public lineage::state_manager
   {
@@ -39,6 +45,18 @@ namespace lineage
      */
     default_state_manager(const lineage::input_manager& input_manager);
 
+    /**
+     * Constructs a new `lineage::default_state_manager` instance displaying the specified scene
+     * graph.
+     *
+     * @param input_manager
+     * The input manager in use by the application.
+     *
+     * @param scene_graph
+     * The scene graph to display.
+     */
+    default_state_manager(const lineage::input_manager& input_manager, lineage::scene_graph&& scene_graph);
+
     /**
      * Destructor.
      */
@@ -60,6 +78,15 @@ namespace lineage
      */
     const lineage::scene_graph& scene_graph() const;
 
+    /**
+     * Returns the most recently published snapshot of the state.
+     *
+     * @note
+     * This must only be called from the render thread. The returned snapshot remains valid (and
+     * unchanged) until the next call.
+     */
+    const lineage::scene_snapshot& latest_snapshot() const;
+
     /**
      * The current camera position.
      */
@@ -106,6 +133,7 @@ namespace lineage
 
     virtual void run(const lineage::state_args& args);
     virtual double target_delta_t() const;
+    virtual bool supports_concurrent_run() const;
 
     /* -- Implementation -- */
 
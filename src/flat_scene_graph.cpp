@@ -0,0 +1,339 @@
+/**
+ * @file	flat_scene_graph.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "debug.hpp"
+#include "bounds.hpp"
+#include "flat_scene_graph.hpp"
+#include "lod_chain.hpp"
+#include "mesh.hpp"
+#include "scene_graph.hpp"
+#include "scene_node.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Variables -- */
+
+const size_t flat_scene_graph::no_parent;
+
+/* -- Procedures -- */
+
+flat_scene_graph::flat_scene_graph()
+  : m_graph(nullptr),
+    m_snapshot(nullptr),
+    m_revision(0),
+    m_layout_revision(0),
+    m_nodes(),
+    m_parents(),
+    m_subtree_ends(),
+    m_world_matrices(),
+    m_transform_revisions(),
+    m_changed(),
+    m_changed_nodes(),
+    m_changed_roots(),
+    m_bounds(),
+    m_subtree_bounds(),
+    m_bounds_marks(),
+    m_bounds_ancestors(),
+    m_invalidated(true)
+{
+}
+
+void flat_scene_graph::update(const scene_graph& graph)
+{
+  m_snapshot = nullptr;
+  if (m_graph != &graph || m_revision != graph.revision())
+    rebuild(graph);
+  update_world_matrices();
+}
+
+void flat_scene_graph::update(const scene_graph& graph,
+                              const std::vector<node_snapshot>& nodes,
+                              const std::vector<size_t>& changed)
+{
+  m_snapshot = &nodes;
+  if (m_graph != &graph || m_revision != graph.revision())
+    rebuild(graph);
+  lineage_assert(nodes.size() == m_nodes.size());
+  update_world_matrices(changed);
+}
+
+void flat_scene_graph::rebuild(const scene_graph& graph)
+{
+  m_graph = &graph;
+  m_revision = graph.revision();
+  m_layout_revision++;
+  m_nodes.clear();
+  m_parents.clear();
+  m_subtree_ends.clear();
+
+  // walk the graph with an explicit stack, pushing children in reverse so that they are visited
+  // (and therefore stored) in their original order
+  std::vector<std::pair<const scene_node*, size_t>> stack;
+  const auto& roots = graph.nodes();
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+    stack.emplace_back(&(*it), no_parent);
+
+  while (!stack.empty())
+  {
+    auto entry = stack.back();
+    stack.pop_back();
+
+    const size_t index = m_nodes.size();
+    m_nodes.push_back(entry.first);
+    m_parents.push_back(entry.second);
+
+    const auto& children = entry.first->children();
+    for (auto it = children.rbegin(); it != children.rend(); ++it)
+      stack.emplace_back(&(*it), index);
+  }
+
+  // descendants always follow their parents, so walking backwards visits every node before its
+  // parent, and each subtree's end can be propagated upwards
+  m_subtree_ends.resize(m_nodes.size());
+  for (size_t index = m_nodes.size(); index-- > 0; )
+  {
+    m_subtree_ends[index] = std::max(m_subtree_ends[index], index + 1);
+    if (m_parents[index] != no_parent)
+      m_subtree_ends[m_parents[index]] = std::max(m_subtree_ends[m_parents[index]], m_subtree_ends[index]);
+  }
+
+  m_world_matrices.resize(m_nodes.size());
+  m_transform_revisions.resize(m_nodes.size());
+  m_changed.resize(m_nodes.size());
+  m_bounds.resize(m_nodes.size());
+  m_subtree_bounds.resize(m_nodes.size());
+  m_bounds_marks.assign(m_nodes.size(), false);
+  invalidate();
+}
+
+size_t flat_scene_graph::update_world_matrices()
+{
+  lineage_assert(m_graph != nullptr || m_nodes.empty());
+  const size_t count = m_nodes.size();
+  m_changed_nodes.clear();
+
+  for (size_t index = 0; index < count; index++)
+  {
+    const size_t parent = m_parents[index];
+    lineage_assert(parent == no_parent || parent < index);
+
+    // a node is dirty if its own transform changed, or if its parent was recomputed in this pass -
+    // since parents always precede their children, this propagates through the whole subtree
+    const bool changed =
+      m_invalidated ||
+      m_transform_revisions[index] != transform_revision(index) ||
+      (parent != no_parent && m_changed[parent]);
+
+    m_changed[index] = changed;
+    if (changed)
+      update_node(index);
+  }
+
+  if (!m_changed_nodes.empty())
+    update_subtree_bounds();
+
+  m_invalidated = false;
+  return m_changed_nodes.size();
+}
+
+size_t flat_scene_graph::update_world_matrices(const std::vector<size_t>& changed)
+{
+  if (m_invalidated)
+    return update_world_matrices();
+
+  // only the nodes recomputed in the previous pass have their flags set
+  for (const auto& index : m_changed_nodes)
+    m_changed[index] = false;
+  m_changed_nodes.clear();
+
+  // visiting the subtrees in order keeps the changed nodes sorted, and lets any subtree nested in
+  // (or repeating) an earlier one be skipped
+  m_changed_roots.assign(changed.begin(), changed.end());
+  std::sort(m_changed_roots.begin(), m_changed_roots.end());
+
+  size_t end = 0;
+  for (const auto& root : m_changed_roots)
+  {
+    lineage_assert(root < m_nodes.size());
+    if (root < end)
+      continue;
+
+    end = m_subtree_ends[root];
+    for (size_t index = root; index < end; index++)
+    {
+      m_changed[index] = true;
+      update_node(index);
+    }
+  }
+
+  if (!m_changed_nodes.empty())
+    update_subtree_bounds();
+
+  return m_changed_nodes.size();
+}
+
+uint64_t flat_scene_graph::transform_revision(size_t index) const
+{
+  // transforms come from the snapshot if there is one, since the live node may be changing on
+  // another thread
+  return (m_snapshot ?
+          (*m_snapshot)[index].transform_revision :
+          m_nodes[index]->transform_revision());
+}
+
+void flat_scene_graph::update_node(size_t index)
+{
+  const auto& node = *m_nodes[index];
+  const size_t parent = m_parents[index];
+
+  const glm::mat4& local_matrix = m_snapshot ? (*m_snapshot)[index].local_matrix : node.local_matrix();
+  if (parent == no_parent)
+    m_world_matrices[index] = local_matrix;
+  else
+    m_world_matrices[index] = m_world_matrices[parent] * local_matrix;
+
+  m_transform_revisions[index] = transform_revision(index);
+  m_changed_nodes.push_back(index);
+
+  const auto& meshes = m_graph->meshes();
+  auto& box = m_bounds[index];
+  box = empty_bounding_box();
+  for (const auto& mesh_index : node.meshes())
+    expand(box, transform(meshes[mesh_index]->bounds(), m_world_matrices[index]));
+
+  // any level of the node's LOD chain may be drawn, so the bounds must cover all of them
+  if (node.lod_chain() != scene_node::no_lod_chain)
+  {
+    for (const auto& level : m_graph->lod_chains()[node.lod_chain()].levels)
+      expand(box, transform(meshes[level.mesh_index]->bounds(), m_world_matrices[index]));
+  }
+}
+
+void flat_scene_graph::update_subtree_bounds()
+{
+  const size_t count = m_nodes.size();
+  if (m_changed_nodes.size() == count)
+  {
+    for (size_t index = 0; index < count; index++)
+      m_subtree_bounds[index] = m_bounds[index];
+
+    // every descendant is visited before its parent, so each subtree is complete when it is reached
+    for (size_t index = count; index-- > 0; )
+    {
+      if (m_parents[index] != no_parent)
+        expand(m_subtree_bounds[m_parents[index]], m_subtree_bounds[index]);
+    }
+    return;
+  }
+
+  // every descendant of a changed node has also changed, so the changed nodes can be recomputed
+  // from their children in descending order, before any of their unchanged ancestors
+  for (auto it = m_changed_nodes.rbegin(); it != m_changed_nodes.rend(); ++it)
+    update_subtree_bounds(*it);
+
+  // collect the unchanged ancestors of the changed subtrees - each walk stops at the first node
+  // which an earlier walk has already collected
+  m_bounds_ancestors.clear();
+  for (const auto& index : m_changed_nodes)
+  {
+    for (size_t ancestor = m_parents[index];
+         ancestor != no_parent && !m_changed[ancestor] && !m_bounds_marks[ancestor];
+         ancestor = m_parents[ancestor])
+    {
+      m_bounds_marks[ancestor] = true;
+      m_bounds_ancestors.push_back(ancestor);
+    }
+  }
+
+  // children are always stored after their parents, so descending order re-expands bottom-up
+  std::sort(m_bounds_ancestors.begin(), m_bounds_ancestors.end(), std::greater<size_t>());
+  for (const auto& index : m_bounds_ancestors)
+  {
+    update_subtree_bounds(index);
+    m_bounds_marks[index] = false;
+  }
+}
+
+void flat_scene_graph::update_subtree_bounds(size_t index)
+{
+  // the children of a node are found by skipping over each child's subtree
+  auto& box = m_subtree_bounds[index];
+  box = m_bounds[index];
+  for (size_t child = index + 1; child < m_subtree_ends[index]; child = m_subtree_ends[child])
+    expand(box, m_subtree_bounds[child]);
+}
+
+void flat_scene_graph::invalidate()
+{
+  m_invalidated = true;
+}
+
+uint64_t flat_scene_graph::layout_revision() const
+{
+  return m_layout_revision;
+}
+
+size_t flat_scene_graph::size() const
+{
+  return m_nodes.size();
+}
+
+const scene_node& flat_scene_graph::node(size_t index) const
+{
+  return *m_nodes[index];
+}
+
+size_t flat_scene_graph::parent(size_t index) const
+{
+  return m_parents[index];
+}
+
+size_t flat_scene_graph::subtree_end(size_t index) const
+{
+  return m_subtree_ends[index];
+}
+
+const glm::mat4& flat_scene_graph::world_matrix(size_t index) const
+{
+  return m_world_matrices[index];
+}
+
+glm::vec4 flat_scene_graph::color(size_t index) const
+{
+  return (m_snapshot ? (*m_snapshot)[index].color : m_nodes[index]->color());
+}
+
+bool flat_scene_graph::is_changed(size_t index) const
+{
+  return static_cast<bool>(m_changed[index]);
+}
+
+const std::vector<size_t>& flat_scene_graph::changed_nodes() const
+{
+  return m_changed_nodes;
+}
+
+const bounding_box& flat_scene_graph::bounds(size_t index) const
+{
+  return m_bounds[index];
+}
+
+const bounding_box& flat_scene_graph::subtree_bounds(size_t index) const
+{
+  return m_subtree_bounds[index];
+}
+
@@ -0,0 +1,209 @@
+/**
+ * @file	flat_scene_graph.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/23
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+#include "scene_snapshot.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class scene_graph;
+  class scene_node;
+
+  /**
+   * Class representing a flattened view of a `lineage::scene_graph`.
+   *
+   * @note
+   * Nodes are stored in depth-first pre-order, so every node is stored after its parent. This
+   * allows world matrices to be computed in a single linear pass, without recursion. World matrices
+   * are cached between passes, and are only recomputed for nodes whose transform (or whose
+   * ancestor's transform) has changed.
+   *
+   * Each node's descendants are stored contiguously after it, so an entire subtree can be skipped
+   * by jumping to `subtree_end()`. World-space bounds are kept for each node's own meshes and for
+   * its whole subtree.
+   */
+  class flat_scene_graph
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * Parent index used for top-level nodes.
+     */
+    static const size_t no_parent = std::numeric_limits<size_t>::max();
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new, empty `lineage::flat_scene_graph` instance.
+     */
+    flat_scene_graph();
+
+  private:
+
+    flat_scene_graph(const lineage::flat_scene_graph&) = delete;
+    flat_scene_graph(lineage::flat_scene_graph&&) = delete;
+    lineage::flat_scene_graph& operator =(const lineage::flat_scene_graph&) = delete;
+    lineage::flat_scene_graph& operator =(lineage::flat_scene_graph&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Rebuilds the flattened view if the structure of `graph` has changed, and then updates the
+     * world matrices of all changed nodes.
+     */
+    void update(const lineage::scene_graph& graph);
+
+    /**
+     * Rebuilds the flattened view if the structure of `graph` has changed, and then updates the
+     * world matrices of the nodes in `changed` and their descendants, using the transforms and
+     * colors captured in `nodes` instead of reading them from the live graph.
+     *
+     * @note
+     * `nodes` and `changed` must be as produced by `lineage::capture_node_snapshots()`, and `nodes`
+     * must outlive any use of `color()` until the next update.
+     */
+    void update(const lineage::scene_graph& graph,
+                const std::vector<lineage::node_snapshot>& nodes,
+                const std::vector<size_t>& changed);
+
+    /**
+     * Unconditionally rebuilds the flattened view from the specified scene graph.
+     */
+    void rebuild(const lineage::scene_graph& graph);
+
+    /**
+     * Recomputes the world matrix and bounds of every node whose transform (or whose ancestor's
+     * transform) has changed since the last pass.
+     *
+     * @return
+     * The number of world matrices which were recomputed.
+     */
+    size_t update_world_matrices();
+
+    /**
+     * Recomputes the world matrix and bounds of each node in `changed`, and of all of their
+     * descendants. Only these subtrees are visited, unless the graph has been invalidated, in which
+     * case every node is recomputed.
+     *
+     * @return
+     * The number of world matrices which were recomputed.
+     */
+    size_t update_world_matrices(const std::vector<size_t>& changed);
+
+    /**
+     * Forces the world matrix of every node to be recomputed in the next pass.
+     */
+    void invalidate();
+
+    /**
+     * Counter which is incremented every time the flattened view is rebuilt. Node indices are only
+     * stable while this value is unchanged.
+     */
+    uint64_t layout_revision() const;
+
+    /**
+     * The number of nodes in the flattened graph.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the scene node at the specified index.
+     */
+    const lineage::scene_node& node(size_t index) const;
+
+    /**
+     * Returns the index of the parent of the node at the specified index, or
+     * `flat_scene_graph::no_parent` if the node is a top-level node.
+     */
+    size_t parent(size_t index) const;
+
+    /**
+     * Returns the index one past the last descendant of the node at the specified index.
+     */
+    size_t subtree_end(size_t index) const;
+
+    /**
+     * Returns the world matrix of the node at the specified index.
+     */
+    const glm::mat4& world_matrix(size_t index) const;
+
+    /**
+     * Returns the color of the node at the specified index, as of the most recent update.
+     */
+    glm::vec4 color(size_t index) const;
+
+    /**
+     * Returns `true` if the world matrix of the node at the specified index was recomputed in the
+     * most recent pass.
+     */
+    bool is_changed(size_t index) const;
+
+    /**
+     * Returns the indices of every node whose world matrix was recomputed in the most recent pass,
+     * in ascending order.
+     */
+    const std::vector<size_t>& changed_nodes() const;
+
+    /**
+     * Returns the world-space bounds of the meshes of the node at the specified index.
+     */
+    const lineage::bounding_box& bounds(size_t index) const;
+
+    /**
+     * Returns the world-space bounds of the node at the specified index and all of its descendants.
+     */
+    const lineage::bounding_box& subtree_bounds(size_t index) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    uint64_t transform_revision(size_t index) const;
+    void update_node(size_t index);
+    void update_subtree_bounds();
+    void update_subtree_bounds(size_t index);
+
+    const lineage::scene_graph* m_graph;
+    const std::vector<lineage::node_snapshot>* m_snapshot;
+    uint64_t m_revision;
+    uint64_t m_layout_revision;
+    std::vector<const lineage::scene_node*> m_nodes;
+    std::vector<size_t> m_parents;
+    std::vector<size_t> m_subtree_ends;
+    std::vector<glm::mat4> m_world_matrices;
+    std::vector<uint64_t> m_transform_revisions;
+    std::vector<uint8_t> m_changed;
+    std::vector<size_t> m_changed_nodes;
+    std::vector<size_t> m_changed_roots;
+    std::vector<lineage::bounding_box> m_bounds;
+    std::vector<lineage::bounding_box> m_subtree_bounds;
+    std::vector<uint8_t> m_bounds_marks;
+    std::vector<size_t> m_bounds_ancestors;
+    bool m_invalidated;
+
+  };
+
+}
@@ -0,0 +1,87 @@
+/**
+ * @file	frame_arena.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "debug.hpp"
+#include "frame_arena.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Variables -- */
+
+const size_t frame_arena::default_capacity;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Rounds `value` up to the next multiple of `alignment`. */
+  size_t align(size_t value, size_t alignment)
+  {
+    return ((value + alignment - 1) / alignment) * alignment;
+  }
+
+}
+
+/* -- Procedures -- */
+
+frame_arena::frame_arena(size_t capacity)
+  : m_capacity(capacity),
+    m_block(new unsigned char[capacity]),
+    m_offset(0),
+    m_overflow(),
+    m_overflow_size(0)
+{
+}
+
+void frame_arena::reset()
+{
+  if (!m_overflow.empty())
+  {
+    // grow to hold everything the last frame needed, so the next one fits in a single block
+    m_capacity = align(m_offset + m_overflow_size, alignof(std::max_align_t)) * 2;
+    m_block.reset(new unsigned char[m_capacity]);
+    m_overflow.clear();
+    m_overflow_size = 0;
+  }
+  m_offset = 0;
+}
+
+void* frame_arena::allocate(size_t size, size_t alignment)
+{
+  lineage_assert(alignment != 0 && alignment <= alignof(std::max_align_t));
+
+  // the block itself is aligned for any type, so aligning the offset aligns the address
+  const size_t start = align(m_offset, alignment);
+  if (start + size <= m_capacity)
+  {
+    m_offset = start + size;
+    return m_block.get() + start;
+  }
+
+  m_overflow.emplace_back(new unsigned char[size]);
+  m_overflow_size += align(size, alignof(std::max_align_t));
+  return m_overflow.back().get();
+}
+
+size_t frame_arena::used() const
+{
+  return m_offset + m_overflow_size;
+}
+
+size_t frame_arena::capacity() const
+{
+  return m_capacity;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file	frame_arena.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Class representing a linear allocator for transient data which only lives for a single frame.
+   *
+   * @note
+   * Allocations bump a pointer through a single block, and are all released at once by `reset()`.
+   * Destructors are never run, so only trivially destructible types may be allocated. If a frame
+   * needs more space than the block holds, the excess is served from overflow blocks, and the main
+   * block is grown at the next reset - so the arena stops allocating once it has seen the largest
+   * frame.
+   */
+  class frame_arena
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * The default capacity of the arena, in bytes.
+     */
+    static const size_t default_capacity = 1 << 16;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::frame_arena` instance with the specified capacity, in bytes.
+     */
+    frame_arena(size_t capacity = default_capacity);
+
+  private:
+
+    frame_arena(const lineage::frame_arena&) = delete;
+    frame_arena(lineage::frame_arena&&) = delete;
+    lineage::frame_arena& operator =(const lineage::frame_arena&) = delete;
+    lineage::frame_arena& operator =(lineage::frame_arena&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Releases every allocation, growing the arena first if the previous frame overflowed it.
+     */
+    void reset();
+
+    /**
+     * Allocates uninitialized space with the specified size and alignment.
+     */
+    void* allocate(size_t size, size_t alignment);
+
+    /**
+     * Allocates uninitialized space for `count` objects of type `T`.
+     */
+    template <typename T>
+    T* allocate(size_t count)
+    {
+      static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed!");
+      return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * The number of bytes allocated since the last reset, including any overflow.
+     */
+    size_t used() const;
+
+    /**
+     * The capacity of the main block, in bytes.
+     */
+    size_t capacity() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    size_t m_capacity;
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_offset;
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;
+    size_t m_overflow_size;
+
+  };
+
+}
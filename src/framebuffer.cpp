@@ -0,0 +1,146 @@
+/**
+ * @file	framebuffer.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "api.hpp"
+#include "framebuffer.hpp"
+#include "opengl.hpp"
+#include "opengl_error.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const GLuint INVALID_HANDLE = std::numeric_limits<GLuint>::max();
+  const GLenum COLOR_FORMAT = GL_RGBA8;
+  const GLenum DEPTH_FORMAT = GL_DEPTH24_STENCIL8;
+  const size_t BYTES_PER_PIXEL = 4;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Limits a sample count to the largest supported by the driver. */
+  int supported_samples(int samples)
+  {
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    return std::min(samples, static_cast<int>(max_samples));
+  }
+
+  /** Create a new renderbuffer handle with storage in the specified format. */
+  GLuint create_renderbuffer(GLenum format, int width, int height, int samples)
+  {
+    GLuint handle = INVALID_HANDLE;
+    glCreateRenderbuffers(1, &handle);
+    if (handle == INVALID_HANDLE)
+      return handle;
+
+    glNamedRenderbufferStorageMultisample(handle, samples, format, width, height);
+    return handle;
+  }
+
+  /** Create a new framebuffer handle with the specified renderbuffers attached. */
+  GLuint create_framebuffer(GLuint color_buffer, GLuint depth_buffer)
+  {
+    GLuint handle = INVALID_HANDLE;
+    glCreateFramebuffers(1, &handle);
+    if (handle == INVALID_HANDLE)
+      return handle;
+
+    glNamedFramebufferRenderbuffer(handle, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+    glNamedFramebufferRenderbuffer(handle, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+    return handle;
+  }
+
+}
+
+/* -- Procedures -- */
+
+framebuffer::framebuffer(int width, int height, int samples)
+  : m_width(width),
+    m_height(height),
+    m_samples(supported_samples(samples)),
+    m_color_buffer(create_renderbuffer(COLOR_FORMAT, width, height, m_samples)),
+    m_depth_buffer(create_renderbuffer(DEPTH_FORMAT, width, height, m_samples)),
+    m_handle(create_framebuffer(m_color_buffer, m_depth_buffer))
+{
+  if (m_color_buffer == INVALID_HANDLE ||
+      m_depth_buffer == INVALID_HANDLE ||
+      m_handle == INVALID_HANDLE)
+  {
+    opengl_error::throw_last_error();
+  }
+
+  if (glCheckNamedFramebufferStatus(m_handle, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    throw std::runtime_error("Framebuffer is incomplete!");
+}
+
+framebuffer::~framebuffer()
+{
+  if (m_handle != INVALID_HANDLE)
+  {
+    opengl::forget_framebuffer(m_handle);
+    glDeleteFramebuffers(1, &m_handle);
+  }
+  if (m_depth_buffer != INVALID_HANDLE)
+    glDeleteRenderbuffers(1, &m_depth_buffer);
+  if (m_color_buffer != INVALID_HANDLE)
+    glDeleteRenderbuffers(1, &m_color_buffer);
+}
+
+int framebuffer::width() const
+{
+  return m_width;
+}
+
+int framebuffer::height() const
+{
+  return m_height;
+}
+
+int framebuffer::samples() const
+{
+  return m_samples;
+}
+
+void framebuffer::read_pixels(std::vector<uint8_t>* pixels) const
+{
+  pixels->resize(static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * BYTES_PER_PIXEL);
+
+  // multisampled renderbuffers can't be read directly, so resolve them first
+  if (m_samples != 0)
+  {
+    framebuffer resolved(m_width, m_height, 0);
+    glBlitNamedFramebuffer(m_handle, resolved.m_handle,
+                           0, 0, m_width, m_height,
+                           0, 0, m_width, m_height,
+                           GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    resolved.read_pixels(pixels);
+    return;
+  }
+
+  // read through a temporary binding, restoring the previous one afterwards
+  GLint previous = 0;
+  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_handle);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previous));
+}
@@ -0,0 +1,110 @@
+/**
+ * @file	framebuffer.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <vector>
+
+#include "api.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class opengl;
+
+  /**
+   * Class representing an offscreen OpenGL framebuffer object, with a color and a depth/stencil
+   * renderbuffer attached.
+   */
+  class framebuffer
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::framebuffer` instance.
+     *
+     * @param width
+     * The width of the framebuffer, in pixels.
+     *
+     * @param height
+     * The height of the framebuffer, in pixels.
+     *
+     * @param samples
+     * The number of samples per pixel to use for multisampling, or zero to disable multisampling.
+     * This is limited to the largest sample count supported by the driver.
+     *
+     * @exception lineage::opengl_error
+     * Thrown if the framebuffer or its renderbuffers cannot be created for any reason.
+     *
+     * @exception std::runtime_error
+     * Thrown if the framebuffer is incomplete with the requested configuration.
+     */
+    framebuffer(int width, int height, int samples);
+
+    /**
+     * Destructor.
+     */
+    ~framebuffer();
+
+  private:
+
+    framebuffer(const lineage::framebuffer&) = delete;
+    framebuffer(lineage::framebuffer&&) = delete;
+    lineage::framebuffer& operator =(const lineage::framebuffer&) = delete;
+    lineage::framebuffer& operator =(lineage::framebuffer&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * The width of the framebuffer, in pixels.
+     */
+    int width() const;
+
+    /**
+     * The height of the framebuffer, in pixels.
+     */
+    int height() const;
+
+    /**
+     * The number of samples per pixel, or zero if the framebuffer is not multisampled.
+     */
+    int samples() const;
+
+    /**
+     * Reads the color buffer back as tightly packed RGBA pixels, starting from the bottom row.
+     *
+     * @note
+     * This waits for all rendering to the framebuffer to complete. Multisampled framebuffers are
+     * resolved into a temporary single-sampled framebuffer first.
+     */
+    void read_pixels(std::vector<uint8_t>* pixels) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    friend class opengl;
+
+    const int m_width;
+    const int m_height;
+    const int m_samples;
+    const GLuint m_color_buffer;
+    const GLuint m_depth_buffer;
+    const GLuint m_handle;
+
+  };
+
+}
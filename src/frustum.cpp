@@ -0,0 +1,240 @@
+/**
+ * @file	frustum.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+/* -- Includes -- */
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+#include "debug.hpp"
+#include "frustum.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Variables -- */
+
+const size_t frustum::plane_count;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Converts masks of boxes outside and intersecting the frustum to a result. */
+  containment containment_from_masks(int outside, int intersecting, int lane)
+  {
+    if (outside & (1 << lane))
+      return containment::outside;
+    if (intersecting & (1 << lane))
+      return containment::intersecting;
+    return containment::inside;
+  }
+
+}
+
+/* -- Procedures -- */
+
+frustum::frustum(const glm::mat4& view_proj_matrix)
+{
+  // extract the planes from the rows of the matrix (Gribb & Hartmann) - glm matrices are column
+  // major, so the row r is (m[0][r], m[1][r], m[2][r], m[3][r])
+  auto row = [&] (int r) {
+    return glm::vec4(view_proj_matrix[0][r],
+                     view_proj_matrix[1][r],
+                     view_proj_matrix[2][r],
+                     view_proj_matrix[3][r]);
+  };
+  const glm::vec4 planes[plane_count] =
+  {
+    row(3) + row(0),	// left
+    row(3) - row(0),	// right
+    row(3) + row(1),	// bottom
+    row(3) - row(1),	// top
+    row(3) + row(2),	// near
+    row(3) - row(2),	// far
+  };
+
+  for (size_t index = 0; index < plane_count; index++)
+  {
+    // normalize, so that plane distances are in world units
+    const glm::vec4& plane = planes[index];
+    const float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    lineage_assert(length > 0.0f);
+
+    m_normal_x[index] = plane.x / length;
+    m_normal_y[index] = plane.y / length;
+    m_normal_z[index] = plane.z / length;
+    m_abs_normal_x[index] = std::abs(m_normal_x[index]);
+    m_abs_normal_y[index] = std::abs(m_normal_y[index]);
+    m_abs_normal_z[index] = std::abs(m_normal_z[index]);
+    m_distance[index] = plane.w / length;
+  }
+}
+
+containment frustum::classify(const bounding_box& box) const
+{
+  if (is_empty(box))
+    return containment::outside;
+
+  const glm::vec3 box_center = center(box);
+  const glm::vec3 box_extent = extent(box);
+  return classify(box_center.x, box_center.y, box_center.z,
+                  box_extent.x, box_extent.y, box_extent.z);
+}
+
+containment frustum::classify(const bounding_sphere& sphere) const
+{
+  containment result = containment::inside;
+  for (size_t index = 0; index < plane_count; index++)
+  {
+    const float distance =
+      m_normal_x[index] * sphere.center.x +
+      m_normal_y[index] * sphere.center.y +
+      m_normal_z[index] * sphere.center.z +
+      m_distance[index];
+
+    if (distance < -sphere.radius)
+      return containment::outside;
+    if (distance < sphere.radius)
+      result = containment::intersecting;
+  }
+  return result;
+}
+
+void frustum::classify(const bounding_box_array& boxes,
+                       size_t first,
+                       size_t count,
+                       containment* results) const
+{
+  lineage_assert(first + count <= boxes.size());
+
+  const float* center_x = boxes.center_x.data() + first;
+  const float* center_y = boxes.center_y.data() + first;
+  const float* center_z = boxes.center_z.data() + first;
+  const float* extent_x = boxes.extent_x.data() + first;
+  const float* extent_y = boxes.extent_y.data() + first;
+  const float* extent_z = boxes.extent_z.data() + first;
+  size_t index = 0;
+
+  // for each plane, a box is outside if its center is further behind the plane than its projected
+  // radius, and is intersecting if its center is closer to the plane than its projected radius
+
+#if defined(__AVX__)
+
+  for (; index + 8 <= count; index += 8)
+  {
+    const __m256 cx = _mm256_loadu_ps(center_x + index);
+    const __m256 cy = _mm256_loadu_ps(center_y + index);
+    const __m256 cz = _mm256_loadu_ps(center_z + index);
+    const __m256 ex = _mm256_loadu_ps(extent_x + index);
+    const __m256 ey = _mm256_loadu_ps(extent_y + index);
+    const __m256 ez = _mm256_loadu_ps(extent_z + index);
+    __m256 outside = _mm256_setzero_ps();
+    __m256 intersecting = _mm256_setzero_ps();
+
+    for (size_t plane = 0; plane < plane_count; plane++)
+    {
+      const __m256 distance =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(m_normal_x[plane])),
+                                    _mm256_mul_ps(cy, _mm256_set1_ps(m_normal_y[plane]))),
+                      _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(m_normal_z[plane])),
+                                    _mm256_set1_ps(m_distance[plane])));
+      const __m256 radius =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(m_abs_normal_x[plane])),
+                                    _mm256_mul_ps(ey, _mm256_set1_ps(m_abs_normal_y[plane]))),
+                      _mm256_mul_ps(ez, _mm256_set1_ps(m_abs_normal_z[plane])));
+      const __m256 neg_radius = _mm256_sub_ps(_mm256_setzero_ps(), radius);
+
+      outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, neg_radius, _CMP_LT_OQ));
+      intersecting = _mm256_or_ps(intersecting, _mm256_cmp_ps(distance, radius, _CMP_LT_OQ));
+    }
+
+    const int outside_mask = _mm256_movemask_ps(outside);
+    const int intersecting_mask = _mm256_movemask_ps(intersecting);
+    for (int lane = 0; lane < 8; lane++)
+      results[index + lane] = containment_from_masks(outside_mask, intersecting_mask, lane);
+  }
+
+#elif defined(__SSE2__)
+
+  for (; index + 4 <= count; index += 4)
+  {
+    const __m128 cx = _mm_loadu_ps(center_x + index);
+    const __m128 cy = _mm_loadu_ps(center_y + index);
+    const __m128 cz = _mm_loadu_ps(center_z + index);
+    const __m128 ex = _mm_loadu_ps(extent_x + index);
+    const __m128 ey = _mm_loadu_ps(extent_y + index);
+    const __m128 ez = _mm_loadu_ps(extent_z + index);
+    __m128 outside = _mm_setzero_ps();
+    __m128 intersecting = _mm_setzero_ps();
+
+    for (size_t plane = 0; plane < plane_count; plane++)
+    {
+      const __m128 distance =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(m_normal_x[plane])),
+                              _mm_mul_ps(cy, _mm_set1_ps(m_normal_y[plane]))),
+                   _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(m_normal_z[plane])),
+                              _mm_set1_ps(m_distance[plane])));
+      const __m128 radius =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(m_abs_normal_x[plane])),
+                              _mm_mul_ps(ey, _mm_set1_ps(m_abs_normal_y[plane]))),
+                   _mm_mul_ps(ez, _mm_set1_ps(m_abs_normal_z[plane])));
+      const __m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, neg_radius));
+      intersecting = _mm_or_ps(intersecting, _mm_cmplt_ps(distance, radius));
+    }
+
+    const int outside_mask = _mm_movemask_ps(outside);
+    const int intersecting_mask = _mm_movemask_ps(intersecting);
+    for (int lane = 0; lane < 4; lane++)
+      results[index + lane] = containment_from_masks(outside_mask, intersecting_mask, lane);
+  }
+
+#endif
+
+  // scalar path for any remaining boxes
+  for (; index < count; index++)
+  {
+    results[index] = classify(center_x[index], center_y[index], center_z[index],
+                              extent_x[index], extent_y[index], extent_z[index]);
+  }
+}
+
+containment frustum::classify(float center_x, float center_y, float center_z,
+                              float extent_x, float extent_y, float extent_z) const
+{
+  containment result = containment::inside;
+  for (size_t index = 0; index < plane_count; index++)
+  {
+    const float distance =
+      m_normal_x[index] * center_x +
+      m_normal_y[index] * center_y +
+      m_normal_z[index] * center_z +
+      m_distance[index];
+    const float radius =
+      m_abs_normal_x[index] * extent_x +
+      m_abs_normal_y[index] * extent_y +
+      m_abs_normal_z[index] * extent_z;
+
+    if (distance < -radius)
+      return containment::outside;
+    if (distance < radius)
+      result = containment::intersecting;
+  }
+  return result;
+}
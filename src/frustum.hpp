@@ -0,0 +1,109 @@
+/**
+ * @file	frustum.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Enumeration of results of testing a bounding volume against a frustum.
+   */
+  enum class containment : uint8_t
+  {
+    outside,		/**< The volume is entirely outside the frustum. */
+    intersecting,	/**< The volume is partially inside the frustum. */
+    inside,		/**< The volume is entirely inside the frustum. */
+  };
+
+  /**
+   * Class representing a view frustum, as six inward-facing planes.
+   */
+  class frustum
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The number of planes bounding the frustum. */
+    static const size_t plane_count = 6;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a frustum from the specified combined projection and view matrix.
+     */
+    explicit frustum(const glm::mat4& view_proj_matrix);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Tests the specified bounding box against the frustum.
+     */
+    lineage::containment classify(const lineage::bounding_box& box) const;
+
+    /**
+     * Tests the specified bounding sphere against the frustum.
+     */
+    lineage::containment classify(const lineage::bounding_sphere& sphere) const;
+
+    /**
+     * Tests a range of boxes against the frustum.
+     *
+     * @param boxes
+     * The array of boxes to test.
+     *
+     * @param first
+     * The index of the first box to test.
+     *
+     * @param count
+     * The number of boxes to test.
+     *
+     * @param results
+     * Output array of `count` results.
+     *
+     * @note
+     * Where the CPU supports it, 4 (SSE) or 8 (AVX) boxes are tested at once.
+     */
+    void classify(const lineage::bounding_box_array& boxes,
+                  size_t first,
+                  size_t count,
+                  lineage::containment* results) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    lineage::containment classify(float center_x, float center_y, float center_z,
+                                  float extent_x, float extent_y, float extent_z) const;
+
+    float m_normal_x[plane_count];
+    float m_normal_y[plane_count];
+    float m_normal_z[plane_count];
+    float m_abs_normal_x[plane_count];
+    float m_abs_normal_y[plane_count];
+    float m_abs_normal_z[plane_count];
+    float m_distance[plane_count];
+
+  };
+
+}
@@ -0,0 +1,238 @@
+/**
+ * @file	geometry_pool.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/24
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "api.hpp"
+#include "buffer.hpp"
+#include "vertex.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+  namespace templates
+  {
+
+    /**
+     * Class which suballocates vertex and index data for many meshes out of a small number of
+     * large shared buffers.
+     *
+     * @note
+     * Storage is allocated from pages, each of which holds one vertex buffer and one index buffer.
+     * Meshes drawn from the same page can be drawn without rebinding any buffers. Allocations are
+     * never freed individually - all storage is released when the pool is destroyed.
+     */
+    template <typename TVertex, typename TIndex>
+    class basic_geometry_pool
+    {
+
+      /* -- Types -- */
+
+    public:
+
+      /** The type of vertex stored in this pool. */
+      using vertex_type = TVertex;
+
+      /** The type of index stored in this pool. */
+      using index_type = TIndex;
+
+      /**
+       * A page of storage in the pool.
+       */
+      struct page
+      {
+        lineage::immutable_buffer vertex_buffer;	/**< The shared vertex buffer. */
+        lineage::immutable_buffer index_buffer;	/**< The shared index buffer. */
+        size_t vertex_capacity;			/**< Capacity of the vertex buffer, in vertices. */
+        size_t vertex_count;				/**< Number of vertices allocated. */
+        size_t index_capacity;			/**< Capacity of the index buffer, in indices. */
+        size_t index_count;				/**< Number of indices allocated. */
+        size_t index;				/**< The index of this page in the pool. */
+
+        page(size_t vertex_capacity, size_t index_capacity, size_t index)
+          : vertex_buffer(vertex_capacity * sizeof(TVertex), nullptr, GL_DYNAMIC_STORAGE_BIT),
+            index_buffer(index_capacity * sizeof(TIndex), nullptr, GL_DYNAMIC_STORAGE_BIT),
+            vertex_capacity(vertex_capacity),
+            vertex_count(0),
+            index_capacity(index_capacity),
+            index_count(0),
+            index(index)
+        { }
+
+        page(const TVertex* vertices, size_t vertex_count, const TIndex* indices, size_t index_count, size_t index)
+          : vertex_buffer(vertex_count * sizeof(TVertex), vertices, GL_DYNAMIC_STORAGE_BIT),
+            index_buffer(index_count * sizeof(TIndex), indices, GL_DYNAMIC_STORAGE_BIT),
+            vertex_capacity(vertex_count),
+            vertex_count(vertex_count),
+            index_capacity(index_count),
+            index_count(index_count),
+            index(index)
+        { }
+      };
+
+      /**
+       * A range of vertices and indices allocated from the pool.
+       */
+      struct range
+      {
+        const page* source;		/**< The page containing the data. */
+        size_t base_vertex;		/**< Index of the first vertex in the page's vertex buffer. */
+        size_t first_index;		/**< Index of the first index in the page's index buffer. */
+      };
+
+      /* -- Constants -- */
+
+    public:
+
+      /** Default number of vertices in each page. */
+      static const size_t default_page_vertex_capacity = 65536;
+
+      /** Default number of indices in each page. */
+      static const size_t default_page_index_capacity = 196608;
+
+      /* -- Lifecycle -- */
+
+    public:
+
+      /**
+       * Constructs a new, empty geometry pool.
+       *
+       * @param page_vertex_capacity
+       * The number of vertices to allocate for each page.
+       *
+       * @param page_index_capacity
+       * The number of indices to allocate for each page.
+       */
+      basic_geometry_pool(size_t page_vertex_capacity = default_page_vertex_capacity,
+                          size_t page_index_capacity = default_page_index_capacity)
+        : m_page_vertex_capacity(page_vertex_capacity),
+          m_page_index_capacity(page_index_capacity),
+          m_pages()
+      { }
+
+      /**
+       * Destructor.
+       */
+      ~basic_geometry_pool() = default;
+
+    private:
+
+      basic_geometry_pool(const lineage::templates::basic_geometry_pool<TVertex, TIndex>&) = delete;
+      basic_geometry_pool(lineage::templates::basic_geometry_pool<TVertex, TIndex>&&) = delete;
+      lineage::templates::basic_geometry_pool<TVertex, TIndex>& operator =(const lineage::templates::basic_geometry_pool<TVertex, TIndex>&) = delete;
+      lineage::templates::basic_geometry_pool<TVertex, TIndex>& operator =(lineage::templates::basic_geometry_pool<TVertex, TIndex>&&) = delete;
+
+      /* -- Public Methods -- */
+
+    public:
+
+      /**
+       * Copies the specified vertices and indices into the pool.
+       *
+       * @note
+       * Indices are stored as-is, relative to the first vertex. They should be drawn with the
+       * returned `base_vertex`.
+       */
+      range allocate(const TVertex* vertices,
+                     size_t vertex_count,
+                     const TIndex* indices,
+                     size_t index_count)
+      {
+        page& target = find_page(vertex_count, index_count);
+
+        range result;
+        result.source = &target;
+        result.base_vertex = target.vertex_count;
+        result.first_index = target.index_count;
+
+        target.vertex_buffer.set_data(result.base_vertex * sizeof(TVertex),
+                                      vertex_count * sizeof(TVertex),
+                                      vertices);
+        target.index_buffer.set_data(result.first_index * sizeof(TIndex),
+                                     index_count * sizeof(TIndex),
+                                     indices);
+
+        target.vertex_count += vertex_count;
+        target.index_count += index_count;
+
+        return result;
+      }
+
+      /**
+       * Adds a full page holding the specified vertices and indices. The data is uploaded as the
+       * page's buffers are created, rather than being copied into them afterwards.
+       *
+       * @note
+       * This is intended for loading many meshes whose data is already laid out contiguously. Each
+       * mesh in the page is addressed by offsetting the returned range.
+       *
+       * @return
+       * A range covering the whole page.
+       */
+      range add_page(const TVertex* vertices,
+                     size_t vertex_count,
+                     const TIndex* indices,
+                     size_t index_count)
+      {
+        m_pages.push_back(std::make_unique<page>(vertices, vertex_count, indices, index_count, m_pages.size()));
+
+        range result;
+        result.source = m_pages.back().get();
+        result.base_vertex = 0;
+        result.first_index = 0;
+        return result;
+      }
+
+      /**
+       * The number of pages allocated by this pool.
+       */
+      size_t page_count() const
+      {
+        return m_pages.size();
+      }
+
+      /* -- Implementation -- */
+
+    private:
+
+      /** Returns a page with enough free space, creating it if required. */
+      page& find_page(size_t vertex_count, size_t index_count)
+      {
+        for (auto& existing : m_pages)
+        {
+          if (existing->vertex_count + vertex_count <= existing->vertex_capacity &&
+              existing->index_count + index_count <= existing->index_capacity)
+            return *existing;
+        }
+
+        // meshes larger than a page get a dedicated page of their own
+        m_pages.push_back(std::make_unique<page>(std::max(vertex_count, m_page_vertex_capacity),
+                                                 std::max(index_count, m_page_index_capacity),
+                                                 m_pages.size()));
+        return *m_pages.back();
+      }
+
+      const size_t m_page_vertex_capacity;
+      const size_t m_page_index_capacity;
+      std::vector<std::unique_ptr<page>> m_pages;
+
+    };
+
+  }
+
+  /**
+   * Standard geometry pool type used by the application.
+   */
+  using geometry_pool = lineage::templates::basic_geometry_pool<lineage::vertex, GLuint>;
+
+}
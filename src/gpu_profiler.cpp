@@ -0,0 +1,241 @@
+/**
+ * @file	gpu_profiler.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "api.hpp"
+#include "debug.hpp"
+#include "gpu_profiler.hpp"
+#include "opengl.hpp"
+#include "query.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // Every frame records its own start and end, in addition to the start and end of each scope
+  const size_t MAX_QUERIES_PER_FRAME = (gpu_profiler::max_scopes * 2) + 2;
+  const size_t FRAME_BEGIN_QUERY = 0;
+
+  const double SECONDS_PER_NANOSECOND = 1.0e-9;
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** A scope recorded in a frame, referring to the queries holding its timestamps. */
+  struct scope_record
+  {
+    const char* name;		/**< The name of the scope. */
+    size_t depth;		/**< The nesting depth of the scope. */
+    size_t begin_query;		/**< The query holding the timestamp at the start of the scope. */
+    size_t end_query;		/**< The query holding the timestamp at the end of the scope. */
+  };
+
+  /** The queries and scopes recorded for a single frame. */
+  struct frame_slot
+  {
+    std::vector<std::unique_ptr<lineage::query>> queries;	/**< Queries, created as required. */
+    size_t query_count;						/**< Queries used by the frame. */
+    std::vector<scope_record> scopes;				/**< Scopes recorded in the frame. */
+    bool pending;						/**< Whether results are waiting to be read. */
+  };
+
+}
+
+/* -- Variables -- */
+
+const size_t gpu_profiler::default_latency;
+const size_t gpu_profiler::max_scopes;
+const size_t gpu_profiler::no_scope;
+
+/**
+ * Implementation for the `lineage::gpu_profiler` class.
+ */
+struct gpu_profiler::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(bool enabled, size_t latency)
+    : enabled(enabled),
+      slots(latency + 1),
+      current(0),
+      in_frame(false),
+      depth(0),
+      frame_time(0.0),
+      timings(),
+      dropped_frames(0)
+  {
+    // reserve everything up front, so that recording never allocates once the queries exist
+    for (auto& slot : slots)
+    {
+      slot.queries.reserve(MAX_QUERIES_PER_FRAME);
+      slot.query_count = 0;
+      slot.scopes.reserve(max_scopes);
+      slot.pending = false;
+    }
+    timings.reserve(max_scopes);
+  }
+
+  /* -- Fields -- */
+
+  const bool enabled;
+  std::vector<frame_slot> slots;
+  size_t current;
+  bool in_frame;
+  size_t depth;
+  double frame_time;
+  std::vector<lineage::gpu_scope_timing> timings;
+  uint64_t dropped_frames;
+
+  /* -- Procedures -- */
+
+  /** Records a timestamp in the current frame, and returns the index of its query. */
+  size_t record_timestamp()
+  {
+    auto& slot = slots[current];
+    lineage_assert(slot.query_count < MAX_QUERIES_PER_FRAME);
+    if (slot.query_count == slot.queries.size())
+      slot.queries.push_back(std::make_unique<lineage::query>(GL_TIMESTAMP));
+    slot.queries[slot.query_count]->record_timestamp();
+    return slot.query_count++;
+  }
+
+  /** Returns the time between two of a frame's timestamps, in seconds. */
+  static double elapsed(const frame_slot& slot, size_t begin_query, size_t end_query)
+  {
+    const GLuint64 begin = slot.queries[begin_query]->result();
+    const GLuint64 end = slot.queries[end_query]->result();
+    return (end > begin) ? (static_cast<double>(end - begin) * SECONDS_PER_NANOSECOND) : 0.0;
+  }
+
+  /**
+   * Reads back the results of the specified frame if they are available, or drops them if they
+   * aren't, since the slot is about to be reused.
+   */
+  void resolve(frame_slot& slot)
+  {
+    if (!slot.pending)
+      return;
+    slot.pending = false;
+
+    // commands complete in order, so every timestamp is available once the last one is
+    const size_t end_query = slot.query_count - 1;
+    if (!slot.queries[end_query]->is_result_available())
+    {
+      dropped_frames++;
+      return;
+    }
+
+    frame_time = elapsed(slot, FRAME_BEGIN_QUERY, end_query);
+    timings.clear();
+    for (const auto& scope : slot.scopes)
+    {
+      // scopes which were never ended have no time
+      const double time = (scope.end_query != no_scope) ? elapsed(slot, scope.begin_query, scope.end_query) : 0.0;
+      timings.push_back({ scope.name, scope.depth, time });
+    }
+  }
+
+};
+
+/* -- Procedures -- */
+
+gpu_profiler::gpu_profiler(const opengl& opengl, size_t latency)
+  : impl(std::make_unique<implementation>(opengl.is_supported("GL_ARB_timer_query"), latency))
+{
+}
+
+gpu_profiler::~gpu_profiler() = default;
+
+bool gpu_profiler::is_enabled() const
+{
+  return impl->enabled;
+}
+
+void gpu_profiler::begin_frame()
+{
+  if (!impl->enabled)
+    return;
+  lineage_assert(!impl->in_frame);
+
+  impl->current = (impl->current + 1) % impl->slots.size();
+  auto& slot = impl->slots[impl->current];
+  lineage_assert(!slot.pending);
+  slot.query_count = 0;
+  slot.scopes.clear();
+
+  impl->in_frame = true;
+  impl->depth = 0;
+  impl->record_timestamp();
+}
+
+void gpu_profiler::end_frame()
+{
+  if (!impl->enabled)
+    return;
+  lineage_assert(impl->in_frame);
+
+  impl->record_timestamp();
+  impl->slots[impl->current].pending = true;
+  impl->in_frame = false;
+
+  // the oldest slot is the next one to be reused
+  impl->resolve(impl->slots[(impl->current + 1) % impl->slots.size()]);
+}
+
+size_t gpu_profiler::begin_scope(const char* name)
+{
+  if (!impl->enabled || !impl->in_frame)
+    return no_scope;
+
+  auto& slot = impl->slots[impl->current];
+  if (slot.scopes.size() == max_scopes)
+    return no_scope;
+
+  const size_t begin_query = impl->record_timestamp();
+  slot.scopes.push_back({ name, impl->depth, begin_query, no_scope });
+  impl->depth++;
+  return (slot.scopes.size() - 1);
+}
+
+void gpu_profiler::end_scope(size_t scope)
+{
+  if (scope == no_scope)
+    return;
+
+  auto& slot = impl->slots[impl->current];
+  lineage_assert(scope < slot.scopes.size() && slot.scopes[scope].end_query == no_scope);
+  slot.scopes[scope].end_query = impl->record_timestamp();
+  impl->depth--;
+}
+
+double gpu_profiler::frame_time() const
+{
+  return impl->frame_time;
+}
+
+const std::vector<gpu_scope_timing>& gpu_profiler::scope_timings() const
+{
+  return impl->timings;
+}
+
+uint64_t gpu_profiler::dropped_frames() const
+{
+  return impl->dropped_frames;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file	gpu_profiler.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class opengl;
+
+  /**
+   * Struct representing the GPU time spent in a single named scope of a frame.
+   */
+  struct gpu_scope_timing
+  {
+    const char* name;	/**< The name of the scope. */
+    size_t depth;	/**< The nesting depth of the scope. Top-level scopes have a depth of zero. */
+    double time;	/**< The GPU time spent in the scope, in seconds. */
+  };
+
+  /**
+   * Class which measures GPU time for frames, and for named scopes within them, without stalling
+   * the pipeline.
+   *
+   * @note
+   * Timestamps are recorded with a pool of `GL_TIMESTAMP` queries - unlike `GL_TIME_ELAPSED`
+   * queries, these allow scopes to be nested. Each frame's queries are only read back `latency`
+   * frames later, by which time the GPU has almost always finished with them. If a frame's results
+   * still aren't available by then, they are dropped rather than waited for.
+   *
+   * If the context doesn't support timer queries, every method does nothing and all times are
+   * zero.
+   */
+  class gpu_profiler
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The default number of frames to wait before reading back results. */
+    static const size_t default_latency = 3;
+
+    /** The maximum number of scopes which can be recorded in each frame. */
+    static const size_t max_scopes = 128;
+
+    /** Scope identifier returned when a scope is not being recorded. */
+    static const size_t no_scope = std::numeric_limits<size_t>::max();
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::gpu_profiler` instance.
+     *
+     * @param opengl
+     * The OpenGL interface in use by the application.
+     *
+     * @param latency
+     * The number of frames to wait before reading back the results for each frame.
+     */
+    gpu_profiler(const lineage::opengl& opengl, size_t latency = default_latency);
+
+    /**
+     * Destructor.
+     */
+    ~gpu_profiler();
+
+  private:
+
+    gpu_profiler(const lineage::gpu_profiler&) = delete;
+    gpu_profiler(lineage::gpu_profiler&&) = delete;
+    lineage::gpu_profiler& operator =(const lineage::gpu_profiler&) = delete;
+    lineage::gpu_profiler& operator =(lineage::gpu_profiler&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns `true` if the context supports timer queries.
+     */
+    bool is_enabled() const;
+
+    /**
+     * Records the start of a frame.
+     */
+    void begin_frame();
+
+    /**
+     * Records the end of a frame, and reads back the results of the frame `latency` frames ago.
+     */
+    void end_frame();
+
+    /**
+     * Records the start of a named scope. Scopes must be ended in the reverse of the order in which
+     * they were started.
+     *
+     * @param name
+     * The name of the scope. This is not copied, so it should be a string literal.
+     *
+     * @return
+     * An identifier to pass to `end_scope()`, or `gpu_profiler::no_scope` if the scope isn't
+     * being recorded.
+     */
+    size_t begin_scope(const char* name);
+
+    /**
+     * Records the end of a scope started by `begin_scope()`.
+     */
+    void end_scope(size_t scope);
+
+    /**
+     * The GPU time taken by the most recent frame whose results have been read back, in seconds.
+     */
+    double frame_time() const;
+
+    /**
+     * The GPU time taken by each scope of the most recent frame whose results have been read
+     * back, in the order in which the scopes were started.
+     */
+    const std::vector<lineage::gpu_scope_timing>& scope_timings() const;
+
+    /**
+     * The number of frames whose results weren't available in time, and were dropped.
+     */
+    uint64_t dropped_frames() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -6,7 +6,8 @@
 
 /* -- Includes -- */
 
-#include <unordered_map>
+#include <atomic>
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -19,6 +20,14 @@
 
 using namespace lineage;
 
+/* -- Constants -- */
+
+namespace
+{
+  // Number of values in the `lineage::input_type` enumeration
+  const size_t INPUT_TYPE_COUNT = static_cast<size_t>(input_type::lighting_intensity_decrease) + 1;
+}
+
 /* -- Types -- */
 
 struct input_manager::implementation
@@ -29,14 +38,21 @@ struct input_manager::implementation
   implementation(const lineage::window& window)
     : window(window),
       states(),
-      observers()
-  { }
+      observers(),
+      window_input_enabled(true)
+  {
+    for (auto& state : states)
+      state = lineage::input_state::invalid;
+  }
 
   /* -- Fields -- */
 
   const lineage::window& window;
-  std::unordered_map<lineage::input_type, lineage::input_state, lineage::enum_class_hash> states;
+  // states are written by the input thread and may be read by the state thread, so they are
+  // stored as atomics rather than behind a lock
+  std::atomic<lineage::input_state> states[INPUT_TYPE_COUNT];
   std::vector<lineage::input_observer*> observers;
+  bool window_input_enabled;
 
   /* -- Methods -- */
 
@@ -118,17 +134,15 @@ input_manager::~input_manager()
 
 input_state input_manager::input_state(input_type type) const
 {
-  const auto it = impl->states.find(type);
-  return (it != impl->states.end() ? it->second : lineage::input_state::invalid);
+  return impl->states[static_cast<size_t>(type)].load(std::memory_order_relaxed);
 }
 
 void input_manager::set_input_state(lineage::input_type type, lineage::input_state state)
 {
-  const auto current_state = impl->states[type];
-  if (state == current_state)
+  auto& current_state = impl->states[static_cast<size_t>(type)];
+  if (current_state.exchange(state, std::memory_order_relaxed) == state)
     return;
 
-  impl->states[type] = state;
   for (auto observer : impl->observers)
     observer->input_event(type, state);
 }
@@ -143,8 +157,16 @@ void input_manager::remove_observer(input_observer& observer) const
   remove_all(impl->observers, &observer);
 }
 
+void input_manager::set_window_input_enabled(bool enabled)
+{
+  impl->window_input_enabled = enabled;
+}
+
 void input_manager::window_key_event(int key, int action, int mods)
 {
+  if (!impl->window_input_enabled)
+    return;
+
   const auto state = impl->input_state_for_key_event(action);
   if (state == lineage::input_state::active)
   {
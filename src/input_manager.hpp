@@ -120,6 +120,10 @@ namespace lineage
 
     /**
      * Gets the state of the specified input type.
+     *
+     * @note
+     * This may be called from any thread. Observers are always notified on the thread polling for
+     * window events.
      */
     lineage::input_state input_state(lineage::input_type type) const;
 
@@ -128,6 +132,12 @@ namespace lineage
      */
     void set_input_state(lineage::input_type type, lineage::input_state state);
 
+    /**
+     * Sets whether key events from the window change input states. Disabling them leaves
+     * `set_input_state()` as the only source of input, for example while replaying a recording.
+     */
+    void set_window_input_enabled(bool enabled);
+
     /**
      * Adds an observer to the input manager.
      */
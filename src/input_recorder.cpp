@@ -0,0 +1,145 @@
+/**
+ * @file	input_recorder.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "input_manager.hpp"
+#include "input_recorder.hpp"
+#include "window.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std::string_literals;
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const double MICROSECONDS_PER_SECOND = 1.0e6;
+}
+
+/* -- Variables -- */
+
+const char input_recorder::file_magic[4] = { 'L', 'N', 'I', 'R' };
+const uint16_t input_recorder::file_version;
+const size_t input_recorder::header_size;
+const size_t input_recorder::event_size;
+
+/**
+ * Implementation for the `lineage::input_recorder` class.
+ */
+struct input_recorder::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const lineage::window& window,
+                 const lineage::input_manager& input_manager,
+                 const std::string& path)
+    : window(window),
+      input_manager(input_manager),
+      file(path, std::ios::binary | std::ios::trunc),
+      start_us(0),
+      last_us(0),
+      event_count(0)
+  {
+    if (!file)
+      throw std::runtime_error("Failed to open input recording "s + path);
+
+    const uint8_t header[header_size] =
+    {
+      static_cast<uint8_t>(file_magic[0]),
+      static_cast<uint8_t>(file_magic[1]),
+      static_cast<uint8_t>(file_magic[2]),
+      static_cast<uint8_t>(file_magic[3]),
+      static_cast<uint8_t>(file_version & 0xFF),
+      static_cast<uint8_t>(file_version >> 8),
+    };
+    file.write(reinterpret_cast<const char*>(header), header_size);
+
+    start_us = now_us();
+  }
+
+  /* -- Fields -- */
+
+  const lineage::window& window;
+  const lineage::input_manager& input_manager;
+  std::ofstream file;
+  uint64_t start_us;
+  uint64_t last_us;
+  uint64_t event_count;
+
+  /* -- Procedures -- */
+
+  /** Returns the window's clock, in whole microseconds. */
+  uint64_t now_us() const
+  {
+    return static_cast<uint64_t>(std::llround(window.time() * MICROSECONDS_PER_SECOND));
+  }
+
+  /** Writes a single event, timestamped with the current time. */
+  void write_event(lineage::input_type type, lineage::input_state state)
+  {
+    // the interval is stored relative to the previous event, so that it fits in 32 bits - an
+    // event more than an hour after the previous one is recorded slightly early
+    const uint64_t time_us = now_us() - start_us;
+    const uint32_t delta_us = static_cast<uint32_t>(std::min<uint64_t>(time_us - last_us, std::numeric_limits<uint32_t>::max()));
+    last_us += delta_us;
+
+    const uint8_t event[event_size] =
+    {
+      static_cast<uint8_t>(delta_us & 0xFF),
+      static_cast<uint8_t>((delta_us >> 8) & 0xFF),
+      static_cast<uint8_t>((delta_us >> 16) & 0xFF),
+      static_cast<uint8_t>((delta_us >> 24) & 0xFF),
+      static_cast<uint8_t>(type),
+      static_cast<uint8_t>(state),
+    };
+    file.write(reinterpret_cast<const char*>(event), event_size);
+  }
+
+};
+
+/* -- Procedures -- */
+
+input_recorder::input_recorder(const window& window,
+                               const input_manager& input_manager,
+                               const std::string& path)
+  : impl(std::make_unique<implementation>(window, input_manager, path))
+{
+  impl->input_manager.add_observer(*this);
+}
+
+input_recorder::~input_recorder()
+{
+  impl->input_manager.remove_observer(*this);
+  impl->write_event(input_type::invalid, input_state::invalid);
+}
+
+uint64_t input_recorder::event_count() const
+{
+  return impl->event_count;
+}
+
+void input_recorder::input_event(input_type type, input_state state)
+{
+  // unmapped keys are reported with an invalid type, which is reserved for the end of the file
+  if (type == input_type::invalid)
+    return;
+
+  impl->write_event(type, state);
+  impl->event_count++;
+}
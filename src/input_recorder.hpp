@@ -0,0 +1,115 @@
+/**
+ * @file	input_recorder.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "input_manager.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class window;
+
+  /**
+   * Class which records every input event from a `lineage::input_manager` to a file, for playback
+   * with `lineage::input_replayer`.
+   *
+   * @note
+   * A recording starts with a header of `input_recorder::header_size` bytes - the magic bytes
+   * `LNIR` followed by the format version as a little-endian 16-bit integer. Each event is then
+   * stored in `input_recorder::event_size` bytes: the time since the previous event in
+   * microseconds as a little-endian 32-bit integer, followed by the input type and the input
+   * state as single bytes. The last event has type `input_type::invalid`, and marks the time at
+   * which the recording was stopped.
+   */
+  class input_recorder : public lineage::input_observer
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The magic bytes at the start of every recording. */
+    static const char file_magic[4];
+
+    /** The version of the recording format written by this class. */
+    static const uint16_t file_version = 1;
+
+    /** The size of the header at the start of every recording, in bytes. */
+    static const size_t header_size = 6;
+
+    /** The size of each event in a recording, in bytes. */
+    static const size_t event_size = 6;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::input_recorder` instance, and starts recording.
+     *
+     * @param window
+     * The application's main window, whose clock is used to timestamp events.
+     *
+     * @param input_manager
+     * The input manager to record events from.
+     *
+     * @param path
+     * The path of the file to write. Any existing file is replaced.
+     *
+     * @exception std::runtime_error
+     * Thrown if the file cannot be opened.
+     */
+    input_recorder(const lineage::window& window,
+                   const lineage::input_manager& input_manager,
+                   const std::string& path);
+
+    /**
+     * Destructor. Stops recording, and finishes writing the file.
+     */
+    ~input_recorder();
+
+  private:
+
+    input_recorder(const lineage::input_recorder&) = delete;
+    input_recorder(lineage::input_recorder&&) = delete;
+    lineage::input_recorder& operator =(const lineage::input_recorder&) = delete;
+    lineage::input_recorder& operator =(lineage::input_recorder&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * The number of events recorded so far.
+     */
+    uint64_t event_count() const;
+
+    /* -- `lineage::input_observer` Implementation -- */
+
+  public:
+
+    virtual void input_event(lineage::input_type type, lineage::input_state state) override;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
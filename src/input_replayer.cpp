@@ -0,0 +1,158 @@
+/**
+ * @file	input_replayer.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "input_manager.hpp"
+#include "input_recorder.hpp"
+#include "input_replayer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std::string_literals;
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const double MICROSECONDS_PER_SECOND = 1.0e6;
+  const uint8_t LAST_INPUT_TYPE = static_cast<uint8_t>(input_type::lighting_intensity_decrease);
+  const uint8_t LAST_INPUT_STATE = static_cast<uint8_t>(input_state::active);
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** A single recorded event. */
+  struct replay_event
+  {
+    uint64_t time_us;		/**< The time of the event since the start of the recording. */
+    lineage::input_type type;	/**< The input whose state changed. */
+    lineage::input_state state;	/**< The new state of the input. */
+  };
+
+}
+
+/**
+ * Implementation for the `lineage::input_replayer` class.
+ */
+struct input_replayer::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(lineage::input_manager& input_manager)
+    : input_manager(input_manager),
+      events(),
+      duration_us(0),
+      next_event(0),
+      finished(false)
+  { }
+
+  /* -- Fields -- */
+
+  lineage::input_manager& input_manager;
+  std::vector<replay_event> events;
+  uint64_t duration_us;
+  size_t next_event;
+  bool finished;
+
+  /* -- Procedures -- */
+
+  /** Parses the contents of a recording. */
+  void load(const std::vector<uint8_t>& data, const std::string& path)
+  {
+    const size_t header_size = input_recorder::header_size;
+    const size_t event_size = input_recorder::event_size;
+
+    if (data.size() < header_size ||
+        data[0] != static_cast<uint8_t>(input_recorder::file_magic[0]) ||
+        data[1] != static_cast<uint8_t>(input_recorder::file_magic[1]) ||
+        data[2] != static_cast<uint8_t>(input_recorder::file_magic[2]) ||
+        data[3] != static_cast<uint8_t>(input_recorder::file_magic[3]))
+      throw std::runtime_error("Not an input recording: "s + path);
+
+    const uint16_t version = static_cast<uint16_t>(data[4] | (data[5] << 8));
+    if (version != input_recorder::file_version)
+      throw std::runtime_error("Unsupported input recording version: "s + path);
+
+    // a recording which was never stopped cleanly is missing its end marker, so it just ends at
+    // its last event
+    uint64_t time_us = 0;
+    for (size_t offset = header_size; offset + event_size <= data.size(); offset += event_size)
+    {
+      const uint8_t* event = data.data() + offset;
+      time_us += (static_cast<uint32_t>(event[0]) |
+                  (static_cast<uint32_t>(event[1]) << 8) |
+                  (static_cast<uint32_t>(event[2]) << 16) |
+                  (static_cast<uint32_t>(event[3]) << 24));
+      duration_us = time_us;
+
+      if (event[4] == static_cast<uint8_t>(input_type::invalid))
+        break;
+      if (event[4] > LAST_INPUT_TYPE || event[5] > LAST_INPUT_STATE)
+        throw std::runtime_error("Corrupt input recording: "s + path);
+      events.push_back({ time_us, static_cast<lineage::input_type>(event[4]), static_cast<lineage::input_state>(event[5]) });
+    }
+  }
+
+};
+
+/* -- Procedures -- */
+
+input_replayer::input_replayer(input_manager& input_manager, const std::string& path)
+  : impl(std::make_unique<implementation>(input_manager))
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Failed to open input recording "s + path);
+
+  const std::vector<uint8_t> data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+  impl->load(data, path);
+}
+
+input_replayer::~input_replayer() = default;
+
+void input_replayer::advance(double time)
+{
+  // compare in whole microseconds, exactly as the events were stored
+  const uint64_t time_us = (time > 0.0) ? static_cast<uint64_t>(time * MICROSECONDS_PER_SECOND) : 0;
+  while (impl->next_event < impl->events.size() && impl->events[impl->next_event].time_us <= time_us)
+  {
+    const auto& event = impl->events[impl->next_event++];
+    impl->input_manager.set_input_state(event.type, event.state);
+  }
+
+  if (time_us >= impl->duration_us)
+    impl->finished = true;
+}
+
+bool input_replayer::is_finished() const
+{
+  return impl->finished;
+}
+
+double input_replayer::duration() const
+{
+  return impl->duration_us / MICROSECONDS_PER_SECOND;
+}
+
+size_t input_replayer::event_count() const
+{
+  return impl->events.size();
+}
@@ -0,0 +1,99 @@
+/**
+ * @file	input_replayer.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class input_manager;
+
+  /**
+   * Class which plays back a recording made by `lineage::input_recorder`.
+   *
+   * @note
+   * Playback is driven by a simulated clock rather than the window's clock - each call to
+   * `advance()` applies every event recorded up to the specified time. Driving it from a fixed
+   * timestep applies every event before exactly the same update on every run.
+   */
+  class input_replayer
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::input_replayer` instance, and loads the specified recording.
+     *
+     * @param input_manager
+     * The input manager to apply the recorded events to.
+     *
+     * @param path
+     * The path of the recording to play back.
+     *
+     * @exception std::runtime_error
+     * Thrown if the file cannot be read, or is not a valid recording.
+     */
+    input_replayer(lineage::input_manager& input_manager, const std::string& path);
+
+    /**
+     * Destructor.
+     */
+    ~input_replayer();
+
+  private:
+
+    input_replayer(const lineage::input_replayer&) = delete;
+    input_replayer(lineage::input_replayer&&) = delete;
+    lineage::input_replayer& operator =(const lineage::input_replayer&) = delete;
+    lineage::input_replayer& operator =(lineage::input_replayer&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Applies every event recorded at or before the specified time since the start of the
+     * recording, in seconds.
+     */
+    void advance(double time);
+
+    /**
+     * Returns `true` once the simulated clock has reached the time at which the recording was
+     * stopped.
+     */
+    bool is_finished() const;
+
+    /**
+     * The length of the recording, in seconds.
+     */
+    double duration() const;
+
+    /**
+     * The number of input events in the recording.
+     */
+    size_t event_count() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,94 @@
+/**
+ * @file	lod_chain.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "debug.hpp"
+#include "lod_chain.hpp"
+#include "mesh.hpp"
+#include "mesh_simplifier.hpp"
+#include "scene_graph.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the number of triangles drawn by a triangle list, strip, or fan. */
+  size_t triangle_count(const mesh& source)
+  {
+    if (source.draw_mode() == GL_TRIANGLES)
+      return source.index_count() / 3;
+    return (source.index_count() > 2 ? source.index_count() - 2 : 0);
+  }
+
+}
+
+/* -- Procedures -- */
+
+size_t lineage::select_lod_level(const lod_chain& chain,
+                                 float screen_size,
+                                 size_t current_level,
+                                 float hysteresis)
+{
+  lineage_assert(!chain.levels.empty());
+  const size_t last_level = chain.levels.size() - 1;
+  size_t level = std::min(current_level, last_level);
+
+  // move to a finer level only once the size is clearly above that level's threshold...
+  while (level > 0 && screen_size >= chain.levels[level - 1].min_screen_size * (1.0f + hysteresis))
+    level--;
+
+  // ...and to a coarser level only once it is clearly below the current level's threshold
+  while (level < last_level && screen_size < chain.levels[level].min_screen_size * (1.0f - hysteresis))
+    level++;
+
+  return level;
+}
+
+size_t lineage::generate_lod_chain(scene_graph& graph,
+                                   size_t mesh_index,
+                                   size_t level_count,
+                                   float reduction,
+                                   float first_screen_size)
+{
+  lineage_assert(level_count > 0);
+  lineage_assert(reduction > 0.0f && reduction < 1.0f);
+
+  lod_chain chain;
+  chain.levels.push_back({ mesh_index, first_screen_size });
+
+  auto& meshes = graph.meshes();
+  float screen_size = first_screen_size;
+  for (size_t level = 1; level < level_count; level++)
+  {
+    const auto& previous = *meshes[chain.levels.back().mesh_index];
+    auto simplified = simplify(previous, graph.geometry(), reduction);
+
+    // stop early once the simplifier can't remove anything else
+    if (triangle_count(*simplified) >= triangle_count(previous))
+      break;
+
+    screen_size *= 0.5f;
+    meshes.push_back(std::move(simplified));
+    chain.levels.push_back({ meshes.size() - 1, screen_size });
+  }
+
+  // the coarsest level is used all the way down to nothing
+  chain.levels.back().min_screen_size = 0.0f;
+
+  graph.lod_chains().push_back(std::move(chain));
+  return graph.lod_chains().size() - 1;
+}
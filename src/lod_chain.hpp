@@ -0,0 +1,99 @@
+/**
+ * @file	lod_chain.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class scene_graph;
+
+  /**
+   * Struct representing a single level of detail in a `lineage::lod_chain`.
+   */
+  struct lod_level
+  {
+    size_t mesh_index;		/**< The index of the mesh drawn for this level. */
+    float min_screen_size;	/**< The smallest projected size, as a fraction of the viewport height, at which this level is used. */
+  };
+
+  /**
+   * Struct representing a chain of meshes for the same object at decreasing levels of detail.
+   *
+   * @note
+   * Levels are ordered from the most detailed to the least detailed, with decreasing
+   * `min_screen_size`. The last level is used at every size below the previous level's threshold.
+   */
+  struct lod_chain
+  {
+    std::vector<lineage::lod_level> levels;	/**< The levels in this chain. */
+  };
+
+}
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /**
+   * Selects the level of a chain to draw for an object with the specified projected size.
+   *
+   * @param chain
+   * The chain to select a level from.
+   *
+   * @param screen_size
+   * The projected size of the object, as a fraction of the viewport height.
+   *
+   * @param current_level
+   * The level drawn in the previous frame.
+   *
+   * @param hysteresis
+   * The fraction by which the size must cross a threshold before switching away from
+   * `current_level`, to avoid popping back and forth at the boundary.
+   */
+  size_t select_lod_level(const lineage::lod_chain& chain,
+                          float screen_size,
+                          size_t current_level,
+                          float hysteresis);
+
+  /**
+   * Generates a LOD chain for a mesh in the specified graph by repeatedly simplifying it, and adds
+   * the chain and the new meshes to the graph.
+   *
+   * @param graph
+   * The graph containing the mesh.
+   *
+   * @param mesh_index
+   * The index of the full-resolution mesh, which is used for the first level.
+   *
+   * @param level_count
+   * The total number of levels to generate, including the full-resolution level.
+   *
+   * @param reduction
+   * The fraction of triangles to keep at each successive level.
+   *
+   * @param first_screen_size
+   * The projected size below which the second level is used. Each successive threshold is half of
+   * the previous one.
+   *
+   * @return
+   * The index of the new chain in `graph.lod_chains()`.
+   */
+  size_t generate_lod_chain(lineage::scene_graph& graph,
+                            size_t mesh_index,
+                            size_t level_count,
+                            float reduction,
+                            float first_screen_size);
+
+}
@@ -6,18 +6,32 @@
 
 /* -- Includes -- */
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "application.hpp"
 #include "debug.hpp"
 #include "default_render_manager.hpp"
 #include "default_state_manager.hpp"
+#include "framebuffer.hpp"
 #include "input_manager.hpp"
+#include "input_recorder.hpp"
+#include "input_replayer.hpp"
 #include "opengl.hpp"
+#include "program_cache.hpp"
 #include "prototype_render_manager.hpp"
 #include "prototype_state_manager.hpp"
 #include "render_manager.hpp"
+#include "scene_builder.hpp"
+#include "scene_graph.hpp"
+#include "shader_compiler.hpp"
 #include "state_manager.hpp"
 #include "window.hpp"
 
@@ -26,11 +40,39 @@
 using namespace std::string_literals;
 using namespace lineage;
 
+/* -- Types -- */
+
+namespace
+{
+
+  /** Options parsed from the command line. */
+  struct options
+  {
+    bool headless;		/**< Render into an offscreen framebuffer, with the window hidden. */
+    int width;			/**< The width of the window, or of the offscreen framebuffer. */
+    int height;			/**< The height of the window, or of the offscreen framebuffer. */
+    int msaa_samples;		/**< The number of samples per pixel. */
+    uint64_t frame_limit;	/**< The number of frames to render, or zero to run until closed. */
+    std::string output;		/**< Path to write the last headless frame to, or empty. */
+    std::string scene;		/**< The name of the scene to display. */
+    size_t scene_size;		/**< The number of cubes in a stress scene, or per axis for a grid of cubes or spheres. */
+    uint32_t seed;		/**< The seed for randomly generated scenes. */
+    lineage::stress_scene_args stress_args;	/**< The mesh and color counts for stress scenes. */
+    std::string record;		/**< Path to record input events to, or empty. */
+    std::string replay;		/**< Path of an input recording to replay, or empty. */
+    std::string shader_cache;	/**< Directory to cache shader program binaries in, or empty. */
+  };
+
+}
+
 /* -- Procedure Prototypes -- */
 
 namespace
 {
-  void run_application();
+  options parse_options(int argc, char** argv);
+  void run_application(const options& opts);
+  lineage::scene_graph create_scene_graph(const options& opts);
+  void write_ppm(const std::string& path, int width, int height, const std::vector<uint8_t>& pixels);
 }
 
 /* -- Procedures -- */
@@ -39,7 +81,7 @@ int main(int argc, char** argv)
 {
   try
   {
-    run_application();
+    run_application(parse_options(argc, argv));
     return 0;
   }
   catch (const std::exception& ex)
@@ -57,36 +99,218 @@ int main(int argc, char** argv)
 namespace
 {
 
+  /**
+   * Parses the command line options.
+   *
+   * @exception std::invalid_argument
+   * Thrown if an option is not recognized, or is missing its value.
+   */
+  options parse_options(int argc, char** argv)
+  {
+    options opts;
+    opts.headless = false;
+    opts.width = 800;
+    opts.height = 600;
+    opts.msaa_samples = 16;
+    opts.frame_limit = 0;
+    opts.output = "";
+    opts.scene = "cubes";
+    opts.scene_size = 10;
+    opts.seed = 1;
+    opts.stress_args.mesh_count = 1;
+    opts.stress_args.color_count = 7;
+    opts.record = "";
+    opts.replay = "";
+    opts.shader_cache = lineage::program_cache::default_directory();
+
+    for (int index = 1; index < argc; index++)
+    {
+      const std::string option { argv[index] };
+      auto value = [&] {
+        if (index + 1 >= argc)
+          throw std::invalid_argument("Missing value for option "s + option);
+        return std::string(argv[++index]);
+      };
+
+      if (option == "--headless")
+        opts.headless = true;
+      else if (option == "--width")
+        opts.width = std::stoi(value());
+      else if (option == "--height")
+        opts.height = std::stoi(value());
+      else if (option == "--samples")
+        opts.msaa_samples = std::stoi(value());
+      else if (option == "--frames")
+        opts.frame_limit = std::stoull(value());
+      else if (option == "--output")
+        opts.output = value();
+      else if (option == "--scene")
+        opts.scene = value();
+      else if (option == "--scene-size")
+        opts.scene_size = std::stoull(value());
+      else if (option == "--seed")
+        opts.seed = static_cast<uint32_t>(std::stoul(value()));
+      else if (option == "--meshes")
+        opts.stress_args.mesh_count = std::stoull(value());
+      else if (option == "--colors")
+        opts.stress_args.color_count = std::stoull(value());
+      else if (option == "--record")
+        opts.record = value();
+      else if (option == "--replay")
+        opts.replay = value();
+      else if (option == "--shader-cache")
+        opts.shader_cache = value();
+      else
+        throw std::invalid_argument("Unrecognized option "s + option);
+    }
+
+    if (opts.width <= 0 || opts.height <= 0 || opts.msaa_samples < 0)
+      throw std::invalid_argument("Invalid framebuffer dimensions!");
+    if (opts.scene_size == 0)
+      throw std::invalid_argument("--scene-size must be at least 1");
+    if (opts.scene == "chain" && opts.scene_size > lineage::MAX_CHAIN_DEPTH)
+      throw std::invalid_argument("--scene-size for the chain scene must be at most "s +
+                                  std::to_string(lineage::MAX_CHAIN_DEPTH));
+    if (!opts.output.empty() && !opts.headless)
+      throw std::invalid_argument("--output requires --headless");
+    if (!opts.record.empty() && !opts.replay.empty())
+      throw std::invalid_argument("--record and --replay cannot be used together");
+
+    return opts;
+  }
+
   /**
    * Runs an instance of the application.
+   *
+   * @exception std::runtime_error
+   * Thrown if a run with a frame limit made heap allocations once it reached a steady state.
    */
-  void run_application()
+  void run_application(const options& opts)
   {
     window_args args;
     args.context_version_major = 3;
     args.context_version_minor = 2;
     args.context_profile = GLFW_OPENGL_CORE_PROFILE;
     args.context_forward_compatibility = true;
-    args.msaa_samples = 16;
-    args.width = 800;
-    args.height = 600;
+    args.width = opts.width;
+    args.height = opts.height;
     args.title = "Lineage";
-    args.swap_interval = 1;
+    args.visible = !opts.headless;
+
+    // a headless run renders to its own framebuffer, so the hidden window's default framebuffer is
+    // never presented - it doesn't need to be multisampled or synchronized to a display
+    args.msaa_samples = (opts.headless ? 0 : opts.msaa_samples);
+    args.swap_interval = (opts.headless ? 0 : 1);
 
     lineage::window window { args };
     lineage::opengl opengl { };
     lineage::input_manager input_manager { window };
 
+    // the offscreen framebuffer matches the window's framebuffer, since that is what the renderer
+    // sizes its viewport from
+    std::unique_ptr<lineage::framebuffer> offscreen;
+    if (opts.headless)
+    {
+      int width = 0;
+      int height = 0;
+      window.framebuffer_size(&width, &height);
+      offscreen = std::make_unique<lineage::framebuffer>(width, height, opts.msaa_samples);
+      opengl.push_framebuffer(*offscreen);
+    }
+
 #if defined(LINEAGE_PROTOTYPE)
     lineage::prototype_state_manager state_manager { input_manager };
     lineage::prototype_render_manager render_manager { opengl, state_manager };
 #else
-    lineage::default_state_manager state_manager { input_manager };
-    lineage::default_render_manager render_manager { opengl, state_manager };
+    lineage::default_state_manager state_manager { input_manager, create_scene_graph(opts) };
+    lineage::shader_compiler shader_compiler { window, opengl };
+    lineage::program_cache program_cache { opengl, shader_compiler, opts.shader_cache };
+    lineage::default_render_manager render_manager { opengl, state_manager, program_cache };
 #endif
 
     application app { window, opengl, input_manager, state_manager, render_manager };
+    app.set_frame_limit(opts.frame_limit);
+
+    std::unique_ptr<lineage::input_recorder> recorder;
+    if (!opts.record.empty())
+      recorder = std::make_unique<lineage::input_recorder>(window, input_manager, opts.record);
+
+    std::unique_ptr<lineage::input_replayer> replayer;
+    if (!opts.replay.empty())
+    {
+      replayer = std::make_unique<lineage::input_replayer>(input_manager, opts.replay);
+      app.set_input_replayer(replayer.get());
+    }
+
     app.main();
+    recorder.reset();
+
+    if (offscreen)
+    {
+      if (!opts.output.empty())
+      {
+        std::vector<uint8_t> pixels;
+        offscreen->read_pixels(&pixels);
+        write_ppm(opts.output, offscreen->width(), offscreen->height(), pixels);
+      }
+      opengl.pop_framebuffer();
+    }
+
+    // a run with a frame limit is used as a check, so it fails if the main loop allocated
+    if (opts.frame_limit != 0 && app.steady_state_allocation_count() != 0)
+      throw std::runtime_error("Heap allocations were made in the steady state!");
+  }
+
+  /**
+   * Creates the scene graph named by the command line options.
+   *
+   * @exception std::invalid_argument
+   * Thrown if the scene is not recognized.
+   */
+  lineage::scene_graph create_scene_graph(const options& opts)
+  {
+    const size_t size = opts.scene_size;
+    if (opts.scene == "cubes")
+      return create_multiple_cubes_scene_graph();
+    else if (opts.scene == "grid")
+      return create_cube_grid_scene_graph(size, size, size, opts.stress_args);
+    else if (opts.scene == "chain")
+      return create_deep_chain_scene_graph(size, opts.stress_args);
+    else if (opts.scene == "fan")
+      return create_wide_fan_scene_graph(size, opts.stress_args);
+    else if (opts.scene == "spheres")
+      return create_lod_sphere_grid_scene_graph(size, size, size, opts.stress_args);
+    else if (opts.scene == "scatter")
+    {
+      // keep the density of the scattered cubes roughly constant as their number changes
+      const float extent = std::cbrt(static_cast<float>(size)) * 2.0f;
+      return create_random_scatter_scene_graph(size, extent, opts.seed, opts.stress_args);
+    }
+    else
+      throw std::invalid_argument("Unrecognized scene "s + opts.scene);
+  }
+
+  /**
+   * Writes RGBA pixels, starting from the bottom row, to a binary PPM image.
+   *
+   * @exception std::runtime_error
+   * Thrown if the file could not be written.
+   */
+  void write_ppm(const std::string& path, int width, int height, const std::vector<uint8_t>& pixels)
+  {
+    std::ofstream file { path, std::ios::binary };
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    // PPM images start from the top row
+    for (int row = height - 1; row >= 0; row--)
+    {
+      const uint8_t* pixel = pixels.data() + (static_cast<size_t>(row) * width * 4);
+      for (int column = 0; column < width; column++, pixel += 4)
+        file.write(reinterpret_cast<const char*>(pixel), 3);
+    }
+
+    if (!file)
+      throw std::runtime_error("Failed to write image to "s + path);
   }
 
 }
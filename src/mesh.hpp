@@ -12,8 +12,12 @@
 #include <utility>
 #include <vector>
 
+#include <glm/glm.hpp>
+
 #include "api.hpp"
+#include "bounds.hpp"
 #include "buffer.hpp"
+#include "geometry_pool.hpp"
 #include "vertex.hpp"
 
 /* -- Types -- */
@@ -25,6 +29,10 @@ namespace lineage
 
     /**
      * Class representing a renderable mesh.
+     *
+     * @note
+     * Mesh data is stored in a range of a shared `lineage::templates::basic_geometry_pool`, which
+     * must outlive the mesh.
      */
     template <typename TVertex, typename TIndex>
     class basic_mesh
@@ -40,21 +48,56 @@ namespace lineage
       /** The type of index that this mesh uses. */
       using index_type = TIndex;
 
+      /** The type of geometry pool that this mesh is stored in. */
+      using pool_type = lineage::templates::basic_geometry_pool<TVertex, TIndex>;
+
       /* -- Lifecycle -- */
 
     public:
 
       /**
-       * Constructs a new mesh with the specified parameters.
+       * Constructs a new mesh with the specified parameters, copying its data into `pool`.
        */
-      basic_mesh(GLenum draw_mode,
+      basic_mesh(pool_type& pool,
+                 GLenum draw_mode,
                  const std::vector<TVertex>& vertices,
                  const std::vector<TIndex>& indices)
+        : basic_mesh(pool, draw_mode, vertices.data(), vertices.size(), indices.data(), indices.size())
+      { }
+
+      /**
+       * Constructs a new mesh with the specified parameters, copying its data into `pool`.
+       */
+      basic_mesh(pool_type& pool,
+                 GLenum draw_mode,
+                 const TVertex* vertices,
+                 size_t vertex_count,
+                 const TIndex* indices,
+                 size_t index_count)
         : m_draw_mode(draw_mode),
-          m_vertex_buffer(vertices, 0),
-          m_vertex_count(vertices.size()),
-          m_index_buffer(indices, 0),
-          m_index_count(indices.size())
+          m_range(pool.allocate(vertices, vertex_count, indices, index_count)),
+          m_vertex_count(vertex_count),
+          m_index_count(index_count),
+          m_bounds(compute_bounds(vertices, vertex_count)),
+          m_bounding_sphere(compute_bounding_sphere(vertices, vertex_count, m_bounds))
+      { }
+
+      /**
+       * Constructs a new mesh whose data has already been stored in a pool, with precomputed
+       * bounds.
+       */
+      basic_mesh(const typename pool_type::range& range,
+                 GLenum draw_mode,
+                 size_t vertex_count,
+                 size_t index_count,
+                 const lineage::bounding_box& bounds,
+                 const lineage::bounding_sphere& bounding_sphere)
+        : m_draw_mode(draw_mode),
+          m_range(range),
+          m_vertex_count(vertex_count),
+          m_index_count(index_count),
+          m_bounds(bounds),
+          m_bounding_sphere(bounding_sphere)
       { }
 
       /**
@@ -81,12 +124,32 @@ namespace lineage
         return m_draw_mode;
       }
 
+      /**
+       * The index of the geometry pool page containing this mesh. Meshes on the same page share
+       * their vertex and index buffers.
+       */
+      size_t page_index() const
+      {
+        return m_range.source->index;
+      }
+
       /**
        * The buffer containing the vertex data for this mesh.
+       *
+       * @note
+       * This buffer is shared with other meshes. Vertices for this mesh begin at `base_vertex()`.
        */
       const lineage::buffer& vertex_buffer() const
       {
-        return m_vertex_buffer;
+        return m_range.source->vertex_buffer;
+      }
+
+      /**
+       * The index of the first vertex of this mesh in the vertex buffer.
+       */
+      size_t base_vertex() const
+      {
+        return m_range.base_vertex;
       }
 
       /**
@@ -107,10 +170,29 @@ namespace lineage
 
       /**
        * The buffer containing the index data for this mesh.
+       *
+       * @note
+       * This buffer is shared with other meshes. Indices for this mesh begin at `first_index()`.
        */
       const lineage::buffer& index_buffer() const
       {
-        return m_index_buffer;
+        return m_range.source->index_buffer;
+      }
+
+      /**
+       * The position of the first index of this mesh in the index buffer.
+       */
+      size_t first_index() const
+      {
+        return m_range.first_index;
+      }
+
+      /**
+       * The offset of the first index of this mesh in the index buffer, in bytes.
+       */
+      size_t index_offset() const
+      {
+        return m_range.first_index * sizeof(index_type);
       }
 
       /**
@@ -148,15 +230,55 @@ namespace lineage
         return GL_UNSIGNED_INT;
       }
 
+      /**
+       * The bounding box of this mesh, in model space.
+       */
+      const lineage::bounding_box& bounds() const
+      {
+        return m_bounds;
+      }
+
+      /**
+       * The bounding sphere of this mesh, in model space.
+       */
+      const lineage::bounding_sphere& bounding_sphere() const
+      {
+        return m_bounding_sphere;
+      }
+
+      /** Computes the bounding box of the specified vertices. */
+      static lineage::bounding_box compute_bounds(const TVertex* vertices, size_t vertex_count)
+      {
+        auto box = lineage::empty_bounding_box();
+        for (size_t index = 0; index < vertex_count; index++)
+          lineage::expand(box, glm::vec3(vertices[index].position));
+        return box;
+      }
+
+      /** Computes a bounding sphere of the specified vertices, centered on their bounding box. */
+      static lineage::bounding_sphere compute_bounding_sphere(const TVertex* vertices,
+                                                              size_t vertex_count,
+                                                              const lineage::bounding_box& box)
+      {
+        lineage::bounding_sphere sphere = { lineage::center(box), 0.0f };
+        for (size_t index = 0; index < vertex_count; index++)
+        {
+          sphere.radius = glm::max(sphere.radius,
+                                   glm::distance(sphere.center, glm::vec3(vertices[index].position)));
+        }
+        return sphere;
+      }
+
       /* -- Implementation -- */
 
     private:
 
       const GLenum m_draw_mode;
-      const lineage::immutable_buffer m_vertex_buffer;
+      const typename pool_type::range m_range;
       const size_t m_vertex_count;
-      const lineage::immutable_buffer m_index_buffer;
       const size_t m_index_count;
+      const lineage::bounding_box m_bounds;
+      const lineage::bounding_sphere m_bounding_sphere;
 
     };
 
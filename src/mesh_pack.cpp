@@ -0,0 +1,347 @@
+/**
+ * @file	mesh_pack.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "api.hpp"
+#include "bounds.hpp"
+#include "geometry_pool.hpp"
+#include "mesh.hpp"
+#include "mesh_pack.hpp"
+#include "util.hpp"
+#include "vertex.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std::string_literals;
+using namespace lineage;
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** The header at the start of a mesh pack. */
+  struct pack_header
+  {
+    char magic[4];			/**< The magic bytes identifying the file. */
+    uint32_t version;			/**< The version of the format. */
+    uint32_t vertex_size;		/**< The size of each vertex, in bytes. */
+    uint32_t position_offset;		/**< The offset of the position in each vertex. */
+    uint32_t normal_offset;		/**< The offset of the normal in each vertex. */
+    uint32_t color_offset;		/**< The offset of the color in each vertex. */
+    uint32_t texture_offset;		/**< The offset of the texture coordinate in each vertex. */
+    uint32_t index_size;		/**< The size of each index, in bytes. */
+    uint64_t mesh_count;		/**< The number of entries in the mesh table. */
+    uint64_t mesh_table_offset;		/**< The offset of the mesh table in the file. */
+    uint64_t vertex_count;		/**< The number of vertices in the vertex blob. */
+    uint64_t vertex_data_offset;	/**< The offset of the vertex blob in the file. */
+    uint64_t index_count;		/**< The number of indices in the index blob. */
+    uint64_t index_data_offset;		/**< The offset of the index blob in the file. */
+  };
+
+  /** An entry in the mesh table of a mesh pack. */
+  struct pack_mesh
+  {
+    uint32_t draw_mode;			/**< The OpenGL draw mode for the mesh. */
+    uint32_t reserved;			/**< Unused, and always zero. */
+    uint64_t first_vertex;		/**< The index of the mesh's first vertex in the vertex blob. */
+    uint64_t vertex_count;		/**< The number of vertices in the mesh. */
+    uint64_t first_index;		/**< The index of the mesh's first index in the index blob. */
+    uint64_t index_count;		/**< The number of indices in the mesh. */
+    float bounds_min[3];		/**< The minimum corner of the mesh's bounding box. */
+    float bounds_max[3];		/**< The maximum corner of the mesh's bounding box. */
+    float sphere_center[3];		/**< The center of the mesh's bounding sphere. */
+    float sphere_radius;		/**< The radius of the mesh's bounding sphere. */
+  };
+
+  static_assert(sizeof(pack_header) == 80, "Unexpected padding in mesh pack header!");
+  static_assert(sizeof(pack_mesh) == 80, "Unexpected padding in mesh pack table entry!");
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the specified offset, rounded up to the alignment of the vertex and index blobs. */
+  uint64_t align_blob(uint64_t offset)
+  {
+    return ((offset + mesh_pack::blob_alignment - 1) / mesh_pack::blob_alignment) * mesh_pack::blob_alignment;
+  }
+
+  /** Returns a header describing the layout of `lineage::vertex` and `GLuint` indices. */
+  pack_header native_header()
+  {
+    pack_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, mesh_pack::file_magic, sizeof(header.magic));
+    header.version = mesh_pack::file_version;
+    header.vertex_size = sizeof(vertex);
+    header.position_offset = offsetof(vertex, position);
+    header.normal_offset = offsetof(vertex, normal);
+    header.color_offset = offsetof(vertex, color);
+    header.texture_offset = offsetof(vertex, texture);
+    header.index_size = sizeof(GLuint);
+    return header;
+  }
+
+  /** Stores a vector in an array of three floats. */
+  void store_vec3(const glm::vec3& value, float* values)
+  {
+    values[0] = value.x;
+    values[1] = value.y;
+    values[2] = value.z;
+  }
+
+  /** Loads a vector from an array of three floats. */
+  glm::vec3 load_vec3(const float* values)
+  {
+    return glm::vec3(values[0], values[1], values[2]);
+  }
+
+  /** Returns `true` if `count` elements of `size` bytes at `offset` lie within a file of `file_size` bytes. */
+  bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size)
+  {
+    return (offset <= file_size && count <= (file_size - offset) / size);
+  }
+
+}
+
+/* -- Variables -- */
+
+const char mesh_pack::file_magic[4] = { 'L', 'N', 'M', 'P' };
+const uint32_t mesh_pack::file_version;
+const size_t mesh_pack::blob_alignment;
+
+/**
+ * Implementation for the `lineage::mesh_pack` class.
+ */
+struct mesh_pack::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation()
+    : data(nullptr),
+      size(0)
+  { }
+
+  /* -- Fields -- */
+
+  const uint8_t* data;
+  size_t size;
+
+  /* -- Procedures -- */
+
+  /** The header at the start of the mapped file. */
+  const pack_header& header() const
+  {
+    return *reinterpret_cast<const pack_header*>(data);
+  }
+
+  /** The mesh table in the mapped file. */
+  const pack_mesh* meshes() const
+  {
+    return reinterpret_cast<const pack_mesh*>(data + header().mesh_table_offset);
+  }
+
+  /** Checks that the mapped file is a valid mesh pack with the native layout. */
+  void validate(const std::string& path) const
+  {
+    const pack_header expected = native_header();
+    if (size < sizeof(pack_header) || std::memcmp(header().magic, expected.magic, sizeof(expected.magic)) != 0)
+      throw std::runtime_error("Not a mesh pack: "s + path);
+    if (header().version != expected.version)
+      throw std::runtime_error("Unsupported mesh pack version: "s + path);
+
+    // the blobs are uploaded as-is, so their layout must exactly match the one used for rendering
+    if (header().vertex_size != expected.vertex_size ||
+        header().position_offset != expected.position_offset ||
+        header().normal_offset != expected.normal_offset ||
+        header().color_offset != expected.color_offset ||
+        header().texture_offset != expected.texture_offset ||
+        header().index_size != expected.index_size)
+      throw std::runtime_error("Mesh pack has an incompatible vertex layout: "s + path);
+
+    // the blobs are uploaded to immutable buffers, which can't be empty
+    if (header().mesh_count == 0 || header().vertex_count == 0 || header().index_count == 0)
+      throw std::runtime_error("Mesh pack is empty: "s + path);
+
+    if (!fits(header().mesh_table_offset, header().mesh_count, sizeof(pack_mesh), size) ||
+        !fits(header().vertex_data_offset, header().vertex_count, sizeof(vertex), size) ||
+        !fits(header().index_data_offset, header().index_count, sizeof(GLuint), size) ||
+        header().mesh_table_offset % alignof(pack_mesh) != 0 ||
+        header().vertex_data_offset % blob_alignment != 0 ||
+        header().index_data_offset % blob_alignment != 0)
+      throw std::runtime_error("Mesh pack is truncated or corrupt: "s + path);
+
+    for (size_t index = 0; index < header().mesh_count; index++)
+    {
+      const pack_mesh& entry = meshes()[index];
+      if (entry.first_vertex > header().vertex_count ||
+          entry.vertex_count > header().vertex_count - entry.first_vertex ||
+          entry.first_index > header().index_count ||
+          entry.index_count > header().index_count - entry.first_index)
+        throw std::runtime_error("Mesh pack is truncated or corrupt: "s + path);
+    }
+  }
+
+};
+
+/* -- Procedures -- */
+
+mesh_pack::mesh_pack(const std::string& path)
+  : impl(std::make_unique<implementation>())
+{
+  const int file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0)
+    throw std::runtime_error("Failed to open mesh pack "s + path);
+  defer close_file([&] { ::close(file); });
+
+  struct stat status;
+  if (::fstat(file, &status) != 0 || status.st_size <= 0)
+    throw std::runtime_error("Failed to read mesh pack "s + path);
+
+  // the mapping stays valid after the file is closed
+  void* mapping = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Failed to map mesh pack "s + path);
+  impl->data = static_cast<const uint8_t*>(mapping);
+  impl->size = static_cast<size_t>(status.st_size);
+
+  try
+  {
+    impl->validate(path);
+  }
+  catch (...)
+  {
+    ::munmap(mapping, impl->size);
+    throw;
+  }
+
+  // everything will be read exactly once, from front to back, so start reading it in now
+  ::madvise(mapping, impl->size, MADV_SEQUENTIAL);
+  ::madvise(mapping, impl->size, MADV_WILLNEED);
+}
+
+mesh_pack::~mesh_pack()
+{
+  ::munmap(const_cast<uint8_t*>(impl->data), impl->size);
+}
+
+void mesh_pack::write(const std::string& path, const std::vector<mesh_pack_source>& meshes)
+{
+  pack_header header = native_header();
+  std::vector<pack_mesh> table(meshes.size());
+  for (size_t index = 0; index < meshes.size(); index++)
+  {
+    const auto& source = meshes[index];
+    const auto box = mesh::compute_bounds(source.vertices.data(), source.vertices.size());
+    const auto sphere = mesh::compute_bounding_sphere(source.vertices.data(), source.vertices.size(), box);
+
+    pack_mesh& entry = table[index];
+    std::memset(&entry, 0, sizeof(entry));
+    entry.draw_mode = source.draw_mode;
+    entry.first_vertex = header.vertex_count;
+    entry.vertex_count = source.vertices.size();
+    entry.first_index = header.index_count;
+    entry.index_count = source.indices.size();
+    store_vec3(box.min, entry.bounds_min);
+    store_vec3(box.max, entry.bounds_max);
+    store_vec3(sphere.center, entry.sphere_center);
+    entry.sphere_radius = sphere.radius;
+
+    header.vertex_count += source.vertices.size();
+    header.index_count += source.indices.size();
+  }
+
+  header.mesh_count = meshes.size();
+  header.mesh_table_offset = sizeof(pack_header);
+  header.vertex_data_offset = align_blob(header.mesh_table_offset + (table.size() * sizeof(pack_mesh)));
+  header.index_data_offset = align_blob(header.vertex_data_offset + (header.vertex_count * sizeof(vertex)));
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  auto write_bytes = [&] (const void* bytes, size_t count) {
+    file.write(static_cast<const char*>(bytes), count);
+  };
+  auto pad_to = [&] (uint64_t offset) {
+    static const char ZEROES[blob_alignment] = { };
+    if (!file)
+      return;
+    write_bytes(ZEROES, offset - static_cast<uint64_t>(file.tellp()));
+  };
+
+  write_bytes(&header, sizeof(header));
+  write_bytes(table.data(), table.size() * sizeof(pack_mesh));
+  pad_to(header.vertex_data_offset);
+  for (const auto& source : meshes)
+    write_bytes(source.vertices.data(), source.vertices.size() * sizeof(vertex));
+  pad_to(header.index_data_offset);
+  for (const auto& source : meshes)
+    write_bytes(source.indices.data(), source.indices.size() * sizeof(GLuint));
+
+  if (!file)
+    throw std::runtime_error("Failed to write mesh pack "s + path);
+}
+
+size_t mesh_pack::mesh_count() const
+{
+  return impl->header().mesh_count;
+}
+
+size_t mesh_pack::vertex_count() const
+{
+  return impl->header().vertex_count;
+}
+
+size_t mesh_pack::index_count() const
+{
+  return impl->header().index_count;
+}
+
+void mesh_pack::load(geometry_pool& pool, std::vector<std::unique_ptr<mesh>>* meshes) const
+{
+  const auto& header = impl->header();
+  const auto vertices = reinterpret_cast<const vertex*>(impl->data + header.vertex_data_offset);
+  const auto indices = reinterpret_cast<const GLuint*>(impl->data + header.index_data_offset);
+
+  // the whole pack becomes a single page, which is filled by one upload per blob straight from
+  // the mapped file
+  const geometry_pool::range page = pool.add_page(vertices, header.vertex_count, indices, header.index_count);
+
+  meshes->reserve(meshes->size() + header.mesh_count);
+  for (size_t index = 0; index < header.mesh_count; index++)
+  {
+    const pack_mesh& entry = impl->meshes()[index];
+
+    geometry_pool::range range = page;
+    range.base_vertex += entry.first_vertex;
+    range.first_index += entry.first_index;
+
+    const bounding_box box = { load_vec3(entry.bounds_min), load_vec3(entry.bounds_max) };
+    const bounding_sphere sphere = { load_vec3(entry.sphere_center), entry.sphere_radius };
+
+    meshes->push_back(std::make_unique<mesh>(range, entry.draw_mode, entry.vertex_count, entry.index_count, box, sphere));
+  }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file	mesh_pack.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api.hpp"
+#include "geometry_pool.hpp"
+#include "mesh.hpp"
+#include "vertex.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Struct containing the data for a single mesh to write to a mesh pack.
+   */
+  struct mesh_pack_source
+  {
+    GLenum draw_mode;			/**< The OpenGL draw mode for the mesh. */
+    std::vector<lineage::vertex> vertices;	/**< The vertices of the mesh. */
+    std::vector<GLuint> indices;	/**< The indices of the mesh, relative to its first vertex. */
+  };
+
+  /**
+   * Class representing a memory-mapped mesh pack file.
+   *
+   * @note
+   * A mesh pack stores the geometry for many meshes in exactly the layout used on the GPU, so that
+   * it can be uploaded without being parsed or copied. The file starts with a header describing
+   * the vertex layout and index type, followed by a table with the draw mode, vertex and index
+   * ranges, and bounds of each mesh. The vertices and indices of every mesh follow in two
+   * contiguous blobs, each aligned to `mesh_pack::blob_alignment` bytes. All values are stored in
+   * the native byte order.
+   *
+   * Loading maps the file, checks that its layout matches `lineage::vertex`, and creates a single
+   * geometry pool page whose buffers are initialized straight from the mapped blobs.
+   */
+  class mesh_pack
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The magic bytes at the start of every mesh pack. */
+    static const char file_magic[4];
+
+    /** The version of the mesh pack format read and written by this class. */
+    static const uint32_t file_version = 1;
+
+    /** The alignment of the vertex and index blobs within the file, in bytes. */
+    static const size_t blob_alignment = 4096;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Maps the specified mesh pack into memory, and validates its contents.
+     *
+     * @exception std::runtime_error
+     * Thrown if the file cannot be mapped, is not a valid mesh pack for `lineage::vertex`, or has
+     * no meshes, vertices, or indices.
+     */
+    mesh_pack(const std::string& path);
+
+    /**
+     * Destructor. Unmaps the file.
+     */
+    ~mesh_pack();
+
+  private:
+
+    mesh_pack(const lineage::mesh_pack&) = delete;
+    mesh_pack(lineage::mesh_pack&&) = delete;
+    lineage::mesh_pack& operator =(const lineage::mesh_pack&) = delete;
+    lineage::mesh_pack& operator =(lineage::mesh_pack&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Writes the specified meshes to a mesh pack file.
+     *
+     * @exception std::runtime_error
+     * Thrown if the file cannot be written.
+     */
+    static void write(const std::string& path, const std::vector<lineage::mesh_pack_source>& meshes);
+
+    /**
+     * The number of meshes in the pack.
+     */
+    size_t mesh_count() const;
+
+    /**
+     * The total number of vertices in the pack.
+     */
+    size_t vertex_count() const;
+
+    /**
+     * The total number of indices in the pack.
+     */
+    size_t index_count() const;
+
+    /**
+     * Uploads every mesh in the pack to a new page of `pool`, and appends the meshes to `meshes`
+     * in the order in which they were written.
+     */
+    void load(lineage::geometry_pool& pool, std::vector<std::unique_ptr<lineage::mesh>>* meshes) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,568 @@
+/**
+ * @file	mesh_simplifier.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "api.hpp"
+#include "geometry_pool.hpp"
+#include "mesh.hpp"
+#include "mesh_simplifier.hpp"
+#include "vertex.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // Weight of the planes which keep open boundaries in place, relative to the surface planes
+  const double BOUNDARY_WEIGHT = 100.0;
+
+  // Determinant below which the optimal collapse position is considered unsolvable
+  const double SINGULAR_DETERMINANT = 1e-12;
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** A point in double precision. */
+  using point = std::array<double, 3>;
+
+  /** A symmetric 4x4 matrix measuring the squared distance of a point to a set of planes. */
+  struct quadric
+  {
+    double a00, a01, a02, a03;
+    double a11, a12, a13;
+    double a22, a23;
+    double a33;
+  };
+
+  /** A candidate edge collapse. */
+  struct collapse
+  {
+    double cost;		/**< The error introduced by the collapse. */
+    uint32_t kept;		/**< The vertex which is kept. */
+    uint32_t removed;		/**< The vertex which is merged into `kept`. */
+    uint32_t kept_stamp;	/**< The stamp of `kept` when this collapse was evaluated. */
+    uint32_t removed_stamp;	/**< The stamp of `removed` when this collapse was evaluated. */
+    point target;		/**< The position of the merged vertex. */
+
+    bool operator >(const collapse& other) const
+    {
+      return (cost > other.cost);
+    }
+  };
+
+  /** Key used to weld vertices with bitwise identical positions. */
+  struct position_key
+  {
+    float x, y, z;
+
+    bool operator ==(const position_key& other) const
+    {
+      return (std::memcmp(this, &other, sizeof(position_key)) == 0);
+    }
+  };
+
+  /** Hash for `position_key`. */
+  struct position_key_hash
+  {
+    size_t operator()(const position_key& key) const
+    {
+      uint32_t bits[3];
+      std::memcpy(bits, &key, sizeof(bits));
+      size_t hash = 2166136261u;
+      for (auto value : bits)
+        hash = (hash ^ value) * 16777619u;
+      return hash;
+    }
+  };
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  point subtract(const point& a, const point& b)
+  {
+    return { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+  }
+
+  point cross(const point& a, const point& b)
+  {
+    return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+  }
+
+  double dot(const point& a, const point& b)
+  {
+    return (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+  }
+
+  /** Returns the quadric for the plane `n.p + d = 0`, scaled by `weight`. */
+  quadric plane_quadric(const point& n, double d, double weight)
+  {
+    return
+    {
+      weight * n[0] * n[0], weight * n[0] * n[1], weight * n[0] * n[2], weight * n[0] * d,
+      weight * n[1] * n[1], weight * n[1] * n[2], weight * n[1] * d,
+      weight * n[2] * n[2], weight * n[2] * d,
+      weight * d * d,
+    };
+  }
+
+  void add(quadric& q, const quadric& other)
+  {
+    q.a00 += other.a00; q.a01 += other.a01; q.a02 += other.a02; q.a03 += other.a03;
+    q.a11 += other.a11; q.a12 += other.a12; q.a13 += other.a13;
+    q.a22 += other.a22; q.a23 += other.a23;
+    q.a33 += other.a33;
+  }
+
+  /** Returns the error of moving a vertex with quadric `q` to `p`. */
+  double evaluate(const quadric& q, const point& p)
+  {
+    const double x = p[0], y = p[1], z = p[2];
+    return
+      q.a00 * x * x + 2.0 * q.a01 * x * y + 2.0 * q.a02 * x * z + 2.0 * q.a03 * x +
+      q.a11 * y * y + 2.0 * q.a12 * y * z + 2.0 * q.a13 * y +
+      q.a22 * z * z + 2.0 * q.a23 * z +
+      q.a33;
+  }
+
+  /** Finds the point minimizing `q`, if the system is well conditioned. */
+  bool optimal_position(const quadric& q, point* result)
+  {
+    // solve the 3x3 system by Cramer's rule
+    const double det =
+      q.a00 * (q.a11 * q.a22 - q.a12 * q.a12) -
+      q.a01 * (q.a01 * q.a22 - q.a12 * q.a02) +
+      q.a02 * (q.a01 * q.a12 - q.a11 * q.a02);
+    if (std::abs(det) < SINGULAR_DETERMINANT)
+      return false;
+
+    const double bx = -q.a03, by = -q.a13, bz = -q.a23;
+    (*result)[0] = (bx * (q.a11 * q.a22 - q.a12 * q.a12) -
+                    q.a01 * (by * q.a22 - q.a12 * bz) +
+                    q.a02 * (by * q.a12 - q.a11 * bz)) / det;
+    (*result)[1] = (q.a00 * (by * q.a22 - q.a12 * bz) -
+                    bx * (q.a01 * q.a22 - q.a12 * q.a02) +
+                    q.a02 * (q.a01 * bz - by * q.a02)) / det;
+    (*result)[2] = (q.a00 * (q.a11 * bz - by * q.a12) -
+                    q.a01 * (q.a01 * bz - by * q.a02) +
+                    bx * (q.a01 * q.a12 - q.a11 * q.a02)) / det;
+    return true;
+  }
+
+  /** Converts a triangle strip or fan to a triangle list. */
+  std::vector<GLuint> triangle_list(GLenum draw_mode, const std::vector<GLuint>& indices)
+  {
+    if (draw_mode == GL_TRIANGLES)
+      return indices;
+
+    std::vector<GLuint> result;
+    for (size_t index = 2; index < indices.size(); index++)
+    {
+      if (draw_mode == GL_TRIANGLE_FAN)
+        result.insert(result.end(), { indices[0], indices[index - 1], indices[index] });
+      else if (index % 2 == 0)
+        result.insert(result.end(), { indices[index - 2], indices[index - 1], indices[index] });
+      else
+        result.insert(result.end(), { indices[index - 1], indices[index - 2], indices[index] });
+    }
+    return result;
+  }
+
+  /** The simplifier's working state. */
+  class simplifier
+  {
+  public:
+
+    simplifier(const std::vector<vertex>& vertices, const std::vector<GLuint>& indices)
+    {
+      weld(vertices, indices);
+      compute_quadrics();
+    }
+
+    void run(size_t target_triangle_count)
+    {
+      std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> heap;
+      for (const auto& edge : m_edges)
+        heap.push(evaluate_collapse(edge.first, edge.second));
+
+      while (m_alive_triangles > target_triangle_count && !heap.empty())
+      {
+        const collapse candidate = heap.top();
+        heap.pop();
+
+        // skip collapses made stale by earlier collapses
+        if (m_removed[candidate.kept] || m_removed[candidate.removed] ||
+            m_stamps[candidate.kept] != candidate.kept_stamp ||
+            m_stamps[candidate.removed] != candidate.removed_stamp)
+          continue;
+
+        if (causes_fold(candidate.kept, candidate.removed, candidate.target) ||
+            causes_fold(candidate.removed, candidate.kept, candidate.target))
+          continue;
+
+        apply(candidate);
+
+        // re-evaluate every edge around the merged vertex
+        for (const auto& neighbor : neighbors(candidate.kept))
+          heap.push(evaluate_collapse(candidate.kept, neighbor));
+      }
+    }
+
+    void output(std::vector<vertex>* vertices, std::vector<GLuint>* indices) const
+    {
+      std::vector<GLuint> remap(m_vertices.size(), 0);
+      std::vector<bool> used(m_vertices.size(), false);
+      vertices->clear();
+      indices->clear();
+
+      for (size_t triangle = 0; triangle < m_triangles.size(); triangle++)
+      {
+        if (!m_alive[triangle])
+          continue;
+        for (auto corner : m_triangles[triangle])
+        {
+          if (!used[corner])
+          {
+            used[corner] = true;
+            remap[corner] = static_cast<GLuint>(vertices->size());
+            vertex result = m_vertices[corner];
+            result.position = glm::vec3(static_cast<float>(m_positions[corner][0]),
+                                        static_cast<float>(m_positions[corner][1]),
+                                        static_cast<float>(m_positions[corner][2]));
+            vertices->push_back(result);
+          }
+          indices->push_back(remap[corner]);
+        }
+      }
+    }
+
+    size_t triangle_count() const
+    {
+      return m_alive_triangles;
+    }
+
+  private:
+
+    /** Welds vertices with identical positions, and drops degenerate triangles. */
+    void weld(const std::vector<vertex>& vertices, const std::vector<GLuint>& indices)
+    {
+      std::unordered_map<position_key, uint32_t, position_key_hash> welded;
+      std::vector<uint32_t> remap(vertices.size());
+      std::vector<point> normals;
+
+      for (size_t index = 0; index < vertices.size(); index++)
+      {
+        const auto& source = vertices[index];
+        const position_key key { source.position.x, source.position.y, source.position.z };
+        auto it = welded.find(key);
+        if (it == welded.end())
+        {
+          it = welded.emplace(key, static_cast<uint32_t>(m_vertices.size())).first;
+          m_vertices.push_back(source);
+          m_positions.push_back({ source.position.x, source.position.y, source.position.z });
+          normals.push_back({ 0.0, 0.0, 0.0 });
+        }
+        remap[index] = it->second;
+
+        auto& normal = normals[it->second];
+        normal[0] += source.normal.x;
+        normal[1] += source.normal.y;
+        normal[2] += source.normal.z;
+      }
+
+      for (size_t index = 0; index < m_vertices.size(); index++)
+      {
+        const double length = std::sqrt(dot(normals[index], normals[index]));
+        if (length > 0.0)
+        {
+          m_vertices[index].normal = glm::vec3(static_cast<float>(normals[index][0] / length),
+                                               static_cast<float>(normals[index][1] / length),
+                                               static_cast<float>(normals[index][2] / length));
+        }
+      }
+
+      m_vertex_triangles.resize(m_vertices.size());
+      for (size_t index = 0; index + 2 < indices.size(); index += 3)
+      {
+        const std::array<uint32_t, 3> triangle { remap[indices[index]],
+                                                 remap[indices[index + 1]],
+                                                 remap[indices[index + 2]] };
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+          continue;
+
+        const auto triangle_index = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(triangle);
+        m_alive.push_back(true);
+        for (auto corner : triangle)
+          m_vertex_triangles[corner].push_back(triangle_index);
+      }
+
+      m_alive_triangles = m_triangles.size();
+      m_removed.assign(m_vertices.size(), false);
+      m_stamps.assign(m_vertices.size(), 0);
+    }
+
+    /** Accumulates the plane of each triangle, and of each boundary edge, into its vertices. */
+    void compute_quadrics()
+    {
+      m_quadrics.assign(m_vertices.size(), quadric());
+
+      std::unordered_map<uint64_t, uint32_t> edge_use;
+      auto edge_key = [] (uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+      };
+
+      for (const auto& triangle : m_triangles)
+      {
+        const point normal = triangle_normal(triangle[0], triangle[1], triangle[2]);
+        const double length = std::sqrt(dot(normal, normal));
+        if (length <= 0.0)
+          continue;
+
+        // weight each plane by the triangle's area, so tiny triangles don't dominate
+        const point unit = { normal[0] / length, normal[1] / length, normal[2] / length };
+        const quadric q = plane_quadric(unit, -dot(unit, m_positions[triangle[0]]), 0.5 * length);
+        for (auto corner : triangle)
+          add(m_quadrics[corner], q);
+
+        for (size_t edge = 0; edge < 3; edge++)
+          edge_use[edge_key(triangle[edge], triangle[(edge + 1) % 3])]++;
+      }
+
+      for (const auto& triangle : m_triangles)
+      {
+        const point normal = triangle_normal(triangle[0], triangle[1], triangle[2]);
+        for (size_t edge = 0; edge < 3; edge++)
+        {
+          const uint32_t a = triangle[edge];
+          const uint32_t b = triangle[(edge + 1) % 3];
+          if (edge_use[edge_key(a, b)] != 1)
+            continue;
+
+          // constrain open boundaries with a plane through the edge, perpendicular to the face
+          const point direction = subtract(m_positions[b], m_positions[a]);
+          point perpendicular = cross(direction, normal);
+          const double length = std::sqrt(dot(perpendicular, perpendicular));
+          if (length <= 0.0)
+            continue;
+          perpendicular = { perpendicular[0] / length, perpendicular[1] / length, perpendicular[2] / length };
+
+          const quadric q = plane_quadric(perpendicular,
+                                          -dot(perpendicular, m_positions[a]),
+                                          BOUNDARY_WEIGHT * dot(direction, direction));
+          add(m_quadrics[a], q);
+          add(m_quadrics[b], q);
+        }
+      }
+
+      for (const auto& entry : edge_use)
+        m_edges.emplace_back(static_cast<uint32_t>(entry.first >> 32), static_cast<uint32_t>(entry.first));
+    }
+
+    /** Returns the unnormalized normal of a triangle. */
+    point triangle_normal(uint32_t a, uint32_t b, uint32_t c) const
+    {
+      return cross(subtract(m_positions[b], m_positions[a]), subtract(m_positions[c], m_positions[a]));
+    }
+
+    /** Evaluates the cost and position of merging two vertices. */
+    collapse evaluate_collapse(uint32_t a, uint32_t b) const
+    {
+      quadric q = m_quadrics[a];
+      add(q, m_quadrics[b]);
+
+      collapse result;
+      result.kept = a;
+      result.removed = b;
+      result.kept_stamp = m_stamps[a];
+      result.removed_stamp = m_stamps[b];
+
+      if (optimal_position(q, &result.target))
+      {
+        result.cost = evaluate(q, result.target);
+      }
+      else
+      {
+        // fall back to the best of the endpoints and the midpoint
+        const point midpoint = { (m_positions[a][0] + m_positions[b][0]) * 0.5,
+                                 (m_positions[a][1] + m_positions[b][1]) * 0.5,
+                                 (m_positions[a][2] + m_positions[b][2]) * 0.5 };
+        const point candidates[] = { m_positions[a], m_positions[b], midpoint };
+        result.cost = std::numeric_limits<double>::max();
+        for (const auto& candidate : candidates)
+        {
+          const double cost = evaluate(q, candidate);
+          if (cost < result.cost)
+          {
+            result.cost = cost;
+            result.target = candidate;
+          }
+        }
+      }
+
+      result.cost = std::max(result.cost, 0.0);
+      return result;
+    }
+
+    /** Returns `true` if moving `moved` to `target` would flip any triangle not shared with `other`. */
+    bool causes_fold(uint32_t moved, uint32_t other, const point& target) const
+    {
+      for (auto triangle_index : m_vertex_triangles[moved])
+      {
+        if (!m_alive[triangle_index])
+          continue;
+
+        const auto& triangle = m_triangles[triangle_index];
+        if (std::find(triangle.begin(), triangle.end(), other) != triangle.end())
+          continue;
+
+        point corners[3];
+        for (size_t corner = 0; corner < 3; corner++)
+          corners[corner] = m_positions[triangle[corner]];
+        const point before = cross(subtract(corners[1], corners[0]), subtract(corners[2], corners[0]));
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+          if (triangle[corner] == moved)
+            corners[corner] = target;
+        }
+        const point after = cross(subtract(corners[1], corners[0]), subtract(corners[2], corners[0]));
+
+        if (dot(before, after) <= 0.0)
+          return true;
+      }
+      return false;
+    }
+
+    /** Merges the removed vertex of a collapse into the kept vertex. */
+    void apply(const collapse& candidate)
+    {
+      const uint32_t kept = candidate.kept;
+      const uint32_t removed = candidate.removed;
+
+      m_positions[kept] = candidate.target;
+      add(m_quadrics[kept], m_quadrics[removed]);
+      m_removed[removed] = true;
+      m_stamps[kept]++;
+
+      for (auto triangle_index : m_vertex_triangles[removed])
+      {
+        if (!m_alive[triangle_index])
+          continue;
+
+        auto& triangle = m_triangles[triangle_index];
+        if (std::find(triangle.begin(), triangle.end(), kept) != triangle.end())
+        {
+          // this triangle contained the collapsed edge, so it has degenerated
+          m_alive[triangle_index] = false;
+          m_alive_triangles--;
+          continue;
+        }
+
+        std::replace(triangle.begin(), triangle.end(), removed, kept);
+        m_vertex_triangles[kept].push_back(triangle_index);
+      }
+      m_vertex_triangles[removed].clear();
+
+      // drop dead triangles from the kept vertex's list, so it doesn't grow without bound
+      auto& kept_triangles = m_vertex_triangles[kept];
+      kept_triangles.erase(std::remove_if(kept_triangles.begin(),
+                                          kept_triangles.end(),
+                                          [&] (uint32_t triangle_index) { return !m_alive[triangle_index]; }),
+                           kept_triangles.end());
+    }
+
+    /** Returns the vertices sharing a live triangle with the specified vertex. */
+    std::vector<uint32_t> neighbors(uint32_t vertex_index) const
+    {
+      std::vector<uint32_t> result;
+      for (auto triangle_index : m_vertex_triangles[vertex_index])
+      {
+        for (auto corner : m_triangles[triangle_index])
+        {
+          if (corner != vertex_index && std::find(result.begin(), result.end(), corner) == result.end())
+            result.push_back(corner);
+        }
+      }
+      return result;
+    }
+
+    std::vector<vertex> m_vertices;
+    std::vector<point> m_positions;
+    std::vector<quadric> m_quadrics;
+    std::vector<bool> m_removed;
+    std::vector<uint32_t> m_stamps;
+    std::vector<std::array<uint32_t, 3>> m_triangles;
+    std::vector<bool> m_alive;
+    std::vector<std::vector<uint32_t>> m_vertex_triangles;
+    std::vector<std::pair<uint32_t, uint32_t>> m_edges;
+    size_t m_alive_triangles;
+
+  };
+
+}
+
+/* -- Procedures -- */
+
+void lineage::simplify(const std::vector<vertex>& vertices,
+                       const std::vector<GLuint>& indices,
+                       size_t target_triangle_count,
+                       std::vector<vertex>* simplified_vertices,
+                       std::vector<GLuint>* simplified_indices)
+{
+  simplifier state(vertices, indices);
+  state.run(target_triangle_count);
+  state.output(simplified_vertices, simplified_indices);
+}
+
+std::unique_ptr<mesh> lineage::simplify(const mesh& source, geometry_pool& pool, float ratio)
+{
+  const GLenum draw_mode = source.draw_mode();
+  if (draw_mode != GL_TRIANGLES && draw_mode != GL_TRIANGLE_STRIP && draw_mode != GL_TRIANGLE_FAN)
+    throw std::invalid_argument("Only triangle meshes can be simplified!");
+
+  // read the source data back out of its pooled buffers
+  std::vector<vertex> vertices(source.vertex_count());
+  source.vertex_buffer().get_data(source.base_vertex() * source.vertex_size(),
+                                  vertices.size() * sizeof(vertex),
+                                  vertices.data());
+  std::vector<GLuint> indices(source.index_count());
+  source.index_buffer().get_data(source.index_offset(),
+                                 indices.size() * sizeof(GLuint),
+                                 indices.data());
+  indices = triangle_list(draw_mode, indices);
+
+  const auto target = std::max<size_t>(static_cast<size_t>(static_cast<float>(indices.size() / 3) * ratio), 1);
+  std::vector<vertex> simplified_vertices;
+  std::vector<GLuint> simplified_indices;
+  simplify(vertices, indices, target, &simplified_vertices, &simplified_indices);
+
+  return std::make_unique<mesh>(pool, GL_TRIANGLES, simplified_vertices, simplified_indices);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file	mesh_simplifier.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "api.hpp"
+#include "geometry_pool.hpp"
+#include "mesh.hpp"
+#include "vertex.hpp"
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /**
+   * Simplifies a triangle list using quadric error metric edge collapses.
+   *
+   * @param vertices
+   * The vertices of the mesh.
+   *
+   * @param indices
+   * The indices of the mesh, three per triangle.
+   *
+   * @param target_triangle_count
+   * The number of triangles to reduce the mesh to. The result may have more triangles than this if
+   * the mesh cannot be simplified further without folding over.
+   *
+   * @param simplified_vertices
+   * Receives the vertices of the simplified mesh.
+   *
+   * @param simplified_indices
+   * Receives the indices of the simplified mesh, three per triangle.
+   *
+   * @note
+   * Vertices with identical positions are welded together first, keeping the attributes of the
+   * first occurrence and averaging their normals. Open boundaries are preserved by penalizing
+   * collapses which move them.
+   */
+  void simplify(const std::vector<lineage::vertex>& vertices,
+                const std::vector<GLuint>& indices,
+                size_t target_triangle_count,
+                std::vector<lineage::vertex>* simplified_vertices,
+                std::vector<GLuint>* simplified_indices);
+
+  /**
+   * Creates a simplified copy of a mesh.
+   *
+   * @param source
+   * The mesh to simplify. Its data is read back from its geometry pool. Triangle strips and fans
+   * are converted to triangle lists. Throws `std::invalid_argument` for any other draw mode.
+   *
+   * @param pool
+   * The pool to store the simplified mesh in.
+   *
+   * @param ratio
+   * The fraction of the source mesh's triangles to keep.
+   *
+   * @return
+   * A new `GL_TRIANGLES` mesh.
+   */
+  std::unique_ptr<lineage::mesh> simplify(const lineage::mesh& source,
+                                          lineage::geometry_pool& pool,
+                                          float ratio);
+
+}
@@ -0,0 +1,197 @@
+/**
+ * @file	occlusion_culler.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "api.hpp"
+#include "bounds.hpp"
+#include "flat_scene_graph.hpp"
+#include "frustum.hpp"
+#include "occlusion_culler.hpp"
+#include "query.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // Proxy boxes are inflated so that they are not hidden by the geometry they contain
+  const float PROXY_SCALE = 1.01f;
+  const float PROXY_MARGIN = 0.01f;
+}
+
+/* -- Types -- */
+
+/** State of a single occlusion group. */
+struct occlusion_culler::group_state
+{
+  size_t root;				/**< Index of the root node of the group. */
+  std::unique_ptr<lineage::query> query;	/**< The query for this group. */
+  lineage::bounding_box proxy_bounds;	/**< The inflated bounds of the group. */
+  bool query_pending;			/**< If `true`, the last query's result has not been read. */
+  bool occluded;			/**< The most recently read query result. */
+  bool conditional;			/**< If `true`, the group is drawn conditionally this frame. */
+};
+
+/* -- Variables -- */
+
+const size_t occlusion_culler::no_group;
+const size_t occlusion_culler::min_group_size;
+const size_t occlusion_culler::max_group_size;
+
+/* -- Procedures -- */
+
+occlusion_culler::occlusion_culler()
+  : m_layout_revision(0),
+    m_built(false),
+    m_groups(),
+    m_node_groups(),
+    m_tested_groups(),
+    m_conditional_group_count(0)
+{
+}
+
+occlusion_culler::~occlusion_culler() = default;
+
+void occlusion_culler::update(const flat_scene_graph& graph,
+                              const frustum& frustum,
+                              const glm::vec3& camera_position,
+                              float clip_near)
+{
+  if (!m_built || m_layout_revision != graph.layout_revision())
+    rebuild(graph);
+
+  m_tested_groups.clear();
+  m_conditional_group_count = 0;
+
+  for (size_t index = 0; index < m_groups.size(); index++)
+  {
+    auto& group = m_groups[index];
+
+    // read last frame's result if it's ready - otherwise keep using the previous one, rather than
+    // stalling until the GPU catches up
+    if (group.query_pending && group.query->is_result_available())
+    {
+      group.occluded = (group.query->result() == 0);
+      group.query_pending = false;
+    }
+
+    group.conditional = false;
+
+    const auto& bounds = graph.subtree_bounds(group.root);
+    if (frustum.classify(bounds) == containment::outside)
+      continue;
+
+    // the proxy can't be rasterized if the camera is inside it, so treat the group as visible
+    const glm::vec3 margin = extent(bounds) * (PROXY_SCALE - 1.0f) + glm::vec3(PROXY_MARGIN);
+    group.proxy_bounds = { bounds.min - margin, bounds.max + margin };
+    const glm::vec3 near_margin(clip_near);
+    const bounding_box camera_bounds = { camera_position - near_margin, camera_position + near_margin };
+    if (intersects(camera_bounds, group.proxy_bounds))
+    {
+      group.occluded = false;
+      continue;
+    }
+
+    // occluded groups always need a fresh query to draw against - visible groups only need one if
+    // the last one has been read
+    group.conditional = group.occluded;
+    if (group.conditional || !group.query_pending)
+      m_tested_groups.push_back(index);
+    if (group.conditional)
+      m_conditional_group_count++;
+  }
+}
+
+size_t occlusion_culler::group(size_t node_index) const
+{
+  return m_node_groups[node_index];
+}
+
+bool occlusion_culler::is_conditional(size_t group) const
+{
+  return m_groups[group].conditional;
+}
+
+const std::vector<size_t>& occlusion_culler::tested_groups() const
+{
+  return m_tested_groups;
+}
+
+const bounding_box& occlusion_culler::proxy_bounds(size_t group) const
+{
+  return m_groups[group].proxy_bounds;
+}
+
+query& occlusion_culler::query(size_t group)
+{
+  return *m_groups[group].query;
+}
+
+const query& occlusion_culler::query(size_t group) const
+{
+  return *m_groups[group].query;
+}
+
+void occlusion_culler::set_query_issued(size_t group)
+{
+  m_groups[group].query_pending = true;
+}
+
+size_t occlusion_culler::conditional_group_count() const
+{
+  return m_conditional_group_count;
+}
+
+void occlusion_culler::rebuild(const flat_scene_graph& graph)
+{
+  m_layout_revision = graph.layout_revision();
+  m_built = true;
+  m_node_groups.assign(graph.size(), no_group);
+
+  // group the largest subtrees which are under the size limit - nodes above them, and subtrees too
+  // small to be worth a query, are always drawn
+  size_t group_count = 0;
+  size_t index = 0;
+  while (index < graph.size())
+  {
+    const size_t end = graph.subtree_end(index);
+    const size_t size = end - index;
+    if (size > max_group_size)
+    {
+      index++;
+      continue;
+    }
+
+    if (size >= min_group_size && !is_empty(graph.subtree_bounds(index)))
+    {
+      if (group_count == m_groups.size())
+        m_groups.push_back({ 0, std::make_unique<lineage::query>(GL_ANY_SAMPLES_PASSED), { }, false, false, false });
+
+      // a recycled query may still be pending, so keep its state - only the first result for the
+      // new group will be stale
+      auto& group = m_groups[group_count];
+      group.root = index;
+      group.occluded = false;
+      std::fill(m_node_groups.begin() + index, m_node_groups.begin() + end, group_count);
+      group_count++;
+    }
+
+    index = end;
+  }
+
+  m_groups.resize(group_count);
+}
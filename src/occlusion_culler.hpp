@@ -0,0 +1,158 @@
+/**
+ * @file	occlusion_culler.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class flat_scene_graph;
+  class frustum;
+  class query;
+
+  /**
+   * Class which tracks hardware occlusion queries for groups of scene nodes.
+   *
+   * @note
+   * Groups are subtrees of the flattened scene graph, each tested by drawing its bounds with a
+   * `GL_ANY_SAMPLES_PASSED` query. Results are read back a frame late without blocking. A group
+   * which was visible in the last result is drawn normally, and a group which was occluded is
+   * drawn under conditional rendering against this frame's query, so it is never wrongly hidden.
+   */
+  class occlusion_culler
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** Group index for nodes which do not belong to any group. */
+    static const size_t no_group = std::numeric_limits<size_t>::max();
+
+    /** The smallest subtree, in nodes, which is tested as a group. */
+    static const size_t min_group_size = 6;
+
+    /** The largest subtree, in nodes, which is tested as a group. */
+    static const size_t max_group_size = 4096;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::occlusion_culler` instance.
+     */
+    occlusion_culler();
+
+    /**
+     * Destructor.
+     */
+    ~occlusion_culler();
+
+  private:
+
+    occlusion_culler(const lineage::occlusion_culler&) = delete;
+    occlusion_culler(lineage::occlusion_culler&&) = delete;
+    lineage::occlusion_culler& operator =(const lineage::occlusion_culler&) = delete;
+    lineage::occlusion_culler& operator =(lineage::occlusion_culler&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Collects the results of previous queries, and decides how each group is drawn this frame.
+     *
+     * @param graph
+     * The flattened scene graph, which must already be updated for this frame.
+     *
+     * @param frustum
+     * The view frustum for this frame.
+     *
+     * @param camera_position
+     * The position of the camera in world space.
+     *
+     * @param clip_near
+     * The distance to the near clipping plane.
+     */
+    void update(const lineage::flat_scene_graph& graph,
+                const lineage::frustum& frustum,
+                const glm::vec3& camera_position,
+                float clip_near);
+
+    /**
+     * Returns the group containing the node at the specified index, or
+     * `occlusion_culler::no_group`.
+     */
+    size_t group(size_t node_index) const;
+
+    /**
+     * Returns `true` if the specified group should be drawn under conditional rendering this frame.
+     */
+    bool is_conditional(size_t group) const;
+
+    /**
+     * The groups which should be queried this frame.
+     */
+    const std::vector<size_t>& tested_groups() const;
+
+    /**
+     * Returns the box which should be drawn to test the specified group.
+     */
+    const lineage::bounding_box& proxy_bounds(size_t group) const;
+
+    /**
+     * Returns the query object for the specified group.
+     */
+    lineage::query& query(size_t group);
+
+    /**
+     * Returns the query object for the specified group.
+     */
+    const lineage::query& query(size_t group) const;
+
+    /**
+     * Records that the query for the specified group was issued this frame.
+     */
+    void set_query_issued(size_t group);
+
+    /**
+     * The number of groups which were drawn conditionally in the last update.
+     */
+    size_t conditional_group_count() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct group_state;
+
+    void rebuild(const lineage::flat_scene_graph& graph);
+
+    uint64_t m_layout_revision;
+    bool m_built;
+    std::vector<group_state> m_groups;
+    std::vector<size_t> m_node_groups;
+    std::vector<size_t> m_tested_groups;
+    size_t m_conditional_group_count;
+
+  };
+
+}
@@ -6,7 +6,9 @@
 
 /* -- Includes -- */
 
-#include <map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -16,8 +18,10 @@
 #include "api.hpp"
 #include "buffer.hpp"
 #include "debug.hpp"
+#include "framebuffer.hpp"
 #include "opengl.hpp"
 #include "opengl_error.hpp"
+#include "query.hpp"
 #include "shader_program.hpp"
 #include "vertex_array.hpp"
 
@@ -26,8 +30,87 @@
 using namespace std::string_literals;
 using namespace lineage;
 
+/* -- Constants -- */
+
+namespace
+{
+  // Maximum depth of each binding stack
+  const size_t MAX_STACK_DEPTH = 16;
+
+  // Buffer targets which can be pushed
+  const GLenum BUFFER_TARGETS[] =
+  {
+    GL_ARRAY_BUFFER,
+    GL_ATOMIC_COUNTER_BUFFER,
+    GL_COPY_READ_BUFFER,
+    GL_COPY_WRITE_BUFFER,
+    GL_DISPATCH_INDIRECT_BUFFER,
+    GL_DRAW_INDIRECT_BUFFER,
+    GL_ELEMENT_ARRAY_BUFFER,
+    GL_PIXEL_PACK_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER,
+    GL_QUERY_BUFFER,
+    GL_SHADER_STORAGE_BUFFER,
+    GL_TEXTURE_BUFFER,
+    GL_TRANSFORM_FEEDBACK_BUFFER,
+    GL_UNIFORM_BUFFER,
+  };
+  const size_t BUFFER_TARGET_COUNT = sizeof(BUFFER_TARGETS) / sizeof(BUFFER_TARGETS[0]);
+
+  // Capabilities which are tracked - any others are always passed through
+  const GLenum CAPABILITIES[] =
+  {
+    GL_BLEND,
+    GL_CULL_FACE,
+    GL_DEPTH_TEST,
+    GL_POLYGON_OFFSET_FILL,
+    GL_SCISSOR_TEST,
+    GL_STENCIL_TEST,
+  };
+  const size_t CAPABILITY_COUNT = sizeof(CAPABILITIES) / sizeof(CAPABILITIES[0]);
+
+  // Number of indexed uniform buffer binding points which are tracked
+  const size_t UNIFORM_BUFFER_BINDING_COUNT = 16;
+
+  // Index returned for untracked enum values
+  const size_t NO_SLOT = BUFFER_TARGET_COUNT + CAPABILITY_COUNT;
+}
+
 /* -- Types -- */
 
+namespace
+{
+
+  /** A value of GL state, which may be unknown. */
+  template <typename T>
+  struct cached
+  {
+    T value;
+    bool valid;
+  };
+
+  /** A fixed-capacity stack of object handles. */
+  struct handle_stack
+  {
+    std::array<GLuint, MAX_STACK_DEPTH> handles;
+    size_t size;
+  };
+
+  /** A range of a buffer bound to an indexed binding point. */
+  struct buffer_range
+  {
+    GLuint handle;
+    size_t offset;
+    size_t size;
+
+    bool operator ==(const buffer_range& other) const
+    {
+      return (handle == other.handle && offset == other.offset && size == other.size);
+    }
+  };
+
+}
+
 struct opengl::implementation
 {
 
@@ -35,12 +118,139 @@ struct opengl::implementation
 
   static opengl* s_instance;
 
-  std::map<GLenum, std::vector<GLuint>> buffers;
-  std::vector<GLuint> programs;
-  std::vector<GLuint> vertex_arrays;
+  std::array<handle_stack, BUFFER_TARGET_COUNT> buffer_stacks;
+  handle_stack program_stack;
+  handle_stack vertex_array_stack;
+  handle_stack framebuffer_stack;
+  bool conditional_render_active;
+
+  std::array<cached<GLuint>, BUFFER_TARGET_COUNT> buffers;
+  cached<GLuint> program;
+  cached<GLuint> vertex_array;
+  cached<GLuint> framebuffer;
+  std::array<cached<buffer_range>, UNIFORM_BUFFER_BINDING_COUNT> uniform_buffers;
+  std::array<cached<bool>, CAPABILITY_COUNT> capabilities;
+  cached<GLenum> depth_func;
+  cached<bool> depth_mask;
+  cached<std::array<bool, 4>> color_mask;
+  cached<GLenum> cull_face;
+  cached<GLenum> front_face;
+  cached<std::array<GLenum, 2>> blend_func;
+  cached<std::array<GLint, 4>> viewport;
+  cached<std::array<GLfloat, 4>> clear_color;
+  cached<GLfloat> clear_depth;
+  lineage::opengl_call_stats stats;
 
   /* -- Procedures -- */
 
+  /** Returns the index of a buffer target in the tracked state. */
+  static size_t buffer_slot(GLenum target)
+  {
+    for (size_t slot = 0; slot < BUFFER_TARGET_COUNT; slot++)
+    {
+      if (BUFFER_TARGETS[slot] == target)
+        return slot;
+    }
+    throw std::invalid_argument("Unsupported buffer target!");
+  }
+
+  /** Returns the index of a capability in the tracked state, or `NO_SLOT`. */
+  static size_t capability_slot(GLenum capability)
+  {
+    for (size_t slot = 0; slot < CAPABILITY_COUNT; slot++)
+    {
+      if (CAPABILITIES[slot] == capability)
+        return slot;
+    }
+    return NO_SLOT;
+  }
+
+  /**
+   * Updates a tracked value, and returns `true` if it changed and the GL call should be issued.
+   */
+  template <typename T>
+  bool update(cached<T>& state, const T& value)
+  {
+    if (state.valid && state.value == value)
+    {
+      stats.elided++;
+      return false;
+    }
+    state.value = value;
+    state.valid = true;
+    stats.issued++;
+    return true;
+  }
+
+  /** Pushes a handle onto a stack. */
+  static void push(handle_stack& stack, GLuint handle)
+  {
+    if (stack.size == MAX_STACK_DEPTH)
+      throw std::length_error("Binding stack overflow!");
+    stack.handles[stack.size++] = handle;
+  }
+
+  /** Returns the handle on top of a stack, or 0 if it's empty. */
+  static GLuint top(const handle_stack& stack)
+  {
+    return (stack.size == 0) ? 0 : stack.handles[stack.size - 1];
+  }
+
+  /** Binds a buffer, unless it is already bound. */
+  void bind_buffer(size_t slot, GLuint handle)
+  {
+    if (update(buffers[slot], handle))
+      glBindBuffer(BUFFER_TARGETS[slot], handle);
+  }
+
+  /** Makes a program active, unless it is already active. */
+  void use_program(GLuint handle)
+  {
+    if (update(program, handle))
+      glUseProgram(handle);
+  }
+
+  /** Binds a vertex array, unless it is already bound. */
+  void bind_vertex_array(GLuint handle)
+  {
+    if (!update(vertex_array, handle))
+      return;
+    glBindVertexArray(handle);
+
+    // the element array buffer binding belongs to the vertex array, so it is now unknown
+    buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)].valid = false;
+  }
+
+  /** Binds a framebuffer for drawing and reading, unless it is already bound. */
+  void bind_framebuffer(GLuint handle)
+  {
+    if (update(framebuffer, handle))
+      glBindFramebuffer(GL_FRAMEBUFFER, handle);
+  }
+
+  /** Forgets every tracked value. */
+  void invalidate()
+  {
+    for (auto& buffer : buffers)
+      buffer.valid = false;
+    program.valid = false;
+    vertex_array.valid = false;
+    framebuffer.valid = false;
+    for (auto& range : uniform_buffers)
+      range.valid = false;
+    for (auto& capability : capabilities)
+      capability.valid = false;
+    depth_func.valid = false;
+    depth_mask.valid = false;
+    color_mask.valid = false;
+    cull_face.valid = false;
+    front_face.valid = false;
+    blend_func.valid = false;
+    viewport.valid = false;
+    clear_color.valid = false;
+    clear_depth.valid = false;
+  }
+
   /** Get the OpenGL string with the specified name. */
   static std::string get_string(GLenum name)
   {
@@ -143,52 +353,252 @@ void opengl::set_uniform(GLuint location, const glm::mat4& value)
 
 void opengl::push_buffer(GLenum target, const lineage::buffer& buffer)
 {
-  impl->buffers[target].push_back(buffer.m_handle);
-  glBindBuffer(target, buffer.m_handle);
+  const size_t slot = implementation::buffer_slot(target);
+  implementation::push(impl->buffer_stacks[slot], buffer.m_handle);
+  impl->bind_buffer(slot, buffer.m_handle);
 }
 
 void opengl::pop_buffer(GLenum target)
 {
-  auto& stack = impl->buffers[target];
-  if (stack.empty())
+  const size_t slot = implementation::buffer_slot(target);
+  auto& stack = impl->buffer_stacks[slot];
+  if (stack.size == 0)
   {
     lineage_assert_fail("Attempted to pop buffer with no active buffer!");
     return;
   }
-  stack.pop_back();
-  glBindBuffer(target, stack.empty() ? 0 : stack.back());
+  stack.size--;
+  impl->bind_buffer(slot, implementation::top(stack));
+}
+
+void opengl::bind_uniform_buffer(GLuint binding, const lineage::buffer& buffer, size_t offset, size_t size)
+{
+  lineage_assert(offset % uniform_buffer_offset_alignment() == 0);
+
+  if (binding < UNIFORM_BUFFER_BINDING_COUNT &&
+      !impl->update(impl->uniform_buffers[binding], buffer_range { buffer.m_handle, offset, size }))
+    return;
+
+  glBindBufferRange(GL_UNIFORM_BUFFER,
+                    binding,
+                    buffer.m_handle,
+                    static_cast<GLintptr>(offset),
+                    static_cast<GLsizeiptr>(size));
+
+  // this also binds the buffer to the generic uniform buffer binding point
+  impl->buffers[implementation::buffer_slot(GL_UNIFORM_BUFFER)].valid = false;
+}
+
+size_t opengl::uniform_buffer_offset_alignment() const
+{
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  return static_cast<size_t>(alignment);
 }
 
 void opengl::push_program(const shader_program& program)
 {
-  impl->programs.push_back(program.m_handle);
-  glUseProgram(program.m_handle);
+  implementation::push(impl->program_stack, program.m_handle);
+  impl->use_program(program.m_handle);
 }
 
 void opengl::pop_program()
 {
-  if (impl->programs.empty())
+  if (impl->program_stack.size == 0)
   {
     lineage_assert_fail("Attempted to pop shader program with no active shader program!");
     return;
   }
-  impl->programs.pop_back();
-  glUseProgram(impl->programs.empty() ? 0 : impl->programs.back());
+  impl->program_stack.size--;
+  impl->use_program(implementation::top(impl->program_stack));
 }
 
 void opengl::push_vertex_array(const vertex_array& vao)
 {
-  impl->vertex_arrays.push_back(vao.m_handle);
-  glBindVertexArray(vao.m_handle);
+  implementation::push(impl->vertex_array_stack, vao.m_handle);
+  impl->bind_vertex_array(vao.m_handle);
 }
 
 void opengl::pop_vertex_array()
 {
-  if (impl->vertex_arrays.empty())
+  if (impl->vertex_array_stack.size == 0)
   {
     lineage_assert_fail("Attempted to pop vertex array with no active vertex array!");
     return;
   }
-  impl->vertex_arrays.pop_back();
-  glBindVertexArray(impl->vertex_arrays.empty() ? 0 : impl->vertex_arrays.back());
+  impl->vertex_array_stack.size--;
+  impl->bind_vertex_array(implementation::top(impl->vertex_array_stack));
+}
+
+void opengl::push_framebuffer(const framebuffer& framebuffer)
+{
+  implementation::push(impl->framebuffer_stack, framebuffer.m_handle);
+  impl->bind_framebuffer(framebuffer.m_handle);
+}
+
+void opengl::pop_framebuffer()
+{
+  if (impl->framebuffer_stack.size == 0)
+  {
+    lineage_assert_fail("Attempted to pop framebuffer with no active framebuffer!");
+    return;
+  }
+  impl->framebuffer_stack.size--;
+  impl->bind_framebuffer(implementation::top(impl->framebuffer_stack));
+}
+
+void opengl::forget_buffer(GLuint handle)
+{
+  auto* const instance = implementation::s_instance;
+  if (instance == nullptr)
+    return;
+
+  // deleting a buffer unbinds it everywhere, and a new buffer may be given the same name
+  for (auto& buffer : instance->impl->buffers)
+  {
+    if (buffer.value == handle)
+      buffer.valid = false;
+  }
+  for (auto& range : instance->impl->uniform_buffers)
+  {
+    if (range.value.handle == handle)
+      range.valid = false;
+  }
+}
+
+void opengl::forget_framebuffer(GLuint handle)
+{
+  auto* const instance = implementation::s_instance;
+  if (instance != nullptr && instance->impl->framebuffer.value == handle)
+    instance->impl->framebuffer.valid = false;
+}
+
+void opengl::forget_program(GLuint handle)
+{
+  auto* const instance = implementation::s_instance;
+  if (instance != nullptr && instance->impl->program.value == handle)
+    instance->impl->program.valid = false;
+}
+
+void opengl::forget_vertex_array(GLuint handle)
+{
+  auto* const instance = implementation::s_instance;
+  if (instance == nullptr || instance->impl->vertex_array.value != handle)
+    return;
+
+  // the element array buffer binding belonged to the deleted vertex array
+  instance->impl->vertex_array.valid = false;
+  instance->impl->buffers[implementation::buffer_slot(GL_ELEMENT_ARRAY_BUFFER)].valid = false;
+}
+
+void opengl::set_capability(GLenum capability, bool enabled)
+{
+  const size_t slot = implementation::capability_slot(capability);
+  if (slot == NO_SLOT)
+    impl->stats.issued++;
+  else if (!impl->update(impl->capabilities[slot], enabled))
+    return;
+
+  if (enabled)
+    glEnable(capability);
+  else
+    glDisable(capability);
+}
+
+void opengl::set_depth_func(GLenum func)
+{
+  if (impl->update(impl->depth_func, func))
+    glDepthFunc(func);
+}
+
+void opengl::set_depth_mask(bool enabled)
+{
+  if (impl->update(impl->depth_mask, enabled))
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void opengl::set_color_mask(bool red, bool green, bool blue, bool alpha)
+{
+  if (impl->update(impl->color_mask, std::array<bool, 4> { { red, green, blue, alpha } }))
+  {
+    glColorMask(red ? GL_TRUE : GL_FALSE,
+                green ? GL_TRUE : GL_FALSE,
+                blue ? GL_TRUE : GL_FALSE,
+                alpha ? GL_TRUE : GL_FALSE);
+  }
+}
+
+void opengl::set_cull_face(GLenum face)
+{
+  if (impl->update(impl->cull_face, face))
+    glCullFace(face);
+}
+
+void opengl::set_front_face(GLenum winding)
+{
+  if (impl->update(impl->front_face, winding))
+    glFrontFace(winding);
+}
+
+void opengl::set_blend_func(GLenum source, GLenum destination)
+{
+  if (impl->update(impl->blend_func, std::array<GLenum, 2> { { source, destination } }))
+    glBlendFunc(source, destination);
+}
+
+void opengl::set_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  if (impl->update(impl->viewport, std::array<GLint, 4> { { x, y, width, height } }))
+    glViewport(x, y, width, height);
+}
+
+void opengl::set_clear_color(const glm::vec4& color)
+{
+  if (impl->update(impl->clear_color, std::array<GLfloat, 4> { { color.r, color.g, color.b, color.a } }))
+    glClearColor(color.r, color.g, color.b, color.a);
+}
+
+void opengl::set_clear_depth(GLfloat depth)
+{
+  if (impl->update(impl->clear_depth, depth))
+    glClearDepth(depth);
+}
+
+void opengl::invalidate_state()
+{
+  impl->invalidate();
+}
+
+const opengl_call_stats& opengl::call_stats() const
+{
+  return impl->stats;
+}
+
+void opengl::reset_call_stats()
+{
+  impl->stats = { };
+}
+
+void opengl::begin_conditional_render(const query& query, GLenum mode)
+{
+  if (impl->conditional_render_active)
+  {
+    lineage_assert_fail("Attempted to begin conditional rendering while it was already active!");
+    return;
+  }
+  impl->conditional_render_active = true;
+  impl->stats.issued++;
+  glBeginConditionalRender(query.m_handle, mode);
+}
+
+void opengl::end_conditional_render()
+{
+  if (!impl->conditional_render_active)
+  {
+    lineage_assert_fail("Attempted to end conditional rendering while it was not active!");
+    return;
+  }
+  impl->conditional_render_active = false;
+  impl->stats.issued++;
+  glEndConditionalRender();
 }
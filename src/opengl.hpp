@@ -8,6 +8,8 @@
 
 /* -- Includes -- */
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <glm/glm.hpp>
 
@@ -19,11 +21,29 @@ namespace lineage
 {
 
   class buffer;
+  class framebuffer;
+  class query;
   class shader_program;
   class vertex_array;
 
+  /**
+   * Struct containing counters for the state-changing calls made through `lineage::opengl`.
+   */
+  struct opengl_call_stats
+  {
+    uint64_t issued;	/**< The number of calls which were passed on to OpenGL. */
+    uint64_t elided;	/**< The number of calls which were skipped, since they would not have changed any state. */
+  };
+
   /**
    * Class representing an interface to the OpenGL library.
+   *
+   * @note
+   * This class tracks the GL state which it sets (bindings, capabilities, and fixed-function
+   * values), and skips calls which would not change it. State changed by calling OpenGL directly
+   * is not seen, so `invalidate_state()` must be called afterwards. Objects must not be deleted
+   * while they are on one of the binding stacks, but deleting an object which is only bound is
+   * safe - its destructor removes it from the tracked state, since GL may reuse its name.
    */
   class opengl final
   {
@@ -107,6 +127,19 @@ namespace lineage
      */
     void pop_buffer(GLenum target);
 
+    /**
+     * Binds a range of a buffer to an indexed uniform buffer binding point.
+     *
+     * @note
+     * `offset` must be a multiple of `uniform_buffer_offset_alignment()`.
+     */
+    void bind_uniform_buffer(GLuint binding, const lineage::buffer& buffer, size_t offset, size_t size);
+
+    /**
+     * Returns the value of `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`.
+     */
+    size_t uniform_buffer_offset_alignment() const;
+
     /**
      * Pushes a shader program onto the stack, making it active.
      */
@@ -129,10 +162,114 @@ namespace lineage
      */
     void pop_vertex_array();
 
+    /**
+     * Pushes a framebuffer onto the stack, making it the target for drawing and reading.
+     */
+    void push_framebuffer(const lineage::framebuffer& framebuffer);
+
+    /**
+     * Pops the active framebuffer off of the stack, reactivating the previous framebuffer (or the
+     * default framebuffer, if the stack is now empty).
+     */
+    void pop_framebuffer();
+
+    /**
+     * Enables or disables an OpenGL capability (`GL_DEPTH_TEST`, `GL_CULL_FACE`, etc.)
+     */
+    void set_capability(GLenum capability, bool enabled);
+
+    /**
+     * Sets the depth comparison function.
+     */
+    void set_depth_func(GLenum func);
+
+    /**
+     * Enables or disables writing to the depth buffer.
+     */
+    void set_depth_mask(bool enabled);
+
+    /**
+     * Enables or disables writing to each component of the color buffer.
+     */
+    void set_color_mask(bool red, bool green, bool blue, bool alpha);
+
+    /**
+     * Sets which faces are culled when `GL_CULL_FACE` is enabled.
+     */
+    void set_cull_face(GLenum face);
+
+    /**
+     * Sets the winding order of front faces.
+     */
+    void set_front_face(GLenum winding);
+
+    /**
+     * Sets the source and destination blend factors.
+     */
+    void set_blend_func(GLenum source, GLenum destination);
+
+    /**
+     * Sets the viewport.
+     */
+    void set_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    /**
+     * Sets the color used to clear the color buffer.
+     */
+    void set_clear_color(const glm::vec4& color);
+
+    /**
+     * Sets the value used to clear the depth buffer.
+     */
+    void set_clear_depth(GLfloat depth);
+
+    /**
+     * Forgets all tracked state, so that the next call to set each value is always issued. Must be
+     * called after changing state with OpenGL directly.
+     */
+    void invalidate_state();
+
+    /**
+     * Counters for the calls issued and elided since the last call to `reset_call_stats()`.
+     */
+    const lineage::opengl_call_stats& call_stats() const;
+
+    /**
+     * Resets the counters returned by `call_stats()`.
+     */
+    void reset_call_stats();
+
+    /**
+     * Begins conditional rendering. Until `end_conditional_render()` is called, draw commands are
+     * discarded if `query` found that no samples passed.
+     *
+     * @param query
+     * The occlusion query whose result controls rendering.
+     *
+     * @param mode
+     * The conditional render mode (`GL_QUERY_WAIT`, `GL_QUERY_NO_WAIT`, etc.)
+     */
+    void begin_conditional_render(const lineage::query& query, GLenum mode);
+
+    /**
+     * Ends conditional rendering.
+     */
+    void end_conditional_render();
+
     /* -- Implementation -- */
 
   private:
 
+    friend class lineage::buffer;
+    friend class lineage::framebuffer;
+    friend class lineage::shader_program;
+    friend class lineage::vertex_array;
+
+    static void forget_buffer(GLuint handle);
+    static void forget_framebuffer(GLuint handle);
+    static void forget_program(GLuint handle);
+    static void forget_vertex_array(GLuint handle);
+
     struct implementation;
     const std::unique_ptr<implementation> impl;
 
@@ -0,0 +1,322 @@
+/**
+ * @file	program_cache.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "api.hpp"
+#include "debug.hpp"
+#include "opengl.hpp"
+#include "program_cache.hpp"
+#include "shader_compiler.hpp"
+#include "shader_program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const char FILE_MAGIC[4] = { 'L', 'N', 'P', 'B' };
+  const uint32_t FILE_VERSION = 1;
+
+  // size of the fixed part of the header - the magic, version, binary format and driver string length
+  const size_t HEADER_SIZE = 16;
+
+  const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+  const uint64_t FNV_PRIME = 1099511628211ull;
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Adds the specified bytes to a 64-bit FNV-1a hash. */
+  uint64_t hash_bytes(uint64_t hash, const void* data, size_t size)
+  {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t index = 0; index < size; index++)
+    {
+      hash ^= bytes[index];
+      hash *= FNV_PRIME;
+    }
+    return hash;
+  }
+
+  /** Adds a string, and its length, to a 64-bit FNV-1a hash. */
+  uint64_t hash_string(uint64_t hash, const std::string& value)
+  {
+    // hashing the length keeps the boundaries between consecutive strings significant
+    const uint64_t length = value.size();
+    hash = hash_bytes(hash, &length, sizeof(length));
+    return hash_bytes(hash, value.data(), value.size());
+  }
+
+  /** Appends a 32-bit value to a buffer in little-endian order. */
+  void append_uint32(std::vector<uint8_t>& buffer, uint32_t value)
+  {
+    for (int shift = 0; shift < 32; shift += 8)
+      buffer.push_back(static_cast<uint8_t>((value >> shift) & 0xFF));
+  }
+
+  /** Reads a 32-bit little-endian value from a buffer. */
+  uint32_t read_uint32(const std::vector<uint8_t>& buffer, size_t offset)
+  {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+      value |= static_cast<uint32_t>(buffer[offset++]) << shift;
+    return value;
+  }
+
+  /** Creates the specified directory and any missing parents, returning `true` if it exists. */
+  bool create_directories(const std::string& path)
+  {
+    for (size_t separator = path.find('/', 1); ; separator = path.find('/', separator + 1))
+    {
+      const std::string parent = path.substr(0, separator);
+      if (::mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+        return false;
+      if (separator == std::string::npos)
+        return true;
+    }
+  }
+
+}
+
+/* -- Types -- */
+
+/**
+ * Implementation for the `lineage::program_cache` class.
+ */
+struct program_cache::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const lineage::opengl& opengl,
+                 lineage::shader_compiler& compiler,
+                 const std::string& directory)
+    : compiler(compiler),
+      directory(directory),
+      driver(opengl.vendor() + "\n" + opengl.renderer() + "\n" + opengl.api_version()),
+      enabled(false),
+      hits(0),
+      misses(0)
+  {
+    if (directory.empty())
+      return;
+
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count <= 0)
+    {
+      lineage_log_status("Program binaries are not supported - shader programs will not be cached.");
+      return;
+    }
+
+    if (!create_directories(directory))
+    {
+      lineage_log_warning("Failed to create shader program cache directory " + directory);
+      return;
+    }
+
+    enabled = true;
+  }
+
+  /* -- Fields -- */
+
+  lineage::shader_compiler& compiler;
+  const std::string directory;
+  const std::string driver;
+  bool enabled;
+  uint64_t hits;
+  uint64_t misses;
+
+  /* -- Procedures -- */
+
+  /** Returns the path of the file caching the program built from the specified stages. */
+  std::string cache_path(const std::vector<shader_stage>& stages) const
+  {
+    uint64_t hash = hash_string(FNV_OFFSET_BASIS, driver);
+    for (const auto& stage : stages)
+    {
+      const uint32_t type = stage.type;
+      hash = hash_bytes(hash, &type, sizeof(type));
+      hash = hash_string(hash, stage.source);
+    }
+
+    std::ostringstream path;
+    path << directory << "/" << std::hex;
+    path.width(16);
+    path.fill('0');
+    path << hash << ".bin";
+    return path.str();
+  }
+
+  /**
+   * Attempts to restore a program from the specified cache file.
+   *
+   * @return
+   * The restored program, or `nullptr` if the file doesn't exist, was written by a different
+   * driver, or was rejected.
+   */
+  std::unique_ptr<shader_program> restore(const std::string& path) const
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      return nullptr;
+    const std::vector<uint8_t> data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    if (data.size() < HEADER_SIZE ||
+        std::memcmp(data.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        read_uint32(data, 4) != FILE_VERSION)
+      return nullptr;
+
+    const GLenum format = read_uint32(data, 8);
+    const size_t driver_length = read_uint32(data, 12);
+    if (data.size() < HEADER_SIZE + driver_length ||
+        driver.compare(0, std::string::npos, reinterpret_cast<const char*>(data.data() + HEADER_SIZE), driver_length) != 0)
+      return nullptr;
+
+    const size_t binary_offset = HEADER_SIZE + driver_length;
+    auto program = std::make_unique<shader_program>();
+    if (!program->load_binary(format, data.data() + binary_offset, data.size() - binary_offset))
+    {
+      lineage_log_warning("Cached shader program was rejected by the driver - recompiling.");
+      return nullptr;
+    }
+
+    return program;
+  }
+
+  /** Writes the binary for a program to the specified cache file. */
+  void store(const std::string& path, const shader_program& program) const
+  {
+    GLenum format = 0;
+    std::vector<uint8_t> binary;
+    if (!program.binary(&format, &binary))
+      return;
+
+    std::vector<uint8_t> data;
+    data.insert(data.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    append_uint32(data, FILE_VERSION);
+    append_uint32(data, format);
+    append_uint32(data, static_cast<uint32_t>(driver.size()));
+    data.insert(data.end(), driver.begin(), driver.end());
+    data.insert(data.end(), binary.begin(), binary.end());
+
+    // write to a temporary file first, so that another instance never reads a partial file
+    const std::string temporary_path = path + ".tmp";
+    {
+      std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(data.data()), data.size());
+      if (!file)
+      {
+        lineage_log_warning("Failed to write cached shader program " + temporary_path);
+        return;
+      }
+    }
+    std::rename(temporary_path.c_str(), path.c_str());
+  }
+
+};
+
+/* -- Procedures -- */
+
+program_cache::program_cache(const opengl& opengl, shader_compiler& compiler, const std::string& directory)
+  : impl(std::make_unique<implementation>(opengl, compiler, directory))
+{
+}
+
+program_cache::~program_cache() = default;
+
+std::string program_cache::default_directory()
+{
+#if defined(LINEAGE_MACOS)
+  const char* home = std::getenv("HOME");
+  return (home ? std::string(home) + "/Library/Caches/lineage" : "");
+#else
+  const char* cache_home = std::getenv("XDG_CACHE_HOME");
+  if (cache_home && cache_home[0] != '\0')
+    return std::string(cache_home) + "/lineage";
+  const char* home = std::getenv("HOME");
+  return (home ? std::string(home) + "/.cache/lineage" : "");
+#endif
+}
+
+bool program_cache::is_enabled() const
+{
+  return impl->enabled;
+}
+
+std::unique_ptr<shader_program> program_cache::create_program(const std::vector<shader_stage>& stages)
+{
+  return std::move(create_programs({ stages }).front());
+}
+
+std::vector<std::unique_ptr<shader_program>>
+program_cache::create_programs(const std::vector<std::vector<shader_stage>>& programs)
+{
+  std::vector<std::unique_ptr<shader_program>> results(programs.size());
+  std::vector<std::string> paths(programs.size());
+  std::vector<shader_compiler::request> requests(programs.size());
+
+  // submit every program which can't be restored before waiting for any of them
+  for (size_t index = 0; index < programs.size(); index++)
+  {
+    if (impl->enabled)
+    {
+      paths[index] = impl->cache_path(programs[index]);
+      results[index] = impl->restore(paths[index]);
+      if (results[index])
+      {
+        impl->hits++;
+        continue;
+      }
+    }
+
+    impl->misses++;
+    requests[index] = impl->compiler.submit(programs[index], impl->enabled);
+  }
+
+  for (size_t index = 0; index < programs.size(); index++)
+  {
+    if (results[index])
+      continue;
+
+    results[index] = impl->compiler.finish(requests[index]);
+    if (impl->enabled)
+      impl->store(paths[index], *results[index]);
+  }
+
+  return results;
+}
+
+uint64_t program_cache::hit_count() const
+{
+  return impl->hits;
+}
+
+uint64_t program_cache::miss_count() const
+{
+  return impl->misses;
+}
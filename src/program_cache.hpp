@@ -0,0 +1,141 @@
+/**
+ * @file	program_cache.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api.hpp"
+#include "shader_compiler.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class opengl;
+  class shader_program;
+
+  /**
+   * Class which caches linked shader programs on disk, so that they don't need to be compiled
+   * again on the next launch.
+   *
+   * @note
+   * Each program is stored in its own file, named by a hash of its sources and of the driver's
+   * vendor, renderer and version strings, so that a driver update never restores binaries built
+   * by the old driver. The file also holds the driver strings, which are checked before the binary
+   * is used. If the driver still rejects a binary, the program is compiled from source and the
+   * file is replaced.
+   *
+   * The cache is disabled if no directory is given, or if the driver doesn't support any program
+   * binary formats. Programs are then always compiled.
+   *
+   * Programs which aren't cached are built with a `lineage::shader_compiler`, so a batch of them
+   * created with `create_programs()` is compiled in parallel.
+   */
+  class program_cache
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::program_cache` instance.
+     *
+     * @param opengl
+     * The OpenGL interface in use by the application.
+     *
+     * @param compiler
+     * The compiler to build programs with when they aren't cached.
+     *
+     * @param directory
+     * The directory to store cached programs in, which is created if required. If empty, the
+     * cache is disabled.
+     */
+    program_cache(const lineage::opengl& opengl,
+                  lineage::shader_compiler& compiler,
+                  const std::string& directory);
+
+    /**
+     * Destructor.
+     */
+    ~program_cache();
+
+  private:
+
+    program_cache(const lineage::program_cache&) = delete;
+    program_cache(lineage::program_cache&&) = delete;
+    lineage::program_cache& operator =(const lineage::program_cache&) = delete;
+    lineage::program_cache& operator =(lineage::program_cache&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns the default directory for the cache - the user's cache directory on platforms which
+     * have one, or an empty string if it can't be determined.
+     */
+    static std::string default_directory();
+
+    /**
+     * Returns `true` if programs are being cached.
+     */
+    bool is_enabled() const;
+
+    /**
+     * Returns a linked program built from the specified stages, restoring it from the cache if
+     * possible.
+     *
+     * @exception lineage::shader_compile_error
+     * Thrown if the program isn't cached, and one of its shaders fails to compile.
+     *
+     * @exception lineage::shader_program_link_error
+     * Thrown if the program isn't cached, and fails to link.
+     */
+    std::unique_ptr<lineage::shader_program> create_program(const std::vector<lineage::shader_stage>& stages);
+
+    /**
+     * Returns linked programs built from each of the specified sets of stages, in the same order.
+     * Programs are restored from the cache if possible, and the rest are all submitted to the
+     * compiler before waiting for any of them.
+     *
+     * @exception lineage::shader_compile_error
+     * Thrown if a program isn't cached, and one of its shaders fails to compile.
+     *
+     * @exception lineage::shader_program_link_error
+     * Thrown if a program isn't cached, and fails to link.
+     */
+    std::vector<std::unique_ptr<lineage::shader_program>>
+    create_programs(const std::vector<std::vector<lineage::shader_stage>>& programs);
+
+    /**
+     * The number of programs which were restored from the cache.
+     */
+    uint64_t hit_count() const;
+
+    /**
+     * The number of programs which had to be compiled, including those whose cached binary was
+     * rejected.
+     */
+    uint64_t miss_count() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -96,11 +96,7 @@ prototype_render_manager::prototype_render_manager(lineage::opengl& opengl,
 
 void prototype_render_manager::render(const render_args& args)
 {
-  auto background_color = m_state_manager.background_color();
-  glClearColor(background_color.r,
-               background_color.g,
-               background_color.b,
-               background_color.a);
+  m_opengl.set_clear_color(m_state_manager.background_color());
 
   glClear(GL_COLOR_BUFFER_BIT);
 
@@ -124,3 +120,9 @@ double prototype_render_manager::target_delta_t() const
 {
   return (1.0 / 60.0); // 60 HZ
 }
+
+double prototype_render_manager::gpu_frame_time() const
+{
+  // the prototype renderer isn't profiled
+  return 0.0;
+}
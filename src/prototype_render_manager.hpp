@@ -62,6 +62,7 @@ namespace lineage
 
     virtual void render(const render_args& args) override;
     virtual double target_delta_t() const override;
+    virtual double gpu_frame_time() const override;
 
     /* -- Implementation -- */
 
@@ -32,6 +32,12 @@ double prototype_state_manager::target_delta_t() const
   return (1.0 / 60.0); // 60 Hz
 }
 
+bool prototype_state_manager::supports_concurrent_run() const
+{
+  // the prototype renderer reads the background color directly
+  return false;
+}
+
 void prototype_state_manager::update_background_color(const state_args& args)
 {
   static const float RATE_PER_SECOND = 0.5;
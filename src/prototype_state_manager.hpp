@@ -63,6 +63,7 @@ namespace lineage
 
     virtual void run(const lineage::state_args& args) override;
     virtual double target_delta_t() const override;
+    virtual bool supports_concurrent_run() const override;
 
     /* -- Implementation -- */
 
@@ -0,0 +1,90 @@
+/**
+ * @file	query.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+/* -- Includes -- */
+
+#include <limits>
+
+#include "api.hpp"
+#include "opengl_error.hpp"
+#include "query.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const GLuint INVALID_HANDLE = std::numeric_limits<GLuint>::max();
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Create a new query handle. */
+  GLuint create_query(GLenum target)
+  {
+    GLuint handle = INVALID_HANDLE;
+    glCreateQueries(target, 1, &handle);
+    return handle;
+  }
+
+}
+
+/* -- Procedures -- */
+
+query::query(GLenum target)
+  : m_target(target),
+    m_handle(create_query(target))
+{
+  if (m_handle == INVALID_HANDLE)
+    opengl_error::throw_last_error();
+}
+
+query::~query()
+{
+  if (m_handle == INVALID_HANDLE)
+    return;
+  glDeleteQueries(1, &m_handle);
+}
+
+GLenum query::target() const
+{
+  return m_target;
+}
+
+void query::begin()
+{
+  glBeginQuery(m_target, m_handle);
+}
+
+void query::end()
+{
+  glEndQuery(m_target);
+}
+
+void query::record_timestamp()
+{
+  glQueryCounter(m_handle, GL_TIMESTAMP);
+}
+
+bool query::is_result_available() const
+{
+  GLuint available = GL_FALSE;
+  glGetQueryObjectuiv(m_handle, GL_QUERY_RESULT_AVAILABLE, &available);
+  return (available != GL_FALSE);
+}
+
+GLuint64 query::result() const
+{
+  GLuint64 result = 0;
+  glGetQueryObjectui64v(m_handle, GL_QUERY_RESULT, &result);
+  return result;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file	query.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include "api.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class opengl;
+
+  /**
+   * Class representing an OpenGL query object.
+   */
+  class query
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::query` instance.
+     *
+     * @param target
+     * The type of query (`GL_ANY_SAMPLES_PASSED`, `GL_TIME_ELAPSED`, etc.)
+     *
+     * @exception lineage::opengl_error
+     * Thrown if a new query cannot be created for any reason.
+     */
+    query(GLenum target);
+
+    /**
+     * Destructor.
+     */
+    ~query();
+
+  private:
+
+    query(const lineage::query&) = delete;
+    query(lineage::query&&) = delete;
+    lineage::query& operator =(const lineage::query&) = delete;
+    lineage::query& operator =(lineage::query&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * The type of this query.
+     */
+    GLenum target() const;
+
+    /**
+     * Begins the query. Only one query of each type may be active at a time.
+     */
+    void begin();
+
+    /**
+     * Ends the query.
+     */
+    void end();
+
+    /**
+     * Records the GPU time once every previously issued command has completed. This may only be
+     * used for `GL_TIMESTAMP` queries, and the result is in nanoseconds.
+     */
+    void record_timestamp();
+
+    /**
+     * Returns `true` if the result of the most recently ended query is available. This never
+     * blocks.
+     */
+    bool is_result_available() const;
+
+    /**
+     * Returns the result of the most recently ended query.
+     *
+     * @note
+     * If the result is not yet available, this blocks until the GPU has finished the query.
+     */
+    GLuint64 result() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    friend class opengl;
+
+    const GLenum m_target;
+    const GLuint m_handle;
+
+  };
+
+}
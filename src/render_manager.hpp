@@ -62,6 +62,16 @@ namespace lineage
      */
     virtual double target_delta_t() const = 0;
 
+    /**
+     * The GPU time taken by the most recent frame whose timing is known, in seconds, or zero if
+     * GPU time isn't measured.
+     *
+     * @note
+     * GPU timing is read back a few frames late so that it never stalls rendering, so this lags
+     * behind the frame just rendered.
+     */
+    virtual double gpu_frame_time() const = 0;
+
   };
 
 }
@@ -0,0 +1,97 @@
+/**
+ * @file	render_queue.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "render_queue.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  const unsigned RADIX_BITS = 8;
+  const size_t RADIX_BUCKETS = (1u << RADIX_BITS);
+  const unsigned RADIX_PASSES = (64 / RADIX_BITS);
+}
+
+/* -- Procedures -- */
+
+render_queue::render_queue()
+  : m_items(),
+    m_scratch()
+{
+}
+
+void render_queue::clear()
+{
+  m_items.clear();
+}
+
+void render_queue::push(const draw_item& item)
+{
+  m_items.push_back(item);
+}
+
+void render_queue::append(const draw_item* items, size_t count)
+{
+  m_items.insert(m_items.end(), items, items + count);
+}
+
+void render_queue::sort()
+{
+  const size_t count = m_items.size();
+  if (count < 2)
+    return;
+
+  m_scratch.resize(count);
+
+  // build the histograms for every pass up front, with a single read of the keys
+  size_t histograms[RADIX_PASSES][RADIX_BUCKETS] = { };
+  for (const auto& item : m_items)
+  {
+    for (unsigned pass = 0; pass < RADIX_PASSES; pass++)
+      histograms[pass][(item.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+  }
+
+  // least significant digit first, so each pass preserves the order of the previous one
+  for (unsigned pass = 0; pass < RADIX_PASSES; pass++)
+  {
+    auto& histogram = histograms[pass];
+    const unsigned shift = pass * RADIX_BITS;
+
+    // skip passes where every key has the same digit - this is common, since most keys share
+    // their upper (state) bits
+    if (histogram[(m_items.front().key >> shift) & (RADIX_BUCKETS - 1)] == count)
+      continue;
+
+    size_t offsets[RADIX_BUCKETS];
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+    {
+      offsets[bucket] = offset;
+      offset += histogram[bucket];
+    }
+
+    for (const auto& item : m_items)
+      m_scratch[offsets[(item.key >> shift) & (RADIX_BUCKETS - 1)]++] = item;
+
+    std::swap(m_items, m_scratch);
+  }
+}
+
+const std::vector<draw_item>& render_queue::items() const
+{
+  return m_items;
+}
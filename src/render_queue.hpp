@@ -0,0 +1,163 @@
+/**
+ * @file	render_queue.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Struct representing a single mesh to be drawn for a single scene node.
+   */
+  struct draw_item
+  {
+    uint64_t key;		/**< The sort key for this item. See `lineage::make_render_key()`. */
+    uint32_t mesh_index;	/**< The index of the mesh to draw. */
+    uint32_t node_index;	/**< The index of the node in the flattened scene graph. */
+  };
+
+  /**
+   * Class which collects draw items and sorts them by key, so that items sharing GL state are
+   * submitted together.
+   */
+  class render_queue
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new, empty `lineage::render_queue` instance.
+     */
+    render_queue();
+
+  private:
+
+    render_queue(const lineage::render_queue&) = delete;
+    render_queue(lineage::render_queue&&) = delete;
+    lineage::render_queue& operator =(const lineage::render_queue&) = delete;
+    lineage::render_queue& operator =(lineage::render_queue&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Removes all items from the queue. Storage is retained for the next frame.
+     */
+    void clear();
+
+    /**
+     * Adds an item to the queue.
+     */
+    void push(const lineage::draw_item& item);
+
+    /**
+     * Adds a range of items to the queue.
+     */
+    void append(const lineage::draw_item* items, size_t count);
+
+    /**
+     * Sorts the items in the queue by key, using a stable radix sort.
+     */
+    void sort();
+
+    /**
+     * The items in the queue.
+     */
+    const std::vector<lineage::draw_item>& items() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    std::vector<lineage::draw_item> m_items;
+    std::vector<lineage::draw_item> m_scratch;
+
+  };
+
+}
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /*
+   * Render keys are laid out as follows, from most significant to least significant bit:
+   *
+   *   | pass (4) | program (8) | vertex format (4) | geometry page (12) | mesh (20) | depth (16) |
+   *
+   * Everything above the mesh field identifies GL state which must be changed between draws. The
+   * mesh and depth fields only affect draw parameters and ordering.
+   */
+
+  /** Number of bits in the depth field of a render key. */
+  const unsigned RENDER_KEY_DEPTH_BITS = 16;
+
+  /** Number of bits in the mesh field of a render key. */
+  const unsigned RENDER_KEY_MESH_BITS = 20;
+
+  /** Number of bits in the geometry page field of a render key. */
+  const unsigned RENDER_KEY_PAGE_BITS = 12;
+
+  /** Number of bits in the vertex format field of a render key. */
+  const unsigned RENDER_KEY_FORMAT_BITS = 4;
+
+  /** Number of bits in the program field of a render key. */
+  const unsigned RENDER_KEY_PROGRAM_BITS = 8;
+
+  /** Number of bits in the pass field of a render key. */
+  const unsigned RENDER_KEY_PASS_BITS = 4;
+
+  /**
+   * Packs the specified values into a render key. Values which do not fit in their field are
+   * truncated.
+   */
+  inline uint64_t make_render_key(uint64_t pass,
+                                  uint64_t program,
+                                  uint64_t vertex_format,
+                                  uint64_t page,
+                                  uint64_t mesh,
+                                  uint64_t depth)
+  {
+    uint64_t key = pass & ((1u << RENDER_KEY_PASS_BITS) - 1);
+    key = (key << RENDER_KEY_PROGRAM_BITS) | (program & ((1u << RENDER_KEY_PROGRAM_BITS) - 1));
+    key = (key << RENDER_KEY_FORMAT_BITS) | (vertex_format & ((1u << RENDER_KEY_FORMAT_BITS) - 1));
+    key = (key << RENDER_KEY_PAGE_BITS) | (page & ((1u << RENDER_KEY_PAGE_BITS) - 1));
+    key = (key << RENDER_KEY_MESH_BITS) | (mesh & ((1u << RENDER_KEY_MESH_BITS) - 1));
+    key = (key << RENDER_KEY_DEPTH_BITS) | (depth & ((1u << RENDER_KEY_DEPTH_BITS) - 1));
+    return key;
+  }
+
+  /**
+   * Returns the bits of a render key which identify GL state. Two items with equal state bits can
+   * be drawn without changing any GL state.
+   */
+  inline uint64_t render_key_state(uint64_t key)
+  {
+    return (key >> (RENDER_KEY_MESH_BITS + RENDER_KEY_DEPTH_BITS));
+  }
+
+  /**
+   * Returns the bits of a render key which identify GL state and the mesh being drawn. Two items
+   * with equal batch bits can be drawn with a single instanced draw call.
+   */
+  inline uint64_t render_key_batch(uint64_t key)
+  {
+    return (key >> RENDER_KEY_DEPTH_BITS);
+  }
+
+}
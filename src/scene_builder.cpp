@@ -6,13 +6,21 @@
 
 /* -- Includes -- */
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "api.hpp"
 #include "constants.hpp"
+#include "geometry_pool.hpp"
+#include "lod_chain.hpp"
 #include "mesh.hpp"
 #include "scene_builder.hpp"
 #include "scene_graph.hpp"
@@ -23,13 +31,42 @@
 
 using namespace lineage;
 
+/* -- Constants -- */
+
+namespace
+{
+  // distance between the centers of neighbouring cubes in the stress scenes
+  const float STRESS_CUBE_SPACING = 2.0f;
+
+  // each link of a deep chain turns and rises slightly, so that the chain winds up in a helix
+  const float CHAIN_LINK_TURN = deg_to_rad(10.0f);
+  const float CHAIN_LINK_RISE = 0.25f;
+
+  // cubes in a wide fan are spread out in a sunflower pattern by the golden angle
+  const float FAN_GOLDEN_ANGLE = static_cast<float>(M_PI * (3.0 - std::sqrt(5.0)));
+
+  const float SCATTER_MIN_SCALE = 0.5f;
+  const float SCATTER_MAX_SCALE = 1.5f;
+
+  // the most detailed sphere, and the number of extra segments for each additional resolution
+  const size_t SPHERE_SEGMENTS = 48;
+  const size_t SPHERE_RINGS = 24;
+  const size_t SPHERE_SEGMENT_STEP = 4;
+
+  // each level of a sphere's LOD chain keeps a quarter of the triangles of the level before it, and
+  // the second level is used once the sphere is smaller than a fifth of the viewport
+  const size_t SPHERE_LOD_LEVELS = 4;
+  const float SPHERE_LOD_REDUCTION = 0.25f;
+  const float SPHERE_LOD_FIRST_SCREEN_SIZE = 0.2f;
+}
+
 /* -- Private Procedures -- */
 
 namespace
 {
 
   /** Creates a square mesh. */
-  std::unique_ptr<mesh> square_mesh(const glm::vec4& color)
+  std::unique_ptr<mesh> square_mesh(geometry_pool& geometry, const glm::vec4& color)
   {
     static const GLenum DRAW_MODE = GL_TRIANGLE_FAN;
     static const std::vector<GLuint> INDICES { 0, 1, 2, 3 };
@@ -42,16 +79,81 @@ namespace
       { { -0.5f, 0.5f, 0.0f }, { }, color, { } },
     };
 
-    return std::make_unique<mesh>(DRAW_MODE, vertices, INDICES);
+    return std::make_unique<mesh>(geometry, DRAW_MODE, vertices, INDICES);
+  }
+
+  /**
+   * Creates a regular polygon mesh in the same plane and of roughly the same size as the square
+   * mesh, so that it can be used for the faces of a cube.
+   */
+  std::unique_ptr<mesh> polygon_mesh(geometry_pool& geometry, size_t sides, const glm::vec4& color)
+  {
+    static const GLenum DRAW_MODE = GL_TRIANGLE_FAN;
+
+    std::vector<vertex> vertices;
+    std::vector<GLuint> indices;
+    for (size_t side = 0; side < sides; side++)
+    {
+      const float angle = static_cast<float>(2.0 * M_PI * side / sides);
+      vertices.push_back({ { 0.5f * std::cos(angle), 0.5f * std::sin(angle), 0.0f }, { }, color, { } });
+      indices.push_back(static_cast<GLuint>(side));
+    }
+
+    return std::make_unique<mesh>(geometry, DRAW_MODE, vertices, indices);
+  }
+
+  /** Creates a sphere mesh with a diameter of one, as a list of triangles. */
+  std::unique_ptr<mesh> sphere_mesh(geometry_pool& geometry, size_t segments, size_t rings, const glm::vec4& color)
+  {
+    static const GLenum DRAW_MODE = GL_TRIANGLES;
+
+    // the poles are single vertices, with a ring of vertices for every other latitude
+    std::vector<vertex> vertices;
+    vertices.push_back({ { 0.0f, 0.5f, 0.0f }, VEC3_UNIT_Y, color, { } });
+    for (size_t ring = 1; ring < rings; ring++)
+    {
+      const float theta = static_cast<float>(M_PI * ring / rings);
+      for (size_t segment = 0; segment < segments; segment++)
+      {
+        const float phi = static_cast<float>(2.0 * M_PI * segment / segments);
+        const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        vertices.push_back({ normal * 0.5f, normal, color, { } });
+      }
+    }
+    vertices.push_back({ { 0.0f, -0.5f, 0.0f }, -VEC3_UNIT_Y, color, { } });
+
+    const GLuint south_pole = static_cast<GLuint>(vertices.size() - 1);
+    auto ring_vertex = [&] (size_t ring, size_t segment) {
+      return static_cast<GLuint>(1 + (ring - 1) * segments + (segment % segments));
+    };
+
+    std::vector<GLuint> indices;
+    for (size_t segment = 0; segment < segments; segment++)
+    {
+      indices.insert(indices.end(), { 0, ring_vertex(1, segment + 1), ring_vertex(1, segment) });
+      for (size_t ring = 1; ring + 1 < rings; ring++)
+      {
+        const GLuint upper = ring_vertex(ring, segment);
+        const GLuint upper_next = ring_vertex(ring, segment + 1);
+        const GLuint lower = ring_vertex(ring + 1, segment);
+        const GLuint lower_next = ring_vertex(ring + 1, segment + 1);
+        indices.insert(indices.end(), { upper, lower_next, lower, upper, upper_next, lower_next });
+      }
+      indices.insert(indices.end(), { ring_vertex(rings - 1, segment), ring_vertex(rings - 1, segment + 1), south_pole });
+    }
+
+    return std::make_unique<mesh>(geometry, DRAW_MODE, vertices, indices);
   }
 
   /** Creates a node for a cube. */
-  scene_node cube_node(GLuint square_mesh_index)
+  scene_node cube_node(GLuint square_mesh_index, const glm::vec4& color = COLOR_WHITE)
   {
     scene_node parent;
 
     auto& children = parent.children();
     children.resize(6);
+    for (auto& child : children)
+      child.set_color(color);
 
     // front face
     children[0].meshes().assign({ square_mesh_index });
@@ -86,6 +188,58 @@ namespace
     return parent;
   }
 
+  /**
+   * Returns a color for the specified index, with the hues of `color_count` colors spread evenly
+   * around the color wheel.
+   */
+  glm::vec4 stress_color(size_t index, size_t color_count)
+  {
+    const float hue = static_cast<float>(index % color_count) * 6.0f / color_count;
+    const float x = 1.0f - std::abs(std::fmod(hue, 2.0f) - 1.0f);
+    switch (static_cast<int>(hue))
+    {
+    case 0: return glm::vec4(1.0f, x, 0.0f, 1.0f);
+    case 1: return glm::vec4(x, 1.0f, 0.0f, 1.0f);
+    case 2: return glm::vec4(0.0f, 1.0f, x, 1.0f);
+    case 3: return glm::vec4(0.0f, x, 1.0f, 1.0f);
+    case 4: return glm::vec4(x, 0.0f, 1.0f, 1.0f);
+    default: return glm::vec4(1.0f, 0.0f, x, 1.0f);
+    }
+  }
+
+  /**
+   * Creates an empty scene graph with the meshes requested by the specified stress scene
+   * arguments. The first mesh is the usual square, and each one after it is a polygon with one
+   * more side than the last.
+   */
+  scene_graph stress_scene_graph(const stress_scene_args& args)
+  {
+    if (args.mesh_count == 0 || args.color_count == 0)
+      throw std::invalid_argument("Stress scenes require at least one mesh and one color!");
+
+    scene_graph graph;
+    graph.meshes().push_back(square_mesh(graph.geometry(), COLOR_WHITE));
+    for (size_t index = 1; index < args.mesh_count; index++)
+      graph.meshes().push_back(polygon_mesh(graph.geometry(), index + 4, COLOR_WHITE));
+    return graph;
+  }
+
+  /** Creates the cube with the specified index in a stress scene. */
+  scene_node stress_cube_node(size_t index, const stress_scene_args& args)
+  {
+    const GLuint mesh_index = static_cast<GLuint>(index % args.mesh_count);
+    return cube_node(mesh_index, stress_color(index / args.mesh_count, args.color_count));
+  }
+
+  /** Returns a uniformly distributed random number in `[min, max)`. */
+  float random_float(std::mt19937& random, float min, float max)
+  {
+    // the standard distributions are implementation-defined, so the conversion is done by hand to
+    // produce the same scenes with every standard library
+    const float unit = static_cast<float>(random() >> 8) / static_cast<float>(1u << 24);
+    return min + (unit * (max - min));
+  }
+
 }
 
 /* -- Procedures -- */
@@ -93,7 +247,7 @@ namespace
 scene_graph lineage::create_single_cube_scene_graph(const glm::vec4& color)
 {
   scene_graph graph;
-  graph.meshes().push_back(square_mesh(color));
+  graph.meshes().push_back(square_mesh(graph.geometry(), color));
   graph.nodes().push_back(cube_node(0));
   return graph;
 }
@@ -103,44 +257,186 @@ scene_graph lineage::create_multiple_cubes_scene_graph()
 {
   scene_graph graph;
 
-  auto& meshes = graph.meshes();
-  meshes.push_back(square_mesh(COLOR_WHITE));
-  meshes.push_back(square_mesh(COLOR_RED));
-  meshes.push_back(square_mesh(COLOR_GREEN));
-  meshes.push_back(square_mesh(COLOR_BLUE));
-  meshes.push_back(square_mesh(COLOR_CYAN));
-  meshes.push_back(square_mesh(COLOR_MAGENTA));
-  meshes.push_back(square_mesh(COLOR_YELLOW));
+  // every face of every cube shares a single mesh, and is tinted per node
+  graph.meshes().push_back(square_mesh(graph.geometry(), COLOR_WHITE));
 
   auto& nodes = graph.nodes();
 
-  scene_node center = cube_node(0);
+  scene_node center = cube_node(0, COLOR_WHITE);
   center.set_scale(glm::vec3(2.0f, 2.0f, 2.0f));
   nodes.push_back(center);
 
-  scene_node left = cube_node(1);
+  scene_node left = cube_node(0, COLOR_RED);
   left.set_position(glm::vec3(-3.0f, 0.0f, 0.0f));
   nodes.push_back(left);
 
-  scene_node top = cube_node(2);
+  scene_node top = cube_node(0, COLOR_GREEN);
   top.set_position(glm::vec3(0.0f, 3.0f, 0.0f));
   nodes.push_back(top);
 
-  scene_node front = cube_node(3);
+  scene_node front = cube_node(0, COLOR_BLUE);
   front.set_position(glm::vec3(0.0f, 0.0f, 3.0f));
   nodes.push_back(front);
 
-  scene_node right = cube_node(4);
+  scene_node right = cube_node(0, COLOR_CYAN);
   right.set_position(glm::vec3(3.0f, 0.0f, 0.0f));
   nodes.push_back(right);
 
-  scene_node bottom = cube_node(5);
+  scene_node bottom = cube_node(0, COLOR_MAGENTA);
   bottom.set_position(glm::vec3(0.0f, -3.0f, 0.0f));
   nodes.push_back(bottom);
 
-  scene_node back = cube_node(6);
+  scene_node back = cube_node(0, COLOR_YELLOW);
   back.set_position(glm::vec3(0.0f, 0.0f, -3.0f));
   nodes.push_back(back);
 
   return graph;
 }
+
+scene_graph lineage::create_cube_grid_scene_graph(size_t x_count,
+                                                  size_t y_count,
+                                                  size_t z_count,
+                                                  const stress_scene_args& args)
+{
+  scene_graph graph = stress_scene_graph(args);
+  auto& nodes = graph.nodes();
+  nodes.reserve(x_count * y_count * z_count);
+
+  const glm::vec3 origin = glm::vec3(x_count - 1, y_count - 1, z_count - 1) * (STRESS_CUBE_SPACING * -0.5f);
+  for (size_t z = 0; z < z_count; z++)
+  {
+    for (size_t y = 0; y < y_count; y++)
+    {
+      for (size_t x = 0; x < x_count; x++)
+      {
+        scene_node cube = stress_cube_node(nodes.size(), args);
+        cube.set_position(origin + (glm::vec3(x, y, z) * STRESS_CUBE_SPACING));
+        nodes.push_back(std::move(cube));
+      }
+    }
+  }
+
+  return graph;
+}
+
+scene_graph lineage::create_deep_chain_scene_graph(size_t depth, const stress_scene_args& args)
+{
+  if (depth > MAX_CHAIN_DEPTH)
+    throw std::invalid_argument("Chain is too deep!");
+
+  scene_graph graph = stress_scene_graph(args);
+  if (depth == 0)
+    return graph;
+
+  // build the chain from the bottom up, so that no node is copied
+  scene_node link = stress_cube_node(depth - 1, args);
+  for (size_t index = depth - 1; index > 0; index--)
+  {
+    link.set_position(glm::vec3(STRESS_CUBE_SPACING, CHAIN_LINK_RISE, 0.0f));
+    link.set_rotation(glm::rotate(ROTATION_NONE, CHAIN_LINK_TURN, VEC3_UNIT_Y));
+
+    scene_node parent = stress_cube_node(index - 1, args);
+    parent.children().push_back(std::move(link));
+    link = std::move(parent);
+  }
+
+  graph.nodes().push_back(std::move(link));
+  return graph;
+}
+
+scene_graph lineage::create_wide_fan_scene_graph(size_t width, const stress_scene_args& args)
+{
+  scene_graph graph = stress_scene_graph(args);
+
+  scene_node root;
+  auto& children = root.children();
+  children.reserve(width);
+  for (size_t index = 0; index < width; index++)
+  {
+    const float radius = STRESS_CUBE_SPACING * std::sqrt(static_cast<float>(index));
+    const float angle = FAN_GOLDEN_ANGLE * index;
+
+    scene_node cube = stress_cube_node(index, args);
+    cube.set_position(glm::vec3(radius * std::cos(angle), 0.0f, radius * std::sin(angle)));
+    children.push_back(std::move(cube));
+  }
+
+  graph.nodes().push_back(std::move(root));
+  return graph;
+}
+
+scene_graph lineage::create_random_scatter_scene_graph(size_t count,
+                                                       float extent,
+                                                       uint32_t seed,
+                                                       const stress_scene_args& args)
+{
+  scene_graph graph = stress_scene_graph(args);
+  auto& nodes = graph.nodes();
+  nodes.reserve(count);
+
+  std::mt19937 random(seed);
+  for (size_t index = 0; index < count; index++)
+  {
+    const glm::vec3 position(random_float(random, -extent, extent),
+                             random_float(random, -extent, extent),
+                             random_float(random, -extent, extent));
+    const float yaw = random_float(random, 0.0f, static_cast<float>(2.0 * M_PI));
+    const float pitch = random_float(random, 0.0f, static_cast<float>(2.0 * M_PI));
+    const float scale = random_float(random, SCATTER_MIN_SCALE, SCATTER_MAX_SCALE);
+
+    scene_node cube = stress_cube_node(index, args);
+    cube.set_position(position);
+    cube.set_rotation(glm::rotate(glm::rotate(ROTATION_NONE, yaw, VEC3_UNIT_Y), pitch, VEC3_UNIT_X));
+    cube.set_scale(glm::vec3(scale, scale, scale));
+    nodes.push_back(std::move(cube));
+  }
+
+  return graph;
+}
+
+scene_graph lineage::create_lod_sphere_grid_scene_graph(size_t x_count,
+                                                        size_t y_count,
+                                                        size_t z_count,
+                                                        const stress_scene_args& args)
+{
+  if (args.mesh_count == 0 || args.color_count == 0)
+    throw std::invalid_argument("Stress scenes require at least one mesh and one color!");
+
+  scene_graph graph;
+  std::vector<size_t> chains;
+  for (size_t index = 0; index < args.mesh_count; index++)
+  {
+    graph.meshes().push_back(sphere_mesh(graph.geometry(),
+                                         SPHERE_SEGMENTS + (index * SPHERE_SEGMENT_STEP),
+                                         SPHERE_RINGS,
+                                         COLOR_WHITE));
+    chains.push_back(generate_lod_chain(graph,
+                                        graph.meshes().size() - 1,
+                                        SPHERE_LOD_LEVELS,
+                                        SPHERE_LOD_REDUCTION,
+                                        SPHERE_LOD_FIRST_SCREEN_SIZE));
+  }
+
+  auto& nodes = graph.nodes();
+  nodes.reserve(x_count * y_count * z_count);
+
+  // the spheres are drawn entirely through their chains, so they have no other meshes
+  const glm::vec3 origin = glm::vec3(x_count - 1, y_count - 1, z_count - 1) * (STRESS_CUBE_SPACING * -0.5f);
+  for (size_t z = 0; z < z_count; z++)
+  {
+    for (size_t y = 0; y < y_count; y++)
+    {
+      for (size_t x = 0; x < x_count; x++)
+      {
+        const size_t index = nodes.size();
+        scene_node sphere;
+        sphere.set_lod_chain(chains[index % args.mesh_count]);
+        sphere.set_color(stress_color(index / args.mesh_count, args.color_count));
+        sphere.set_position(origin + (glm::vec3(x, y, z) * STRESS_CUBE_SPACING));
+        nodes.push_back(std::move(sphere));
+      }
+    }
+  }
+
+  return graph;
+}
@@ -4,11 +4,45 @@
  * @date	2017/01/22
  */
 
+#pragma once
+
 /* -- Includes -- */
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/glm.hpp>
 #include "scene_graph.hpp"
 
+/* -- Constants -- */
+
+namespace lineage
+{
+
+  /**
+   * The deepest chain built by `lineage::create_deep_chain_scene_graph()`. Scene nodes are
+   * destroyed recursively, so a deeper chain could overflow the stack when it is torn down.
+   */
+  const size_t MAX_CHAIN_DEPTH = 10000;
+
+}
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Struct containing the parameters shared by the stress scene generators.
+   */
+  struct stress_scene_args
+  {
+    size_t mesh_count;		/**< The number of distinct meshes to draw the cubes' faces with. */
+    size_t color_count;		/**< The number of distinct colors to tint the cubes with. */
+  };
+
+}
+
 /* -- Procedure Prototypes -- */
 
 namespace lineage
@@ -24,4 +58,71 @@ namespace lineage
    */
   lineage::scene_graph create_multiple_cubes_scene_graph();
 
+  /**
+   * Creates a scene graph with a grid of `x_count` by `y_count` by `z_count` cubes, centered on
+   * the origin.
+   *
+   * @note
+   * Each cube in the stress scenes is a parent node with a child node for each face, so a scene of
+   * `n` cubes has `7n` nodes. Consecutive cubes cycle through the meshes first and then through the
+   * colors, so that every combination is used.
+   *
+   * @exception std::invalid_argument
+   * Thrown if `args` requests no meshes or no colors.
+   */
+  lineage::scene_graph create_cube_grid_scene_graph(size_t x_count,
+                                                    size_t y_count,
+                                                    size_t z_count,
+                                                    const lineage::stress_scene_args& args);
+
+  /**
+   * Creates a scene graph with a single chain of `depth` cubes, each a child of the last, winding
+   * up in a helix. Every cube's world matrix depends on every cube above it.
+   *
+   * @exception std::invalid_argument
+   * Thrown if `depth` exceeds `lineage::MAX_CHAIN_DEPTH`, or if `args` requests no meshes or no
+   * colors.
+   */
+  lineage::scene_graph create_deep_chain_scene_graph(size_t depth, const lineage::stress_scene_args& args);
+
+  /**
+   * Creates a scene graph with a single root node and `width` cubes as its direct children,
+   * spread out in a disc.
+   *
+   * @exception std::invalid_argument
+   * Thrown if `args` requests no meshes or no colors.
+   */
+  lineage::scene_graph create_wide_fan_scene_graph(size_t width, const lineage::stress_scene_args& args);
+
+  /**
+   * Creates a scene graph with `count` cubes at random positions, rotations and scales within
+   * `extent` of the origin on each axis. The same seed always produces the same scene.
+   *
+   * @exception std::invalid_argument
+   * Thrown if `args` requests no meshes or no colors.
+   */
+  lineage::scene_graph create_random_scatter_scene_graph(size_t count,
+                                                         float extent,
+                                                         uint32_t seed,
+                                                         const lineage::stress_scene_args& args);
+
+  /**
+   * Creates a scene graph with a grid of `x_count` by `y_count` by `z_count` spheres, centered on
+   * the origin. Each sphere is drawn with a LOD chain generated by simplifying a full-resolution
+   * sphere mesh, so distant spheres are drawn with fewer triangles.
+   *
+   * @note
+   * `args.mesh_count` distinct sphere resolutions are generated, each with its own chain, and the
+   * spheres cycle through them in the same way as the cubes of the other stress scenes. Since the
+   * chains are generated by reading back the uploaded meshes, this requires a current OpenGL
+   * context.
+   *
+   * @exception std::invalid_argument
+   * Thrown if `args` requests no meshes or no colors.
+   */
+  lineage::scene_graph create_lod_sphere_grid_scene_graph(size_t x_count,
+                                                          size_t y_count,
+                                                          size_t z_count,
+                                                          const lineage::stress_scene_args& args);
+
 }
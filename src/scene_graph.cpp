@@ -6,9 +6,14 @@
 
 /* -- Includes -- */
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "debug.hpp"
+#include "geometry_pool.hpp"
+#include "lod_chain.hpp"
 #include "mesh.hpp"
 #include "scene_graph.hpp"
 #include "scene_node.hpp"
@@ -20,31 +25,62 @@ using namespace lineage;
 /* -- Procedures -- */
 
 scene_graph::scene_graph()
-  : m_meshes(),
-    m_nodes()
+  : m_geometry(std::make_unique<geometry_pool>()),
+    m_meshes(),
+    m_lod_chains(),
+    m_nodes(),
+    m_changed_nodes(),
+    m_revision(0)
 {
 }
 
-scene_graph::scene_graph(std::vector<std::unique_ptr<mesh>> meshes,
+scene_graph::scene_graph(std::unique_ptr<geometry_pool> geometry,
+                         std::vector<std::unique_ptr<mesh>> meshes,
                          std::vector<scene_node> nodes)
-  : m_meshes(std::move(meshes)),
-    m_nodes(std::move(nodes))
+  : m_geometry(std::move(geometry)),
+    m_meshes(std::move(meshes)),
+    m_lod_chains(),
+    m_nodes(std::move(nodes)),
+    m_changed_nodes(),
+    m_revision(0)
 {
 }
 
 scene_graph::scene_graph(scene_graph&& other) noexcept
-  : m_meshes(std::move(other.m_meshes)),
-    m_nodes(std::move(other.m_nodes))
+  : m_geometry(std::move(other.m_geometry)),
+    m_meshes(std::move(other.m_meshes)),
+    m_lod_chains(std::move(other.m_lod_chains)),
+    m_nodes(std::move(other.m_nodes)),
+    m_changed_nodes(),
+    m_revision(other.m_revision + 1)
 {
 }
 
 scene_graph& scene_graph::operator =(scene_graph&& other) noexcept
 {
+  // release the old meshes before the pool which stores them
   m_meshes = std::move(other.m_meshes);
+  m_geometry = std::move(other.m_geometry);
+  m_lod_chains = std::move(other.m_lod_chains);
   m_nodes = std::move(other.m_nodes);
+  m_changed_nodes.clear();
+  m_revision = std::max(m_revision, other.m_revision) + 1;
   return *this;
 }
 
+geometry_pool& scene_graph::geometry()
+{
+  // a moved-from graph has no pool
+  lineage_assert(m_geometry != nullptr);
+  return *m_geometry;
+}
+
+const geometry_pool& scene_graph::geometry() const
+{
+  lineage_assert(m_geometry != nullptr);
+  return *m_geometry;
+}
+
 std::vector<std::unique_ptr<mesh>>& scene_graph::meshes()
 {
   return m_meshes;
@@ -55,8 +91,19 @@ const std::vector<std::unique_ptr<mesh>>& scene_graph::meshes() const
   return m_meshes;
 }
 
+std::vector<lod_chain>& scene_graph::lod_chains()
+{
+  return m_lod_chains;
+}
+
+const std::vector<lod_chain>& scene_graph::lod_chains() const
+{
+  return m_lod_chains;
+}
+
 std::vector<scene_node>& scene_graph::nodes()
 {
+  m_revision++;
   return m_nodes;
 }
 
@@ -64,3 +111,27 @@ const std::vector<scene_node>& scene_graph::nodes() const
 {
   return m_nodes;
 }
+
+scene_node& scene_graph::node(size_t index)
+{
+  // the list is kept sorted, so that it can be matched against the nodes in a single pass
+  auto it = std::lower_bound(m_changed_nodes.begin(), m_changed_nodes.end(), index);
+  if (it == m_changed_nodes.end() || *it != index)
+    m_changed_nodes.insert(it, index);
+  return m_nodes[index];
+}
+
+const std::vector<size_t>& scene_graph::changed_nodes() const
+{
+  return m_changed_nodes;
+}
+
+void scene_graph::clear_changed_nodes()
+{
+  m_changed_nodes.clear();
+}
+
+uint64_t scene_graph::revision() const
+{
+  return m_revision;
+}
@@ -8,9 +8,12 @@
 
 /* -- Includes -- */
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "geometry_pool.hpp"
+#include "lod_chain.hpp"
 #include "mesh.hpp"
 #include "scene_node.hpp"
 
@@ -36,8 +39,12 @@ namespace lineage
 
     /**
      * Constructs a new `lineage::scene_graph` instance with the specified parameters.
+     *
+     * @param geometry
+     * The geometry pool which `meshes` are stored in.
      */
-    scene_graph(std::vector<std::unique_ptr<lineage::mesh>> meshes,
+    scene_graph(std::unique_ptr<lineage::geometry_pool> geometry,
+                std::vector<std::unique_ptr<lineage::mesh>> meshes,
                 std::vector<lineage::scene_node> nodes);
 
     /**
@@ -64,6 +71,18 @@ namespace lineage
 
   public:
 
+    /**
+     * The geometry pool which the meshes in this scene graph are stored in. Must not be called on
+     * a graph which has been moved from.
+     */
+    lineage::geometry_pool& geometry();
+
+    /**
+     * The geometry pool which the meshes in this scene graph are stored in. Must not be called on
+     * a graph which has been moved from.
+     */
+    const lineage::geometry_pool& geometry() const;
+
     /**
      * The meshes used in this scene graph.
      */
@@ -74,8 +93,22 @@ namespace lineage
      */
     const std::vector<std::unique_ptr<lineage::mesh>>& meshes() const;
 
+    /**
+     * The LOD chains used in this scene graph. Each level refers to an entry in `meshes()`.
+     */
+    std::vector<lineage::lod_chain>& lod_chains();
+
+    /**
+     * The LOD chains used in this scene graph. Each level refers to an entry in `meshes()`.
+     */
+    const std::vector<lineage::lod_chain>& lod_chains() const;
+
     /**
      * The top-level nodes in this scene graph.
+     *
+     * @note
+     * Calling this method increments the graph's revision, since the caller may use the returned
+     * reference to restructure the graph.
      */
     std::vector<lineage::scene_node>& nodes();
 
@@ -84,12 +117,43 @@ namespace lineage
      */
     const std::vector<lineage::scene_node>& nodes() const;
 
+    /**
+     * Returns the top-level node at the specified index, for modifying its properties.
+     *
+     * @note
+     * Unlike `nodes()`, this does not increment the graph's revision. It must not be used to add or
+     * remove child nodes. The index is recorded in `changed_nodes()`, since the caller may change
+     * the node or any of its descendants.
+     */
+    lineage::scene_node& node(size_t index);
+
+    /**
+     * The indices of the top-level nodes returned by `node()` since the last call to
+     * `clear_changed_nodes()`, in ascending order and without duplicates.
+     */
+    const std::vector<size_t>& changed_nodes() const;
+
+    /**
+     * Clears the list of changed top-level nodes.
+     */
+    void clear_changed_nodes();
+
+    /**
+     * The structural revision of this graph. Incremented whenever the graph is accessed in a way
+     * which may change its structure.
+     */
+    uint64_t revision() const;
+
     /* -- Implementation -- */
 
   private:
 
+    std::unique_ptr<lineage::geometry_pool> m_geometry;
     std::vector<std::unique_ptr<lineage::mesh>> m_meshes;
+    std::vector<lineage::lod_chain> m_lod_chains;
     std::vector<lineage::scene_node> m_nodes;
+    std::vector<size_t> m_changed_nodes;
+    uint64_t m_revision;
 
   };
 
@@ -9,6 +9,7 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
 
 #include "constants.hpp"
 #include "scene_node.hpp"
@@ -17,14 +18,23 @@
 
 using namespace lineage;
 
+/* -- Variables -- */
+
+const size_t scene_node::no_lod_chain;
+
 /* -- Procedures -- */
 
 scene_node::scene_node()
   : m_meshes(),
+    m_lod_chain(no_lod_chain),
     m_children(),
     m_position(POSITION_NONE),
     m_rotation(ROTATION_NONE),
-    m_scale(SCALE_NONE)
+    m_scale(SCALE_NONE),
+    m_color(COLOR_WHITE),
+    m_transform_revision(0),
+    m_local_matrix(),
+    m_local_matrix_dirty(true)
 {
 }
 
@@ -34,10 +44,15 @@ scene_node::scene_node(std::vector<size_t> meshes,
                        const glm::quat& rotation,
                        const glm::vec3& scale)
   : m_meshes(std::move(meshes)),
+    m_lod_chain(no_lod_chain),
     m_children(std::move(children)),
     m_position(position),
     m_rotation(rotation),
-    m_scale(scale)
+    m_scale(scale),
+    m_color(COLOR_WHITE),
+    m_transform_revision(0),
+    m_local_matrix(),
+    m_local_matrix_dirty(true)
 {
 }
 
@@ -51,6 +66,22 @@ const std::vector<size_t>& scene_node::meshes() const
   return m_meshes;
 }
 
+size_t scene_node::lod_chain() const
+{
+  return m_lod_chain;
+}
+
+void scene_node::set_lod_chain(size_t lod_chain)
+{
+  if (lod_chain == m_lod_chain)
+    return;
+  m_lod_chain = lod_chain;
+
+  // the node's bounds cover every level of its chain, so they must be recomputed as though it had
+  // moved - the local matrix itself is unchanged
+  m_transform_revision++;
+}
+
 std::vector<lineage::scene_node>& scene_node::children()
 {
   return m_children;
@@ -68,7 +99,10 @@ glm::vec3 scene_node::position() const
 
 void scene_node::set_position(const glm::vec3& position)
 {
+  if (position == m_position)
+    return;
   m_position = position;
+  transform_changed();
 }
 
 glm::quat scene_node::rotation() const
@@ -78,7 +112,10 @@ glm::quat scene_node::rotation() const
 
 void scene_node::set_rotation(const glm::quat& rotation)
 {
+  if (rotation == m_rotation)
+    return;
   m_rotation = rotation;
+  transform_changed();
 }
 
 glm::vec3 scene_node::scale() const
@@ -88,5 +125,42 @@ glm::vec3 scene_node::scale() const
 
 void scene_node::set_scale(const glm::vec3& scale)
 {
+  if (scale == m_scale)
+    return;
   m_scale = scale;
+  transform_changed();
+}
+
+glm::vec4 scene_node::color() const
+{
+  return m_color;
+}
+
+void scene_node::set_color(const glm::vec4& color)
+{
+  m_color = color;
+}
+
+const glm::mat4& scene_node::local_matrix() const
+{
+  if (m_local_matrix_dirty)
+  {
+    m_local_matrix =
+      glm::translate(m_position) *
+      glm::scale(m_scale) *
+      glm::mat4_cast(m_rotation);
+    m_local_matrix_dirty = false;
+  }
+  return m_local_matrix;
+}
+
+uint64_t scene_node::transform_revision() const
+{
+  return m_transform_revision;
+}
+
+void scene_node::transform_changed()
+{
+  m_transform_revision++;
+  m_local_matrix_dirty = true;
 }
@@ -8,6 +8,8 @@
 
 /* -- Includes -- */
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -27,6 +29,15 @@ namespace lineage
   class scene_node
   {
 
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * LOD chain index used for nodes without a LOD chain.
+     */
+    static const size_t no_lod_chain = std::numeric_limits<size_t>::max();
+
     /* -- Lifecycle -- */
 
   public:
@@ -59,6 +70,24 @@ namespace lineage
      */
     const std::vector<size_t>& meshes() const;
 
+    /**
+     * Returns the index of the LOD chain in the scene graph which should be rendered for this node,
+     * or `scene_node::no_lod_chain`.
+     *
+     * @note
+     * The renderer draws one level of the chain, chosen from the node's projected size, in addition
+     * to the meshes in `meshes()`. A node drawn entirely at a level of detail has an empty
+     * `meshes()`, while `meshes()` still holds parts which are always drawn at full detail - for
+     * example, meshes too small for simplification to remove anything.
+     */
+    size_t lod_chain() const;
+
+    /**
+     * Sets the index of the LOD chain which should be rendered for this node. This changes the
+     * node's bounds, so its transform revision is incremented.
+     */
+    void set_lod_chain(size_t lod_chain);
+
     /**
      * The child nodes of this node.
      */
@@ -99,15 +128,48 @@ namespace lineage
      */
     void set_scale(const glm::vec3& scale);
 
+    /**
+     * Returns the color that the meshes of this node are tinted with.
+     */
+    glm::vec4 color() const;
+
+    /**
+     * Sets the color that the meshes of this node are tinted with.
+     */
+    void set_color(const glm::vec4& color);
+
+    /**
+     * Returns the transformation matrix of this node, relative to its parent.
+     *
+     * @note
+     * The matrix is cached, and only recomputed after the node's transform has changed.
+     */
+    const glm::mat4& local_matrix() const;
+
+    /**
+     * The transform revision of this node. Incremented whenever the position, rotation, or scale of
+     * this node changes, so that cached world matrices for this node and its subtree can be
+     * invalidated.
+     */
+    uint64_t transform_revision() const;
+
     /* -- Implementation -- */
 
   private:
 
+    /** Marks the transform of this node as changed. */
+    void transform_changed();
+
     std::vector<size_t> m_meshes;
+    size_t m_lod_chain;
     std::vector<lineage::scene_node> m_children;
     glm::vec3 m_position;
     glm::quat m_rotation;
     glm::vec3 m_scale;
+    glm::vec4 m_color;
+    uint64_t m_transform_revision;
+    mutable glm::mat4 m_local_matrix;
+    mutable bool m_local_matrix_dirty;
 
   };
 
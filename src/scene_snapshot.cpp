@@ -0,0 +1,58 @@
+/**
+ * @file	scene_snapshot.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <vector>
+
+#include "scene_graph.hpp"
+#include "scene_node.hpp"
+#include "scene_snapshot.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Procedures -- */
+
+void lineage::capture_node_snapshots(const scene_graph& graph,
+                                     std::vector<node_snapshot>* nodes,
+                                     std::vector<size_t>* changed,
+                                     std::vector<const scene_node*>* stack)
+{
+  nodes->clear();
+
+  // the graph's changed nodes are sorted, so they can be matched against the roots in order
+  const auto& changed_roots = graph.changed_nodes();
+  auto next_changed = changed_roots.begin();
+
+  const auto& roots = graph.nodes();
+  for (size_t root = 0; root < roots.size(); root++)
+  {
+    if (next_changed != changed_roots.end() && *next_changed == root)
+    {
+      changed->push_back(nodes->size());
+      ++next_changed;
+    }
+
+    // walk the subtree with an explicit stack, pushing children in reverse so that they are visited
+    // in their original order - this must match the order of `lineage::flat_scene_graph`
+    stack->clear();
+    stack->push_back(&roots[root]);
+    while (!stack->empty())
+    {
+      const scene_node* const node = stack->back();
+      stack->pop_back();
+
+      nodes->push_back({ node->local_matrix(), node->color(), node->transform_revision() });
+
+      const auto& children = node->children();
+      for (auto it = children.rbegin(); it != children.rend(); ++it)
+        stack->push_back(&(*it));
+    }
+  }
+}
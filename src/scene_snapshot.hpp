@@ -0,0 +1,86 @@
+/**
+ * @file	scene_snapshot.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class scene_graph;
+  class scene_node;
+
+  /**
+   * Struct representing the state of a single scene node at the time a snapshot was taken.
+   */
+  struct node_snapshot
+  {
+    glm::mat4 local_matrix;		/**< The node's transform relative to its parent. */
+    glm::vec4 color;			/**< The color to tint the node's meshes with. */
+    uint64_t transform_revision;	/**< The node's transform revision. */
+  };
+
+  /**
+   * Struct representing an immutable copy of everything the renderer needs from the application
+   * state, so that the state can be updated on another thread while a frame is rendered.
+   *
+   * @note
+   * Only the per-frame state is copied. The structure of the scene graph (and its meshes) is
+   * shared, so it must not be changed while the renderer is running on another thread.
+   */
+  struct scene_snapshot
+  {
+    uint64_t graph_revision;			/**< The structural revision of the scene graph. */
+    glm::vec3 camera_position;			/**< The camera position. */
+    glm::quat camera_rotation;			/**< The camera rotation. */
+    float camera_fov;				/**< The camera field of view in the Y axis, in radians. */
+    float camera_clip_near;			/**< The camera near clip distance. */
+    float camera_clip_far;			/**< The camera far clip distance. */
+    glm::vec4 background_color;			/**< The background color. */
+    glm::vec4 ambient_light_color;		/**< The ambient lighting color. */
+    float ambient_light_intensity;		/**< The ambient lighting intensity. */
+    std::vector<lineage::node_snapshot> nodes;	/**< Every node, in the order of `lineage::flat_scene_graph`. */
+    std::vector<size_t> changed_nodes;		/**< Indices in `nodes` of the subtrees changed since the last snapshot read. */
+  };
+
+}
+
+/* -- Procedures -- */
+
+namespace lineage
+{
+
+  /**
+   * Copies the state of every node in `graph` to `nodes`, in depth-first pre-order - the same
+   * order used by `lineage::flat_scene_graph`.
+   *
+   * @param changed
+   * Receives the index in `nodes` of each of the graph's changed top-level nodes. This is appended
+   * to rather than cleared, so that changes can be carried over from a snapshot which was skipped.
+   *
+   * @param stack
+   * Scratch storage for the walk of the graph, so that deep graphs can't overflow the call stack.
+   *
+   * @note
+   * The storage of `nodes`, `changed`, and `stack` is reused, so this does not allocate once they
+   * have held a graph of the same shape.
+   */
+  void capture_node_snapshots(const lineage::scene_graph& graph,
+                              std::vector<lineage::node_snapshot>* nodes,
+                              std::vector<size_t>* changed,
+                              std::vector<const lineage::scene_node*>* stack);
+
+}
@@ -60,8 +60,18 @@ void shader::set_source(const std::string& source)
 }
 
 void shader::compile()
+{
+  begin_compile();
+  finish_compile();
+}
+
+void shader::begin_compile()
 {
   glCompileShader(m_handle);
+}
+
+void shader::finish_compile()
+{
   if (!is_compiled())
   {
     auto error = opengl_error::last_error();
@@ -77,6 +87,13 @@ void shader::compile()
   }
 }
 
+bool shader::is_compile_complete() const
+{
+  GLint complete = GL_FALSE;
+  glGetShaderiv(m_handle, GL_COMPLETION_STATUS_ARB, &complete);
+  return (complete != GL_FALSE);
+}
+
 bool shader::is_compiled() const
 {
   GLint success = GL_FALSE;
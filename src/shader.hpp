@@ -103,6 +103,29 @@ namespace lineage
      */
     void compile();
 
+    /**
+     * Submits the shader for compilation, without waiting for the result. The driver may compile it
+     * in the background, until its status is queried by `finish_compile()` or `is_compiled()`.
+     */
+    void begin_compile();
+
+    /**
+     * Waits for a compilation started by `begin_compile()` to complete, and checks its result.
+     *
+     * @exception lineage::opengl_error
+     * Thrown if the shader cannot be compiled due to a generic OpenGL error.
+     *
+     * @exception lineage::shader_compile_error
+     * Thrown if the shader cannot be compiled due to a GLSL error.
+     */
+    void finish_compile();
+
+    /**
+     * Returns `true` if a compilation started by `begin_compile()` has completed, without
+     * blocking. Requires `GL_KHR_parallel_shader_compile` or `GL_ARB_parallel_shader_compile`.
+     */
+    bool is_compile_complete() const;
+
     /**
      * Returns `true` if the shader has been successfully compiled.
      */
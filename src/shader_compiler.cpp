@@ -0,0 +1,372 @@
+/**
+ * @file	shader_compiler.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+/* -- Includes -- */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api.hpp"
+#include "debug.hpp"
+#include "opengl.hpp"
+#include "shader.hpp"
+#include "shader_compiler.hpp"
+#include "shader_program.hpp"
+#include "window.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std::string_literals;
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // passed to glMaxShaderCompilerThreads to let the driver choose how many threads to use
+  const GLuint DRIVER_THREAD_COUNT = 0xFFFFFFFF;
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** The ways in which programs can be compiled. */
+  enum class compile_mode
+  {
+    extension,	/**< Compiled by the driver's threads, using the parallel compile extension. */
+    worker,	/**< Compiled on a worker thread with a shared context. */
+    deferred,	/**< Compiled on the calling thread when the program is finished. */
+  };
+
+  /** A single stage of a submitted program, with its source copied. */
+  struct job_stage
+  {
+    GLenum type;		/**< The type of shader. */
+    std::string source;		/**< The source code for the shader. */
+  };
+
+  /** A program which has been submitted for compilation. */
+  struct job
+  {
+    std::vector<job_stage> stages;			/**< The stages of the program. */
+    bool retrievable;					/**< Whether the binary will be retrieved. */
+    std::vector<std::unique_ptr<shader>> shaders;	/**< The shaders, while they are compiling. */
+    std::unique_ptr<shader_program> program;		/**< The program being built. */
+    std::exception_ptr error;				/**< The error thrown while building, if any. */
+    bool complete;					/**< Whether the worker has finished the job. */
+  };
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Enables parallel compilation if the driver supports it, returning `true` if it does. */
+  bool enable_parallel_compile(const opengl& opengl)
+  {
+#if defined(GL_KHR_parallel_shader_compile)
+    if (opengl.is_supported("GL_KHR_parallel_shader_compile"))
+    {
+      glMaxShaderCompilerThreadsKHR(DRIVER_THREAD_COUNT);
+      return true;
+    }
+#endif
+#if defined(GL_ARB_parallel_shader_compile)
+    if (opengl.is_supported("GL_ARB_parallel_shader_compile"))
+    {
+      glMaxShaderCompilerThreadsARB(DRIVER_THREAD_COUNT);
+      return true;
+    }
+#endif
+    return false;
+  }
+
+  /** Submits every shader in a job for compilation, and its program for linking. */
+  void begin_job(job& job)
+  {
+    for (const auto& stage : job.stages)
+    {
+      job.shaders.push_back(std::make_unique<shader>(stage.type));
+      job.shaders.back()->set_source(stage.source);
+      job.shaders.back()->begin_compile();
+    }
+
+    // linking can be requested before compilation completes - the driver waits for the shaders
+    job.program = std::make_unique<shader_program>();
+    for (const auto& shader : job.shaders)
+      job.program->attach_shader(*shader);
+    job.program->set_binary_retrievable_hint(job.retrievable);
+    job.program->begin_link();
+  }
+
+  /** Waits for a job started by `begin_job()`, and checks its shaders and program. */
+  void finish_job(job& job)
+  {
+    // the shaders are checked first, since their logs explain a failed link much better
+    for (const auto& shader : job.shaders)
+      shader->finish_compile();
+    job.program->finish_link();
+
+    for (const auto& shader : job.shaders)
+      job.program->detach_shader(*shader);
+    job.shaders.clear();
+  }
+
+}
+
+/**
+ * Implementation for the `lineage::shader_compiler` class.
+ */
+struct shader_compiler::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const lineage::window& window, const lineage::opengl& opengl)
+    : mode(compile_mode::deferred),
+      jobs(),
+      next_request(0),
+      context(nullptr),
+      worker(),
+      mutex(),
+      wake(),
+      completed(),
+      queue(),
+      stopping(false)
+  {
+    if (enable_parallel_compile(opengl))
+    {
+      mode = compile_mode::extension;
+      lineage_log_status("Shaders will be compiled by the driver in parallel.");
+      return;
+    }
+
+    try
+    {
+      context = std::make_unique<shared_context>(window);
+    }
+    catch (const std::runtime_error& ex)
+    {
+      lineage_log_warning("Shaders will be compiled synchronously - "s + ex.what());
+      return;
+    }
+
+    mode = compile_mode::worker;
+    worker = std::thread(&implementation::worker_main, this);
+    lineage_log_status("Shaders will be compiled on a worker thread.");
+  }
+
+  /* -- Fields -- */
+
+  compile_mode mode;
+  std::map<request, std::unique_ptr<job>> jobs;
+  request next_request;
+
+  std::unique_ptr<shared_context> context;
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable completed;
+  std::deque<job*> queue;
+  bool stopping;
+
+  /* -- Procedures -- */
+
+  /** Returns the job for the specified request. */
+  job& find_job(request request) const
+  {
+    auto it = jobs.find(request);
+    if (it == jobs.end())
+      throw std::invalid_argument("Unknown shader compiler request!");
+    return *it->second;
+  }
+
+  /** Main procedure for the worker thread. */
+  void worker_main()
+  {
+    context->make_current();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      wake.wait(lock, [&] { return stopping || !queue.empty(); });
+      if (stopping)
+        break;
+
+      job* const current = queue.front();
+      queue.pop_front();
+      lock.unlock();
+
+      try
+      {
+        begin_job(*current);
+        finish_job(*current);
+      }
+      catch (...)
+      {
+        current->error = std::current_exception();
+      }
+
+      // the program must be complete before the window's context is allowed to use it
+      glFinish();
+
+      lock.lock();
+      current->complete = true;
+      completed.notify_all();
+    }
+
+    lock.unlock();
+    context->release();
+  }
+
+};
+
+/* -- Procedures -- */
+
+shader_compiler::shader_compiler(const window& window, const opengl& opengl)
+  : impl(std::make_unique<implementation>(window, opengl))
+{
+}
+
+shader_compiler::~shader_compiler()
+{
+  if (impl->worker.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(impl->mutex);
+      impl->stopping = true;
+    }
+    impl->wake.notify_all();
+    impl->worker.join();
+  }
+}
+
+bool shader_compiler::is_parallel() const
+{
+  return (impl->mode != compile_mode::deferred);
+}
+
+shader_compiler::request shader_compiler::submit(const std::vector<shader_stage>& stages, bool retrievable)
+{
+  auto new_job = std::make_unique<job>();
+  for (const auto& stage : stages)
+    new_job->stages.push_back({ stage.type, stage.source });
+  new_job->retrievable = retrievable;
+  new_job->complete = false;
+
+  job* const submitted = new_job.get();
+  const request request = impl->next_request++;
+  impl->jobs.emplace(request, std::move(new_job));
+
+  switch (impl->mode)
+  {
+  case compile_mode::extension:
+    try
+    {
+      begin_job(*submitted);
+    }
+    catch (...)
+    {
+      // reported by finish(), like any other compilation error
+      submitted->error = std::current_exception();
+    }
+    break;
+
+  case compile_mode::worker:
+    {
+      std::lock_guard<std::mutex> lock(impl->mutex);
+      impl->queue.push_back(submitted);
+    }
+    impl->wake.notify_one();
+    break;
+
+  case compile_mode::deferred:
+    break;
+  }
+
+  return request;
+}
+
+bool shader_compiler::is_complete(request request) const
+{
+  const job& job = impl->find_job(request);
+  switch (impl->mode)
+  {
+  case compile_mode::extension:
+    return (job.error || job.program->is_link_complete());
+
+  case compile_mode::worker:
+    {
+      std::lock_guard<std::mutex> lock(impl->mutex);
+      return job.complete;
+    }
+
+  case compile_mode::deferred:
+  default:
+    return true;
+  }
+}
+
+std::unique_ptr<shader_program> shader_compiler::finish(request request)
+{
+  job& job = impl->find_job(request);
+  switch (impl->mode)
+  {
+  case compile_mode::extension:
+    if (!job.error)
+    {
+      try
+      {
+        finish_job(job);
+      }
+      catch (...)
+      {
+        job.error = std::current_exception();
+      }
+    }
+    break;
+
+  case compile_mode::worker:
+    {
+      std::unique_lock<std::mutex> lock(impl->mutex);
+      impl->completed.wait(lock, [&] { return job.complete; });
+    }
+    break;
+
+  case compile_mode::deferred:
+    try
+    {
+      begin_job(job);
+      finish_job(job);
+    }
+    catch (...)
+    {
+      job.error = std::current_exception();
+    }
+    break;
+  }
+
+  const std::exception_ptr error = job.error;
+  auto program = std::move(job.program);
+  impl->jobs.erase(request);
+
+  if (error)
+    std::rethrow_exception(error);
+  return program;
+}
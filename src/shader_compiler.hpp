@@ -0,0 +1,144 @@
+/**
+ * @file	shader_compiler.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  class opengl;
+  class shader_program;
+  class window;
+
+  /**
+   * Struct describing a single shader stage of a program.
+   */
+  struct shader_stage
+  {
+    GLenum type;		/**< The type of shader, such as `GL_VERTEX_SHADER`. */
+    const std::string& source;	/**< The source code for the shader. */
+  };
+
+  /**
+   * Class which compiles and links shader programs without blocking the calling thread.
+   *
+   * @note
+   * Programs are submitted with `submit()`, which returns immediately, and collected with
+   * `finish()`. Submitting every program before finishing any of them lets the driver compile them
+   * all at once, instead of stalling on each in turn.
+   *
+   * If the driver supports `GL_KHR_parallel_shader_compile` or `GL_ARB_parallel_shader_compile`,
+   * programs are compiled on the calling thread's context and the driver's own threads do the work.
+   * Otherwise, they are compiled on a worker thread with a context shared with the window. If that
+   * context can't be created, programs are compiled when they are finished, so `finish()` blocks.
+   *
+   * Except for the worker thread, the compiler must only be used on the thread which owns the
+   * window's context.
+   */
+  class shader_compiler
+  {
+
+    /* -- Types -- */
+
+  public:
+
+    /**
+     * Identifies a program which has been submitted for compilation.
+     */
+    using request = size_t;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::shader_compiler` instance.
+     *
+     * @param window
+     * The window whose context the programs will be used with.
+     *
+     * @param opengl
+     * The OpenGL interface in use by the application.
+     */
+    shader_compiler(const lineage::window& window, const lineage::opengl& opengl);
+
+    /**
+     * Destructor. Waits for the program being compiled on the worker thread, if any, and discards
+     * every program which hasn't been finished.
+     */
+    ~shader_compiler();
+
+  private:
+
+    shader_compiler(const lineage::shader_compiler&) = delete;
+    shader_compiler(lineage::shader_compiler&&) = delete;
+    lineage::shader_compiler& operator =(const lineage::shader_compiler&) = delete;
+    lineage::shader_compiler& operator =(lineage::shader_compiler&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns `true` if programs are compiled in parallel with the calling thread, either by the
+     * driver or by the worker thread.
+     */
+    bool is_parallel() const;
+
+    /**
+     * Submits a program built from the specified stages for compilation, and returns immediately.
+     * The stage sources are copied, so they don't need to outlive the call.
+     *
+     * @param retrievable
+     * If `true`, the program's binary will be retrieved once it is linked.
+     */
+    lineage::shader_compiler::request submit(const std::vector<lineage::shader_stage>& stages,
+                                             bool retrievable = false);
+
+    /**
+     * Returns `true` if the specified program has finished compiling, so that `finish()` won't
+     * block. Always returns `true` if programs aren't compiled in parallel.
+     *
+     * @exception std::invalid_argument
+     * Thrown if the request is unknown, or has already been finished.
+     */
+    bool is_complete(lineage::shader_compiler::request request) const;
+
+    /**
+     * Waits for the specified program to finish compiling, and returns it.
+     *
+     * @exception std::invalid_argument
+     * Thrown if the request is unknown, or has already been finished.
+     *
+     * @exception lineage::shader_compile_error
+     * Thrown if one of the program's shaders failed to compile.
+     *
+     * @exception lineage::shader_program_link_error
+     * Thrown if the program failed to link.
+     */
+    std::unique_ptr<lineage::shader_program> finish(lineage::shader_compiler::request request);
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -6,11 +6,15 @@
 
 /* -- Includes -- */
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include "api.hpp"
+#include "opengl.hpp"
 #include "opengl_error.hpp"
 #include "shader.hpp"
 #include "shader_program.hpp"
@@ -54,6 +58,7 @@ shader_program::~shader_program()
 {
   if (m_handle == INVALID_HANDLE)
     return;
+  opengl::forget_program(m_handle);
   glDeleteProgram(m_handle);
 }
 
@@ -68,8 +73,18 @@ void shader_program::detach_shader(const shader& shader)
 }
 
 void shader_program::link()
+{
+  begin_link();
+  finish_link();
+}
+
+void shader_program::begin_link()
 {
   glLinkProgram(m_handle);
+}
+
+void shader_program::finish_link()
+{
   if (!is_linked())
   {
     auto error = opengl_error::last_error();
@@ -85,6 +100,41 @@ void shader_program::link()
   }
 }
 
+void shader_program::set_binary_retrievable_hint(bool retrievable)
+{
+  glProgramParameteri(m_handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, retrievable ? GL_TRUE : GL_FALSE);
+}
+
+bool shader_program::binary(GLenum* format, std::vector<uint8_t>* data) const
+{
+  const GLint length = get_program_info(m_handle, GL_PROGRAM_BINARY_LENGTH);
+  if (length <= 0)
+    return false;
+
+  data->resize(static_cast<size_t>(length));
+  GLsizei written = 0;
+  glGetProgramBinary(m_handle, length, &written, format, data->data());
+  if (opengl_error::last_error() != GL_NO_ERROR || written <= 0)
+    return false;
+
+  data->resize(static_cast<size_t>(written));
+  return true;
+}
+
+bool shader_program::load_binary(GLenum format, const void* data, size_t size)
+{
+  glProgramBinary(m_handle, format, data, static_cast<GLsizei>(size));
+
+  // a rejected binary may also raise an error, which shouldn't be left for the next check
+  opengl_error::last_error();
+  return is_linked();
+}
+
+bool shader_program::is_link_complete() const
+{
+  return (get_program_info(m_handle, GL_COMPLETION_STATUS_ARB) != GL_FALSE);
+}
+
 bool shader_program::is_linked() const
 {
   return (get_program_info(m_handle, GL_LINK_STATUS) != GL_FALSE);
@@ -128,3 +178,15 @@ GLint shader_program::uniform_location(const std::string& name) const
 {
   return glGetUniformLocation(m_handle, name.c_str());
 }
+
+GLuint shader_program::uniform_block_index(const std::string& name) const
+{
+  return glGetUniformBlockIndex(m_handle, name.c_str());
+}
+
+void shader_program::set_uniform_block_binding(const std::string& name, GLuint binding)
+{
+  const GLuint index = uniform_block_index(name);
+  if (index != GL_INVALID_INDEX)
+    glUniformBlockBinding(m_handle, index, binding);
+}
@@ -8,8 +8,11 @@
 
 /* -- Includes -- */
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "api.hpp"
 #include "opengl_error.hpp"
@@ -103,6 +106,53 @@ namespace lineage
      */
     void link();
 
+    /**
+     * Submits the program for linking, without waiting for the result. The driver may link it in
+     * the background, until its status is queried by `finish_link()` or `is_linked()`.
+     */
+    void begin_link();
+
+    /**
+     * Waits for a link started by `begin_link()` to complete, and checks its result.
+     *
+     * @exception lineage::opengl_error
+     * Thrown is the shader program cannot be linked due to a generic OpenGL error.
+     *
+     * @exception lineage::shader_program_link_error
+     * Thrown if the shader program cannot be linked due to a program-specific error.
+     */
+    void finish_link();
+
+    /**
+     * Returns `true` if a link started by `begin_link()` has completed, without blocking.
+     * Requires `GL_KHR_parallel_shader_compile` or `GL_ARB_parallel_shader_compile`.
+     */
+    bool is_link_complete() const;
+
+    /**
+     * Hints that the program's binary will be retrieved with `binary()`. Must be called before
+     * the program is linked.
+     */
+    void set_binary_retrievable_hint(bool retrievable);
+
+    /**
+     * Retrieves the binary representation of the linked program, in a driver-specific format.
+     *
+     * @return
+     * `true` if the binary was retrieved, or `false` if the driver could not provide it.
+     */
+    bool binary(GLenum* format, std::vector<uint8_t>* data) const;
+
+    /**
+     * Restores the program from a binary previously retrieved with `binary()`, instead of linking
+     * it from shaders.
+     *
+     * @return
+     * `true` if the program was restored and linked, or `false` if the driver rejected the binary
+     * - for example, because it was created by a different driver version.
+     */
+    bool load_binary(GLenum format, const void* data, size_t size);
+
     /**
      * Returns `true` if the program has been successfully linked.
      */
@@ -140,6 +190,18 @@ namespace lineage
      */
     GLint uniform_location(const std::string& name) const;
 
+    /**
+     * Returns the index of the uniform block with the specified name, or `GL_INVALID_INDEX` if no
+     * matching uniform block is found.
+     */
+    GLuint uniform_block_index(const std::string& name) const;
+
+    /**
+     * Assigns the uniform block with the specified name to a uniform buffer binding point. Does
+     * nothing if the program has no active block with that name.
+     */
+    void set_uniform_block_binding(const std::string& name, GLuint binding);
+
     /* -- Implementation -- */
 
   private:
@@ -46,6 +46,15 @@ namespace
     DEFAULT_VERTEX_SHADER_SOURCE_ARRAY,
     array_size(DEFAULT_VERTEX_SHADER_SOURCE_ARRAY));
 
+  // default instanced vertex shader
+  const char DEFAULT_INSTANCED_VERTEX_SHADER_SOURCE_ARRAY[] =
+  {
+    #include "default_instanced_vertex_shader.glsl.inc"
+  };
+  const std::string DEFAULT_INSTANCED_VERTEX_SHADER_SOURCE(
+    DEFAULT_INSTANCED_VERTEX_SHADER_SOURCE_ARRAY,
+    array_size(DEFAULT_INSTANCED_VERTEX_SHADER_SOURCE_ARRAY));
+
   // default fragment shader
   const char DEFAULT_FRAGMENT_SHADER_SOURCE_ARRAY[] =
   {
@@ -68,6 +77,8 @@ const std::string& lineage::shader_source_string(shader_source shader)
     return PROTOTYPE_FRAGMENT_SHADER_SOURCE;
   case shader_source::default_vertex_shader:
     return DEFAULT_VERTEX_SHADER_SOURCE;
+  case shader_source::default_instanced_vertex_shader:
+    return DEFAULT_INSTANCED_VERTEX_SHADER_SOURCE;
   case shader_source::default_fragment_shader:
     return DEFAULT_FRAGMENT_SHADER_SOURCE;
   default:
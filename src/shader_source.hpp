@@ -23,6 +23,7 @@ namespace lineage
     prototype_vertex_shader,
     prototype_fragment_shader,
     default_vertex_shader,
+    default_instanced_vertex_shader,
     default_fragment_shader,
   };
 
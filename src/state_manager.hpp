@@ -60,6 +60,15 @@ namespace lineage
      */
     virtual double target_delta_t() const = 0;
 
+    /**
+     * Returns `true` if `run()` may be called on its own thread, concurrently with rendering.
+     *
+     * @note
+     * State managers supporting this must hand their state to the render manager through
+     * snapshots, rather than having it read their live state.
+     */
+    virtual bool supports_concurrent_run() const = 0;
+
   };
 
 }
@@ -0,0 +1,185 @@
+/**
+ * @file	streaming_buffer.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "api.hpp"
+#include "buffer.hpp"
+#include "debug.hpp"
+#include "opengl_error.hpp"
+#include "streaming_buffer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Constants -- */
+
+namespace
+{
+  // Storage flags for the buffer - writes through the mapping are visible to the GPU without
+  // any explicit flushing
+  const GLbitfield STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  // Time to wait for a fence before checking it again, in nanoseconds
+  const GLuint64 FENCE_WAIT_TIMEOUT = 1000000;
+}
+
+/* -- Variables -- */
+
+const size_t streaming_buffer::default_region_count;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Rounds `value` up to the next multiple of `alignment`. */
+  size_t align(size_t value, size_t alignment)
+  {
+    return ((value + alignment - 1) / alignment) * alignment;
+  }
+
+}
+
+/* -- Procedures -- */
+
+streaming_buffer::streaming_buffer(size_t region_size, size_t region_alignment, size_t region_count)
+  : m_region_count(region_count),
+    m_region_alignment(region_alignment),
+    m_region_size(0),
+    m_buffer(),
+    m_mapping(nullptr),
+    m_fences(region_count, nullptr),
+    m_region(region_count - 1),
+    m_offset(0),
+    m_stall_count(0)
+{
+  lineage_assert(region_count != 0);
+  lineage_assert(region_alignment != 0);
+  create_storage(region_size);
+}
+
+streaming_buffer::~streaming_buffer()
+{
+  for (auto& fence : m_fences)
+  {
+    if (fence != nullptr)
+      glDeleteSync(fence);
+  }
+  release_storage();
+}
+
+void streaming_buffer::begin_frame()
+{
+  m_region = (m_region + 1) % m_region_count;
+  m_offset = 0;
+  wait(m_region);
+}
+
+void streaming_buffer::end_frame()
+{
+  lineage_assert(m_fences[m_region] == nullptr);
+  m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void streaming_buffer::reserve(size_t region_size)
+{
+  if (region_size <= m_region_size)
+    return;
+  lineage_assert(m_offset == 0);
+
+  // the old storage can't be released until the GPU has finished with all of it
+  for (size_t region = 0; region < m_region_count; region++)
+    wait(region);
+  release_storage();
+  create_storage(std::max(region_size, m_region_size * 2));
+}
+
+void* streaming_buffer::allocate(size_t size, size_t alignment, size_t* offset)
+{
+  lineage_assert(m_region_alignment % alignment == 0);
+  const size_t start = align(m_offset, alignment);
+  if (start + size > m_region_size)
+    throw std::length_error("Streaming buffer region is full!");
+
+  m_offset = start + size;
+  *offset = m_region * m_region_size + start;
+  return m_mapping + *offset;
+}
+
+const buffer& streaming_buffer::storage() const
+{
+  return *m_buffer;
+}
+
+size_t streaming_buffer::region_size() const
+{
+  return m_region_size;
+}
+
+size_t streaming_buffer::region_used() const
+{
+  return m_offset;
+}
+
+uint64_t streaming_buffer::stall_count() const
+{
+  return m_stall_count;
+}
+
+void streaming_buffer::create_storage(size_t region_size)
+{
+  // allocations are aligned relative to their region, so every region must start on a multiple of
+  // the largest alignment in use
+  region_size = align(region_size, m_region_alignment);
+  const size_t size = region_size * m_region_count;
+  m_buffer = std::make_unique<immutable_buffer>(size, nullptr, STORAGE_FLAGS);
+  m_mapping = static_cast<uint8_t*>(m_buffer->map_range(0, size, STORAGE_FLAGS));
+  if (m_mapping == nullptr)
+    opengl_error::throw_last_error();
+  m_region_size = region_size;
+}
+
+void streaming_buffer::release_storage()
+{
+  if (m_buffer && m_mapping != nullptr)
+    m_buffer->unmap();
+  m_mapping = nullptr;
+  m_buffer.reset();
+}
+
+void streaming_buffer::wait(size_t region)
+{
+  GLsync& fence = m_fences[region];
+  if (fence == nullptr)
+    return;
+
+  // poll once without flushing, so the common case of an already-signaled fence costs nothing
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED)
+  {
+    m_stall_count++;
+    do
+    {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+    }
+    while (result == GL_TIMEOUT_EXPIRED);
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+
+  if (result == GL_WAIT_FAILED)
+    opengl_error::throw_last_error();
+}
@@ -0,0 +1,172 @@
+/**
+ * @file	streaming_buffer.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "api.hpp"
+#include "buffer.hpp"
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Class representing a persistently mapped buffer for streaming transient per-frame data (such
+   * as instance data, indirect commands, and uniform blocks) to the GPU.
+   *
+   * @note
+   * The buffer is split into regions, one of which is written each frame. Data is suballocated
+   * from the current region with a bump allocator, and written directly through a coherent
+   * mapping, so no driver copies or implicit synchronization are involved. A fence is placed at
+   * the end of each frame, and the CPU only waits when it comes back around to a region which the
+   * GPU is still reading from.
+   */
+  class streaming_buffer
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * The default number of regions in the buffer.
+     */
+    static const size_t default_region_count = 3;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::streaming_buffer` instance.
+     *
+     * @param region_size
+     * The initial number of bytes available in each frame.
+     *
+     * @param region_alignment
+     * The alignment of the start of every region. Every alignment passed to `allocate()` must
+     * divide this, since allocations are only aligned relative to the start of their region.
+     *
+     * @param region_count
+     * The number of regions. This is the number of frames which the CPU may run ahead of the GPU.
+     */
+    streaming_buffer(size_t region_size, size_t region_alignment, size_t region_count = default_region_count);
+
+    /**
+     * Destructor.
+     */
+    ~streaming_buffer();
+
+  private:
+
+    streaming_buffer(const lineage::streaming_buffer&) = delete;
+    streaming_buffer(lineage::streaming_buffer&&) = delete;
+    lineage::streaming_buffer& operator =(const lineage::streaming_buffer&) = delete;
+    lineage::streaming_buffer& operator =(lineage::streaming_buffer&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Advances to the next region, waiting for the GPU to finish reading from it if required.
+     */
+    void begin_frame();
+
+    /**
+     * Places a fence after every command reading from the current region.
+     */
+    void end_frame();
+
+    /**
+     * Ensures that each region can hold at least `region_size` bytes, reallocating the buffer if
+     * required.
+     *
+     * @note
+     * Reallocating waits for the GPU to finish with every region, and invalidates `storage()`. This
+     * may only be called before anything has been allocated in the current frame.
+     */
+    void reserve(size_t region_size);
+
+    /**
+     * Allocates space in the current region.
+     *
+     * @param size
+     * The number of bytes to allocate.
+     *
+     * @param alignment
+     * The required alignment of the offset of the allocation in the buffer. This must divide the
+     * region alignment passed to the constructor.
+     *
+     * @param offset
+     * Receives the offset of the allocation in `storage()`.
+     *
+     * @return
+     * A pointer to write the data to. This is only valid until the end of the frame.
+     *
+     * @exception std::length_error
+     * Thrown if the current region does not have enough space remaining.
+     */
+    void* allocate(size_t size, size_t alignment, size_t* offset);
+
+    /**
+     * Allocates space for `count` objects of type `T` in the current region.
+     */
+    template <typename T>
+    T* allocate(size_t count, size_t alignment, size_t* offset)
+    {
+      return static_cast<T*>(allocate(count * sizeof(T), alignment, offset));
+    }
+
+    /**
+     * The buffer containing every region.
+     */
+    const lineage::buffer& storage() const;
+
+    /**
+     * The number of bytes available in each region.
+     */
+    size_t region_size() const;
+
+    /**
+     * The number of bytes allocated in the current region.
+     */
+    size_t region_used() const;
+
+    /**
+     * The number of times that the CPU has had to wait for the GPU to release a region.
+     */
+    uint64_t stall_count() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    void create_storage(size_t region_size);
+    void release_storage();
+    void wait(size_t region);
+
+    const size_t m_region_count;
+    const size_t m_region_alignment;
+    size_t m_region_size;
+    std::unique_ptr<lineage::immutable_buffer> m_buffer;
+    uint8_t* m_mapping;
+    std::vector<GLsync> m_fences;
+    size_t m_region;
+    size_t m_offset;
+    uint64_t m_stall_count;
+
+  };
+
+}
@@ -0,0 +1,281 @@
+/**
+ * @file	thread_pool.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "debug.hpp"
+#include "thread_pool.hpp"
+
+/* -- Namespaces -- */
+
+using namespace lineage;
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** A set of chunks submitted by a single call to `parallel_for()`. */
+  struct job
+  {
+    void (*function)(const void*, size_t, size_t, size_t);	/**< The function to run. */
+    const void* context;					/**< The context passed to the function. */
+    std::atomic<size_t> remaining;				/**< The number of chunks not yet completed. */
+    allocation_account* account;				/**< The caller's allocation account. */
+  };
+
+  /** A single chunk of a job. */
+  struct task
+  {
+    job* source;	/**< The job this chunk belongs to. */
+    size_t begin;	/**< The first index in the chunk. */
+    size_t end;		/**< One past the last index in the chunk. */
+  };
+
+  /**
+   * A fixed-size double-ended queue of tasks. The owning thread pushes and pops at the back, and
+   * other threads steal from the front.
+   */
+  class task_deque
+  {
+  public:
+
+    task_deque()
+      : m_mutex(),
+        m_tasks(),
+        m_head(0),
+        m_count(0)
+    { }
+
+    bool push_back(const task& value)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_count == thread_pool::max_queued_tasks)
+        return false;
+      m_tasks[(m_head + m_count) % thread_pool::max_queued_tasks] = value;
+      m_count++;
+      return true;
+    }
+
+    bool pop_back(task* value)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_count == 0)
+        return false;
+      m_count--;
+      *value = m_tasks[(m_head + m_count) % thread_pool::max_queued_tasks];
+      return true;
+    }
+
+    bool pop_front(task* value)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_count == 0)
+        return false;
+      *value = m_tasks[m_head];
+      m_head = (m_head + 1) % thread_pool::max_queued_tasks;
+      m_count--;
+      return true;
+    }
+
+  private:
+
+    std::mutex m_mutex;
+    task m_tasks[thread_pool::max_queued_tasks];
+    size_t m_head;
+    size_t m_count;
+
+  };
+
+}
+
+/* -- Variables -- */
+
+const size_t thread_pool::max_queued_tasks;
+
+/**
+ * Implementation for the `lineage::thread_pool` class.
+ */
+struct thread_pool::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(size_t worker_count)
+    : deques(),
+      workers(),
+      wake_mutex(),
+      wake(),
+      queued(0),
+      stopping(false)
+  {
+    // deque zero belongs to the calling thread
+    for (size_t index = 0; index <= worker_count; index++)
+      deques.push_back(std::make_unique<task_deque>());
+  }
+
+  /* -- Fields -- */
+
+  std::vector<std::unique_ptr<task_deque>> deques;
+  std::vector<std::thread> workers;
+  std::mutex wake_mutex;
+  std::condition_variable wake;
+  std::atomic<size_t> queued;
+  bool stopping;
+
+  /* -- Procedures -- */
+
+  /** Main loop for the worker thread with the specified index. */
+  void worker_main(size_t thread_index)
+  {
+    while (true)
+    {
+      task next;
+      if (take(thread_index, &next))
+      {
+        execute(next, thread_index);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(wake_mutex);
+      wake.wait(lock, [&] { return stopping || queued.load() != 0; });
+      if (stopping)
+        return;
+    }
+  }
+
+  /** Takes a task from the back of this thread's deque, or steals one from another thread. */
+  bool take(size_t thread_index, task* value)
+  {
+    if (deques[thread_index]->pop_back(value))
+    {
+      queued--;
+      return true;
+    }
+
+    for (size_t offset = 1; offset < deques.size(); offset++)
+    {
+      if (deques[(thread_index + offset) % deques.size()]->pop_front(value))
+      {
+        queued--;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /** Runs a task, and marks it as completed. */
+  static void execute(const task& value, size_t thread_index)
+  {
+    {
+      // allocations made by the chunk are charged to the thread which submitted the job
+      const allocation_charge_scope charge(value.source->account);
+      value.source->function(value.source->context, value.begin, value.end, thread_index);
+    }
+
+    // this must be the last access to the job, since its owner may return as soon as it completes
+    value.source->remaining.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+};
+
+/* -- Procedures -- */
+
+thread_pool::thread_pool(size_t worker_count)
+  : impl(std::make_unique<implementation>(worker_count))
+{
+  for (size_t index = 1; index <= worker_count; index++)
+    impl->workers.emplace_back([this, index] { impl->worker_main(index); });
+}
+
+thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(impl->wake_mutex);
+    impl->stopping = true;
+  }
+  impl->wake.notify_all();
+
+  for (auto& worker : impl->workers)
+    worker.join();
+}
+
+size_t thread_pool::default_worker_count()
+{
+  // hardware_concurrency() may return zero if the count can't be determined
+  const size_t hardware_threads = std::thread::hardware_concurrency();
+  return (hardware_threads > 1) ? (hardware_threads - 1) : 0;
+}
+
+size_t thread_pool::thread_count() const
+{
+  return impl->deques.size();
+}
+
+void thread_pool::run(task_function function, const void* context, size_t count, size_t chunk_size)
+{
+  lineage_assert(chunk_size != 0);
+  if (count == 0)
+    return;
+
+  // don't bother waking any workers for a single chunk
+  const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+  if (chunk_count == 1 || impl->workers.empty())
+  {
+    for (size_t begin = 0; begin < count; begin += chunk_size)
+      function(context, begin, std::min(begin + chunk_size, count), 0);
+    return;
+  }
+
+  job work;
+  work.function = function;
+  work.context = context;
+  work.remaining = chunk_count;
+  work.account = current_allocation_account();
+
+  // deal the chunks out across every thread's deque, so that stealing is only needed to even out
+  // differences in cost
+  for (size_t chunk = 0; chunk < chunk_count; chunk++)
+  {
+    const size_t begin = chunk * chunk_size;
+    const task value = { &work, begin, std::min(begin + chunk_size, count) };
+    impl->queued++;
+    if (!impl->deques[chunk % impl->deques.size()]->push_back(value))
+    {
+      impl->queued--;
+      implementation::execute(value, 0);
+    }
+  }
+
+  // taking the lock orders the new tasks against any worker checking for work before it sleeps,
+  // so no worker can miss this notification
+  {
+    std::lock_guard<std::mutex> lock(impl->wake_mutex);
+  }
+  impl->wake.notify_all();
+
+  // help out until every chunk has completed - chunks may still be running on other threads after
+  // the deques are empty
+  while (work.remaining.load(std::memory_order_acquire) != 0)
+  {
+    task next;
+    if (impl->take(0, &next))
+      implementation::execute(next, 0);
+    else
+      std::this_thread::yield();
+  }
+}
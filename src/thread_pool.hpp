@@ -0,0 +1,117 @@
+/**
+ * @file	thread_pool.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <memory>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Class representing a pool of worker threads which split ranges of work between them.
+   *
+   * @note
+   * Every thread - including the thread calling `parallel_for()` - owns a fixed-size deque of
+   * tasks. Work is dealt out across all of the deques, and each thread takes its own tasks from the
+   * back of its deque, stealing from the front of other threads' deques once its own is empty. This
+   * keeps every thread busy even when some chunks of work turn out to be much more expensive than
+   * others. Idle workers sleep until new work is submitted.
+   *
+   * The pool is intended to be driven by a single owning thread. `parallel_for()` is not reentrant,
+   * and must not be called from inside a task.
+   */
+  class thread_pool
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * The maximum number of tasks which can be queued on each thread. Tasks which don't fit are run
+     * immediately on the calling thread.
+     */
+    static const size_t max_queued_tasks = 256;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::thread_pool` instance with the specified number of worker
+     * threads, in addition to the calling thread.
+     */
+    thread_pool(size_t worker_count = thread_pool::default_worker_count());
+
+    /**
+     * Destructor. Stops and joins every worker thread.
+     */
+    ~thread_pool();
+
+  private:
+
+    thread_pool(const lineage::thread_pool&) = delete;
+    thread_pool(lineage::thread_pool&&) = delete;
+    lineage::thread_pool& operator =(const lineage::thread_pool&) = delete;
+    lineage::thread_pool& operator =(lineage::thread_pool&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns the number of worker threads to use by default - one fewer than the number of hardware
+     * threads, since the calling thread also takes part.
+     */
+    static size_t default_worker_count();
+
+    /**
+     * The number of threads which run tasks, including the calling thread.
+     */
+    size_t thread_count() const;
+
+    /**
+     * Runs `function` over every index in `[0, count)`, split into chunks of `chunk_size`
+     * indices, and blocks until every chunk has completed.
+     *
+     * @param function
+     * A callable with the signature `void (size_t begin, size_t end, size_t thread_index)`. The
+     * thread index is in `[0, thread_count())` and is unique to the thread running the chunk, so it
+     * can be used to select per-thread output without locking. The calling thread always has index
+     * zero. The callable must not throw.
+     */
+    template <typename TFunction>
+    void parallel_for(size_t count, size_t chunk_size, const TFunction& function)
+    {
+      run(&thread_pool::invoke<TFunction>, &function, count, chunk_size);
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    using task_function = void (*)(const void* context, size_t begin, size_t end, size_t thread_index);
+
+    template <typename TFunction>
+    static void invoke(const void* context, size_t begin, size_t end, size_t thread_index)
+    {
+      (*static_cast<const TFunction*>(context))(begin, end, thread_index);
+    }
+
+    void run(task_function function, const void* context, size_t count, size_t chunk_size);
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,121 @@
+/**
+ * @file	triple_buffer.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <atomic>
+#include <cstdint>
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Class which passes values from a single writer thread to a single reader thread without
+   * locking.
+   *
+   * @note
+   * The buffer holds three values. The writer owns one, the reader owns another, and the third
+   * holds the most recently published value. Publishing and acquiring each swap a slot with the
+   * shared one in a single atomic exchange, so neither thread ever waits for the other. The reader
+   * always sees the latest complete value, and values published faster than they are read are
+   * skipped. Slots are reused, so values holding containers stop allocating once warmed up.
+   */
+  template <typename T>
+  class triple_buffer
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `lineage::triple_buffer` instance, with every slot default-constructed.
+     */
+    triple_buffer()
+      : m_slots(),
+        m_write_index(0),
+        m_shared(1),
+        m_read_index(2)
+    { }
+
+  private:
+
+    triple_buffer(const lineage::triple_buffer<T>&) = delete;
+    triple_buffer(lineage::triple_buffer<T>&&) = delete;
+    lineage::triple_buffer<T>& operator =(const lineage::triple_buffer<T>&) = delete;
+    lineage::triple_buffer<T>& operator =(lineage::triple_buffer<T>&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * The slot owned by the writer thread. This holds stale data, and should be completely
+     * overwritten before being published.
+     */
+    T& write_buffer()
+    {
+      return m_slots[m_write_index];
+    }
+
+    /**
+     * Publishes the writer's slot, and gives the writer a new slot to write to.
+     *
+     * @return
+     * `true` if the previously published value was never acquired. It has been skipped, and the
+     * writer's new slot still holds it.
+     */
+    bool publish()
+    {
+      const uint8_t previous = m_shared.exchange(static_cast<uint8_t>(m_write_index | fresh_flag), std::memory_order_acq_rel);
+      m_write_index = (previous & index_mask);
+      return ((previous & fresh_flag) != 0);
+    }
+
+    /**
+     * Takes the most recently published value, if one has been published since the last call.
+     *
+     * @return
+     * `true` if a new value was acquired, or `false` if `read_buffer()` is unchanged.
+     */
+    bool acquire()
+    {
+      if ((m_shared.load(std::memory_order_relaxed) & fresh_flag) == 0)
+        return false;
+
+      const uint8_t previous = m_shared.exchange(m_read_index, std::memory_order_acq_rel);
+      m_read_index = (previous & index_mask);
+      return true;
+    }
+
+    /**
+     * The slot owned by the reader thread, holding the value taken by the last call to
+     * `acquire()`.
+     */
+    const T& read_buffer() const
+    {
+      return m_slots[m_read_index];
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    static const uint8_t index_mask = 0x03;
+    static const uint8_t fresh_flag = 0x04;
+
+    T m_slots[3];
+    uint8_t m_write_index;
+    std::atomic<uint8_t> m_shared;
+    uint8_t m_read_index;
+
+  };
+
+}
@@ -0,0 +1,50 @@
+/**
+ * @file	uniform_blocks.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/01/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <glm/glm.hpp>
+
+#include "api.hpp"
+
+/* -- Constants -- */
+
+namespace lineage
+{
+
+  /** Uniform buffer binding point for the per-frame uniform block. */
+  const GLuint FRAME_UNIFORM_BINDING = 0;
+
+  /** Name of the per-frame uniform block in shader source. */
+  const char* const FRAME_UNIFORM_BLOCK_NAME = "FrameBlock";
+
+}
+
+/* -- Types -- */
+
+namespace lineage
+{
+
+  /**
+   * Struct mirroring the std140 layout of the `FrameBlock` uniform block, containing the camera
+   * and lighting values shared by everything drawn in a frame.
+   */
+  struct frame_uniforms
+  {
+    glm::mat4 view_matrix;		/**< The view matrix. */
+    glm::mat4 proj_matrix;		/**< The projection matrix. */
+    glm::mat4 view_proj_matrix;		/**< The product of the projection and view matrices. */
+    glm::vec4 camera_position;		/**< The world-space position of the camera. */
+    glm::vec4 ambient_light_color;	/**< The color of the ambient light. */
+    float ambient_light_intensity;	/**< The intensity of the ambient light. */
+    float padding[3];			/**< Pads the block to a multiple of a `vec4`. */
+  };
+
+  static_assert(sizeof(frame_uniforms) == 240, "frame_uniforms does not match the std140 layout!");
+
+}
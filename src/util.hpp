@@ -10,7 +10,10 @@
 
 #include <algorithm>
 #include <cmath>
-#include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /* -- Types -- */
 
@@ -33,6 +36,10 @@ namespace lineage
 
   /**
    * Class which performs a deferred action when it is destroyed.
+   *
+   * @note
+   * The action is stored inline rather than in a `std::function`, so that deferring an action never
+   * allocates. Actions are expected to be lambdas capturing a few references.
    */
   class defer
   {
@@ -44,17 +51,41 @@ namespace lineage
      * @param action
      * The action to execute when this object is destroyed.
      */
-    defer(std::function<void(void)> action)
-      : m_action(action)
-    { }
+    template <typename TAction>
+    defer(TAction action)
+      : m_complete(&complete<TAction>)
+    {
+      static_assert(sizeof(TAction) <= sizeof(m_storage), "Deferred action is too large to store inline!");
+      static_assert(alignof(TAction) <= alignof(storage_type), "Deferred action is over-aligned!");
+      new (&m_storage) TAction(std::move(action));
+    }
 
     ~defer()
     {
-      m_action();
+      m_complete(&m_storage);
     }
 
   private:
-    std::function<void(void)> m_action;
+
+    defer(const lineage::defer&) = delete;
+    defer(lineage::defer&&) = delete;
+    lineage::defer& operator =(const lineage::defer&) = delete;
+    lineage::defer& operator =(lineage::defer&&) = delete;
+
+    /** Runs and then destroys the stored action. */
+    template <typename TAction>
+    static void complete(void* storage)
+    {
+      auto* action = static_cast<TAction*>(storage);
+      (*action)();
+      action->~TAction();
+    }
+
+    using storage_type = typename std::aligned_storage<4 * sizeof(void*)>::type;
+
+    storage_type m_storage;
+    void (*m_complete)(void*);
+
   };
 
 }
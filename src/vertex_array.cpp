@@ -10,6 +10,7 @@
 
 #include "api.hpp"
 #include "buffer.hpp"
+#include "opengl.hpp"
 #include "opengl_error.hpp"
 #include "shader_program.hpp"
 #include "vertex_array.hpp"
@@ -53,6 +54,7 @@ vertex_array::~vertex_array()
 {
   if (m_handle == INVALID_HANDLE)
     return;
+  opengl::forget_vertex_array(m_handle);
   glDeleteVertexArrays(1, &m_handle);
 }
 
@@ -112,6 +114,13 @@ void vertex_array::unbind_buffer(GLuint binding_index)
                             0);						// stride
 }
 
+void vertex_array::set_binding_divisor(GLuint binding_index, GLuint divisor)
+{
+  glVertexArrayBindingDivisor(m_handle,					// vaobj
+                              binding_index,				// bindingindex
+                              divisor);					// divisor
+}
+
 void lineage::configure_attribute(vertex_array& vao,
                                   GLuint binding_index,
                                   const shader_program& program,
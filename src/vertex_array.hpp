@@ -123,6 +123,18 @@ namespace lineage
      */
     void unbind_buffer(GLuint binding_index);
 
+    /**
+     * Sets the rate at which attributes pulling from the specified binding index advance.
+     *
+     * @param binding_index
+     * The binding index to configure.
+     *
+     * @param divisor
+     * The number of instances drawn before advancing to the next record in the buffer, or `0` to
+     * advance once per vertex.
+     */
+    void set_binding_divisor(GLuint binding_index, GLuint divisor);
+
     /* -- Implementation -- */
 
   private:
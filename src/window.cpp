@@ -57,6 +57,15 @@ struct window::implementation
 
 };
 
+struct shared_context::implementation
+{
+
+  /* -- Fields -- */
+
+  GLFWwindow* handle;
+
+};
+
 /* -- Variables -- */
 
 window* window::implementation::s_instance = nullptr;
@@ -81,6 +90,7 @@ window::window(const window_args& args)
     glfwWindowHint(GLFW_OPENGL_PROFILE, args.context_profile);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, static_cast<int>(args.context_forward_compatibility));
     glfwWindowHint(GLFW_SAMPLES, args.msaa_samples);
+    glfwWindowHint(GLFW_VISIBLE, static_cast<int>(args.visible));
 
     impl->handle = glfwCreateWindow(args.width,
                                 args.height,
@@ -127,6 +137,11 @@ void window::poll_events() const
   glfwPollEvents();
 }
 
+void window::wait_events(double timeout) const
+{
+  glfwWaitEventsTimeout(timeout);
+}
+
 void window::swap_buffers()
 {
   glfwSwapBuffers(impl->handle);
@@ -161,3 +176,28 @@ void window::remove_observer(lineage::window_observer* observer) const
 {
   remove_all(impl->observers, observer);
 }
+
+shared_context::shared_context(const window& window)
+  : impl(std::make_unique<implementation>())
+{
+  // the hints used to create the window are still set, so the context matches its configuration
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  impl->handle = glfwCreateWindow(1, 1, "", nullptr, window.impl->handle);
+  if (!impl->handle)
+    throw std::runtime_error("Failed to create shared OpenGL context!");
+}
+
+shared_context::~shared_context()
+{
+  glfwDestroyWindow(impl->handle);
+}
+
+void shared_context::make_current()
+{
+  glfwMakeContextCurrent(impl->handle);
+}
+
+void shared_context::release()
+{
+  glfwMakeContextCurrent(nullptr);
+}
@@ -16,6 +16,8 @@
 namespace lineage
 {
 
+  class shared_context;
+
   /**
    * Abstract interface for classes observing events from a `lineage::window`.
    */
@@ -59,6 +61,7 @@ namespace lineage
     int height;				/**< Initial height of window. */
     std::string title;			/**< Initial title of window. */
     int swap_interval;			/**< Swap interval to use. */
+    bool visible;			/**< If `false`, the window is never shown. */
 
   };
 
@@ -105,7 +108,7 @@ namespace lineage
     std::string api_version() const;
 
     /**
-     * Returns the current GLFW elapsed time, in seconds.
+     * Returns the current GLFW elapsed time, in seconds. This may be called from any thread.
      */
     double time() const;
 
@@ -114,6 +117,14 @@ namespace lineage
      */
     void poll_events() const;
 
+    /**
+     * Waits for GLFW events, and processes any which arrive.
+     *
+     * @param timeout
+     * The maximum time to wait, in seconds. The wait ends as soon as any event has been processed.
+     */
+    void wait_events(double timeout) const;
+
     /**
      * Swaps the window's front and back buffers.
      */
@@ -125,7 +136,7 @@ namespace lineage
     bool should_close() const;
 
     /**
-     * Sets the window's "should close" flag.
+     * Sets the window's "should close" flag. This may be called from any thread.
      */
     void set_should_close(bool should_close);
 
@@ -151,6 +162,66 @@ namespace lineage
 
     /* -- Implementation -- */
 
+  private:
+
+    friend class lineage::shared_context;
+
+    struct implementation;
+    const std::unique_ptr<implementation> impl;
+
+  };
+
+  /**
+   * Class representing a hidden OpenGL context which shares its objects with the context of a
+   * `lineage::window`, so that objects can be created on another thread.
+   *
+   * @note
+   * The context must be created and destroyed on the thread which created the window, but may be
+   * made current on any one thread at a time.
+   */
+  class shared_context
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Creates a context sharing objects with the context of `window`, with the same configuration.
+     *
+     * @exception std::runtime_error
+     * Thrown if the context cannot be created.
+     */
+    shared_context(const lineage::window& window);
+
+    /**
+     * Destructor. The context must not be current on any thread.
+     */
+    ~shared_context();
+
+  private:
+
+    shared_context(const lineage::shared_context&) = delete;
+    shared_context(lineage::shared_context&&) = delete;
+    lineage::shared_context& operator =(const lineage::shared_context&) = delete;
+    lineage::shared_context& operator =(lineage::shared_context&&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Makes this context current on the calling thread.
+     */
+    void make_current();
+
+    /**
+     * Detaches the current context from the calling thread.
+     */
+    void release();
+
+    /* -- Implementation -- */
+
   private:
 
     struct implementation;